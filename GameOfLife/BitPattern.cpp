@@ -0,0 +1,101 @@
+#include "BitPattern.h"
+#include <algorithm>
+#include <bit>
+
+BitPattern::BitPattern(int width, int height)
+    : width(width), height(height), wordsPerRow((width + 63) / 64),
+      rows(static_cast<size_t>((width + 63) / 64) * height, 0) {}
+
+BitPattern BitPattern::fromCells(const std::vector<std::pair<int, int>>& cells) {
+    if (cells.empty()) {
+        return BitPattern();
+    }
+    int minX = cells[0].first, maxX = minX, minY = cells[0].second, maxY = minY;
+    for (const auto& cell : cells) {
+        minX = std::min(minX, cell.first);
+        maxX = std::max(maxX, cell.first);
+        minY = std::min(minY, cell.second);
+        maxY = std::max(maxY, cell.second);
+    }
+    BitPattern pattern(maxX - minX + 1, maxY - minY + 1);
+    for (const auto& cell : cells) {
+        pattern.set(cell.first - minX, cell.second - minY);
+    }
+    return pattern;
+}
+
+int BitPattern::population() const {
+    int count = 0;
+    for (std::uint64_t word : rows) {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+bool BitPattern::operator==(const BitPattern& other) const {
+    return width == other.width && height == other.height && rows == other.rows;
+}
+
+BitPattern BitPattern::transformed(int symmetry) const {
+    bool swapAxes = (symmetry & 4) != 0;
+    BitPattern result(swapAxes ? height : width, swapAxes ? width : height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (get(x, y)) {
+                int tx = (symmetry & 1) ? width - 1 - x : x;
+                int ty = (symmetry & 2) ? height - 1 - y : y;
+                if (swapAxes) {
+                    std::swap(tx, ty);
+                }
+                result.set(tx, ty);
+            }
+        }
+    }
+    return result;
+}
+
+BitPattern BitPattern::dilated() const {
+    BitPattern result(width + 2, height + 2);
+    std::vector<std::uint64_t> shifted(result.wordsPerRow);
+    for (int y = 0; y < height; y++) {
+        // Move the row one cell right to make room for the left border
+        const std::uint64_t* row = &rows[static_cast<size_t>(y) * wordsPerRow];
+        for (int w = 0; w < result.wordsPerRow; w++) {
+            std::uint64_t word = w < wordsPerRow ? row[w] : 0;
+            std::uint64_t previous = w > 0 ? row[w - 1] : 0;
+            shifted[w] = (word << 1) | (previous >> 63);
+        }
+        // Spread each cell to its left and right neighbours, then onto the rows above and below
+        for (int w = 0; w < result.wordsPerRow; w++) {
+            std::uint64_t previous = w > 0 ? shifted[w - 1] : 0;
+            std::uint64_t next = w + 1 < result.wordsPerRow ? shifted[w + 1] : 0;
+            std::uint64_t spread = shifted[w] | (shifted[w] << 1) | (previous >> 63) | (shifted[w] >> 1) | (next << 63);
+            for (int dy = 0; dy < 3; dy++) {
+                result.rows[static_cast<size_t>(y + dy) * result.wordsPerRow + w] |= spread;
+            }
+        }
+    }
+    return result;
+}
+
+BitPattern BitPattern::trimmed(int* offsetX, int* offsetY) const {
+    std::vector<std::pair<int, int>> cells;
+    int minX = width, minY = height;
+    for (int y = 0; y < height; y++) {
+        for (int w = 0; w < wordsPerRow; w++) {
+            for (std::uint64_t live = rows[static_cast<size_t>(y) * wordsPerRow + w]; live; live &= live - 1) {
+                int x = w * 64 + std::countr_zero(live);
+                cells.push_back({ x, y });
+                minX = std::min(minX, x);
+                minY = std::min(minY, y);
+            }
+        }
+    }
+    if (offsetX) {
+        *offsetX = cells.empty() ? 0 : minX;
+    }
+    if (offsetY) {
+        *offsetY = cells.empty() ? 0 : minY;
+    }
+    return fromCells(cells);
+}
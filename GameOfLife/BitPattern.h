@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A rectangle of cells packed the same way as the universe's alive plane: bit (x % 64) of
+// word y * wordsPerRow + x / 64. Patterns are stamped into the universe a word at a time.
+struct BitPattern {
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    std::vector<std::uint64_t> rows;
+
+    BitPattern() = default;
+    BitPattern(int width, int height);
+
+    static BitPattern fromCells(const std::vector<std::pair<int, int>>& cells);
+
+    bool get(int x, int y) const {
+        return (rows[static_cast<size_t>(y) * wordsPerRow + (x >> 6)] >> (x & 63)) & 1ULL;
+    }
+    void set(int x, int y) {
+        rows[static_cast<size_t>(y) * wordsPerRow + (x >> 6)] |= 1ULL << (x & 63);
+    }
+
+    int population() const;
+    bool operator==(const BitPattern& other) const;
+
+    // One of the eight rotations and reflections: bit 0 mirrors x, bit 1 mirrors y and
+    // bit 2 swaps the axes, so symmetry 0 is the pattern as drawn
+    BitPattern transformed(int symmetry) const;
+
+    // The pattern grown by one cell in every direction, including diagonally; stamping this
+    // one cell up and to the left covers every cell the pattern touches
+    BitPattern dilated() const;
+
+    // The smallest rectangle holding every live cell, and its offset within this pattern
+    BitPattern trimmed(int* offsetX = nullptr, int* offsetY = nullptr) const;
+};
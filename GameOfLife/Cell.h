@@ -18,6 +18,9 @@ public:
     // Increments the number of generations the cell has been alive
     inline void incrementGenerationsAlive() { ++generationsAlive; }
 
+    // Sets the number of generations the cell has been alive
+    inline void setGenerationsAlive(int value) { generationsAlive = value; }
+
     // Gets the color of the cell
     inline wxColour getCellColor() const { return color; }
 
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy
+// as 1, 2, 3"). Each output block is a pure function of (key, counter), so any cell of a
+// seeded fill can be produced independently of every other one: threads can split the work
+// any way they like and still produce exactly the same result.
+class CounterRandom {
+public:
+    typedef std::array<std::uint32_t, 4> Block;
+
+    explicit CounterRandom(std::uint64_t seed)
+        : key{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } {}
+
+    // Four 32-bit outputs for the given 128-bit counter
+    Block operator()(std::uint64_t high, std::uint64_t low) const {
+        Block counter = { static_cast<std::uint32_t>(low), static_cast<std::uint32_t>(low >> 32),
+            static_cast<std::uint32_t>(high), static_cast<std::uint32_t>(high >> 32) };
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+            std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = { static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ k0, static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ k1, static_cast<std::uint32_t>(product0) };
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return counter;
+    }
+
+    // Two 64-bit outputs for the given counter
+    void words(std::uint64_t high, std::uint64_t low, std::uint64_t& first, std::uint64_t& second) const {
+        Block block = (*this)(high, low);
+        first = (static_cast<std::uint64_t>(block[1]) << 32) | block[0];
+        second = (static_cast<std::uint64_t>(block[3]) << 32) | block[2];
+    }
+
+private:
+    std::array<std::uint32_t, 2> key;
+};
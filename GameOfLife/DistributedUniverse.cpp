@@ -0,0 +1,694 @@
+#include "DistributedUniverse.h"
+#include "PlaneMemory.h"
+#include "TileStepper.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <climits>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+extern char** environ;
+#endif
+
+static_assert(std::atomic<std::int64_t>::is_always_lock_free, "Workers synchronise through lock-free atomics in shared memory");
+static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free, "Edge words are shared through lock-free atomics");
+
+struct DistributedUniverse::Header {
+    std::atomic<std::int64_t> targetGeneration{ 0 };  // Generation the coordinator wants reached
+    std::atomic<int> shutdown{ 0 };                   // Set when the workers should exit
+    std::atomic<int> loaded{ 0 };                     // Set once the coordinator has copied the initial cells in
+    std::int64_t coordinator = 0;                     // Process id of the coordinator, which worker processes watch
+    int width = 0;                                    // What a worker process needs to know of the universe
+    int height = 0;
+    int wordsPerRow = 0;
+    int toroidal = 0;
+    LifeRule rule;
+    int columns = 0;
+    int rows = 0;
+    int workerCount = 0;
+};
+
+struct DistributedUniverse::WorkerSlot {
+    alignas(64) std::atomic<std::int64_t> completed{ 0 };  // Generations this worker has finished
+    std::atomic<std::int64_t> population{ 0 };             // Live cells in the subdomain at 'completed'
+    std::atomic<int> ready{ 0 };                           // Set once the segments are mapped and its own first-touched
+    int columnBegin = 0;                                   // Cells [columnBegin, columnEnd) x [rowBegin, rowEnd) belong to
+    int columnEnd = 0;                                     // this worker; columnBegin is a multiple of 64
+    int rowBegin = 0;
+    int rowEnd = 0;
+    int node = -1;                                         // NUMA node the worker is pinned to, -1 if it is not
+};
+
+namespace {
+    const char* const WORKER_ARGUMENT = "--distributed-worker";
+
+    inline size_t alignUp(size_t value) {
+        return (value + 63) & ~static_cast<size_t>(63);
+    }
+
+    // Spins briefly, then yields, then sleeps while waiting on another worker
+    inline void backoff(int& spins) {
+        if (++spins < 1000) {
+            return;
+        }
+        if (spins < 100000) {
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    // Bits [begin, end) of a word, for 0 <= begin < end <= 64
+    inline std::uint64_t bitRange(int begin, int end) {
+        std::uint64_t below = end >= 64 ? ~0ULL : (1ULL << end) - 1;
+        return below & ~((1ULL << begin) - 1);
+    }
+
+    // The halo cell just past a subdomain's last column can share a word with its edge cells,
+    // which neighbours read while the owner sets that cell, so both sides go through atomic_ref
+    inline std::uint64_t loadShared(const std::uint64_t& word) {
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t&>(word)).load(std::memory_order_relaxed);
+    }
+
+    inline void storeSharedBit(std::uint64_t& word, int bit, bool alive) {
+        std::atomic_ref<std::uint64_t> shared(word);
+        if (alive) {
+            shared.fetch_or(1ULL << bit, std::memory_order_relaxed);
+        }
+        else {
+            shared.fetch_and(~(1ULL << bit), std::memory_order_relaxed);
+        }
+    }
+
+#ifndef _WIN32
+    std::string executablePath() {
+        char path[PATH_MAX];
+#ifdef __linux__
+        ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        return length > 0 ? std::string(path, static_cast<size_t>(length)) : std::string();
+#elif defined(__APPLE__)
+        uint32_t size = sizeof(path);
+        return _NSGetExecutablePath(path, &size) == 0 ? std::string(path) : std::string();
+#else
+        (void)path;
+        return std::string();
+#endif
+    }
+#endif
+}
+
+DistributedUniverse::~DistributedUniverse() {
+    stop();
+}
+
+DistributedUniverse::Subdomain DistributedUniverse::layout(const WorkerSlot& slot) {
+    Subdomain subdomain{};
+    subdomain.ownedWidth = slot.columnEnd - slot.columnBegin;
+    subdomain.ownedHeight = slot.rowEnd - slot.rowBegin;
+    subdomain.words = (subdomain.ownedWidth + 63) / 64 + 2;
+    subdomain.height = subdomain.ownedHeight + 2;
+
+    // Both generations of each plane; colours and ages are kept for whole words so the local
+    // planes have the width the stepper expects
+    size_t cellWords = static_cast<size_t>(subdomain.words) * subdomain.height;
+    subdomain.cellsOffset = 0;
+    subdomain.colorsOffset = alignUp(2 * sizeof(std::uint64_t) * cellWords);
+    subdomain.agesOffset = alignUp(subdomain.colorsOffset + 2 * sizeof(std::uint32_t) * 64 * cellWords);
+    subdomain.bytes = subdomain.agesOffset + 2 * 64 * cellWords;
+    return subdomain;
+}
+
+GridPlanes DistributedUniverse::localPlanes(int index, std::int64_t generationParity) const {
+    Subdomain subdomain = layout(slots[index]);
+    unsigned char* segment = segments[index];
+    size_t cellWords = static_cast<size_t>(subdomain.words) * subdomain.height;
+    size_t parity = static_cast<size_t>(generationParity & 1);
+    // Bounded: beyond the owned cells there is only the halo, which the exchange fills or, past
+    // a bounded edge, leaves dead
+    return GridPlanes{ subdomain.words * 64, subdomain.height, subdomain.words, false,
+        reinterpret_cast<std::uint64_t*>(segment + subdomain.cellsOffset) + parity * cellWords,
+        reinterpret_cast<std::uint32_t*>(segment + subdomain.colorsOffset) + parity * 64 * cellWords,
+        segment + subdomain.agesOffset + parity * 64 * cellWords };
+}
+
+int DistributedUniverse::neighborOf(int index, int dx, int dy) const {
+    int column = index % columns + dx, row = index / columns + dy;
+    if (toroidal) {
+        column = (column + columns) % columns;
+        row = (row + rows) % rows;
+    }
+    if (column < 0 || column >= columns || row < 0 || row >= rows) {
+        return -1;
+    }
+    return row * columns + column;
+}
+
+bool DistributedUniverse::start(Universe& initial, int workers) {
+    stop();
+
+    GridPlanes planes = initial.getPlanes();
+    width = planes.width;
+    height = planes.height;
+    wordsPerRow = planes.wordsPerRow;
+    toroidal = planes.toroidal;
+    rule = initial.getRule();
+    generation = 0;
+    populationHistory.clear();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // As many workers as asked for where the grid allows it (a subdomain is at least a word
+    // wide), then the shortest total boundary, since that is what the halo exchange costs
+    workers = std::max(1, workers);
+    int bestCount = 0;
+    long long bestBoundary = 0;
+    for (int across = 1; across <= std::min(workers, wordsPerRow); across++) {
+        int down = std::min(workers / across, height);
+        long long boundary = static_cast<long long>(across - 1) * height + static_cast<long long>(down - 1) * width;
+        if (across * down > bestCount || (across * down == bestCount && boundary < bestBoundary)) {
+            bestCount = across * down;
+            bestBoundary = boundary;
+            columns = across;
+            rows = down;
+        }
+    }
+    workerCount = columns * rows;
+
+    controlSize = alignUp(sizeof(Header)) + sizeof(WorkerSlot) * workerCount;
+#ifdef _WIN32
+    control = static_cast<unsigned char*>(PlaneMemory::allocate(controlSize, true, false));
+#else
+    static std::atomic<int> serial{ 0 };
+    segmentName = "/gol-" + std::to_string(getpid()) + "-" + std::to_string(serial++);
+    control = static_cast<unsigned char*>(PlaneMemory::createShared(segmentName + "-control", controlSize));
+#endif
+    if (!control) {
+        return false;
+    }
+
+    header = new (control) Header();
+#ifndef _WIN32
+    header->coordinator = getpid();
+#endif
+    header->width = width;
+    header->height = height;
+    header->wordsPerRow = wordsPerRow;
+    header->toroidal = toroidal;
+    header->rule = rule;
+    header->columns = columns;
+    header->rows = rows;
+    header->workerCount = workerCount;
+
+    // Nothing is written to a subdomain's segment here: its worker touches it first, so on a
+    // NUMA machine the pages are placed on the worker's node
+    slots = reinterpret_cast<WorkerSlot*>(control + alignUp(sizeof(Header)));
+    segments.assign(workerCount, nullptr);
+    segmentSizes.assign(workerCount, 0);
+    for (int i = 0; i < workerCount; i++) {
+        WorkerSlot* slot = new (&slots[i]) WorkerSlot();
+        int column = i % columns, row = i / columns;
+        slot->columnBegin = 64 * static_cast<int>(static_cast<std::int64_t>(wordsPerRow) * column / columns);
+        slot->columnEnd = std::min(width, 64 * static_cast<int>(static_cast<std::int64_t>(wordsPerRow) * (column + 1) / columns));
+        slot->rowBegin = static_cast<int>(static_cast<std::int64_t>(height) * row / rows);
+        slot->rowEnd = static_cast<int>(static_cast<std::int64_t>(height) * (row + 1) / rows);
+
+        segmentSizes[i] = layout(*slot).bytes;
+#ifdef _WIN32
+        segments[i] = static_cast<unsigned char*>(PlaneMemory::allocate(segmentSizes[i], true, true));
+#else
+        segments[i] = static_cast<unsigned char*>(PlaneMemory::createShared(segmentName + "-" + std::to_string(i), segmentSizes[i]));
+#endif
+        if (!segments[i]) {
+            stop();
+            return false;
+        }
+    }
+
+#ifndef _WIN32
+    // posix_spawn goes straight to exec, so the worker never runs in a copy of this multithreaded
+    // process, where another thread may have held the allocator's lock at the moment of the fork
+    std::string executable = executablePath();
+    if (executable.empty()) {
+        stop();
+        return false;
+    }
+#endif
+    for (int i = 0; i < workerCount; i++) {
+#ifdef _WIN32
+        workerThreads.emplace_back(&DistributedUniverse::runWorker, this, i);
+#else
+        std::string indexText = std::to_string(i);
+        char* arguments[] = { executable.data(), const_cast<char*>(WORKER_ARGUMENT), segmentName.data(), indexText.data(), nullptr };
+        pid_t pid = -1;
+        if (posix_spawn(&pid, executable.c_str(), nullptr, nullptr, arguments, environ) != 0) {
+            stop();
+            return false;
+        }
+        workerPids.push_back(pid);
+#endif
+    }
+
+    // A worker process that cannot map its segments exits instead of becoming ready
+    for (int i = 0; i < workerCount; i++) {
+        int spins = 0;
+        while (!slots[i].ready.load(std::memory_order_acquire)) {
+            if ((spins & 1023) == 1023 && workerExited()) {
+                stop();
+                return false;
+            }
+            backoff(spins);
+        }
+    }
+    unlinkSegments();
+
+    // Each worker's part of the grid goes into the owned area of its generation 0 buffer
+    for (int i = 0; i < workerCount; i++) {
+        const WorkerSlot& slot = slots[i];
+        GridPlanes local = localPlanes(i, 0);
+        int firstWord = slot.columnBegin >> 6, words = ((slot.columnEnd - 1) >> 6) - firstWord + 1;
+        size_t cellCount = static_cast<size_t>(slot.columnEnd - slot.columnBegin);
+        std::int64_t population = 0;
+        for (int y = slot.rowBegin; y < slot.rowEnd; y++) {
+            size_t localRow = static_cast<size_t>(y - slot.rowBegin + 1);
+            const std::uint64_t* from = planes.cells + static_cast<size_t>(y) * wordsPerRow + firstWord;
+            std::copy(from, from + words, local.cells + localRow * local.wordsPerRow + 1);
+            for (int word = 0; word < words; word++) {
+                population += std::popcount(from[word]);
+            }
+            size_t fromCell = static_cast<size_t>(y) * width + slot.columnBegin, toCell = localRow * local.width + 64;
+            std::copy(planes.colors + fromCell, planes.colors + fromCell + cellCount, local.colors + toCell);
+            std::copy(planes.ages + fromCell, planes.ages + fromCell + cellCount, local.ages + toCell);
+        }
+        slots[i].population.store(population, std::memory_order_relaxed);
+    }
+    header->loaded.store(1, std::memory_order_release);
+    return true;
+}
+
+void DistributedUniverse::unlinkSegments() {
+#ifndef _WIN32
+    if (segmentName.empty()) {
+        return;
+    }
+    PlaneMemory::unlinkShared(segmentName + "-control");
+    for (int i = 0; i < workerCount; i++) {
+        PlaneMemory::unlinkShared(segmentName + "-" + std::to_string(i));
+    }
+    segmentName.clear();
+#endif
+}
+
+void DistributedUniverse::stop() {
+    if (!control) {
+        return;
+    }
+    if (!attached) {
+        header->shutdown.store(1, std::memory_order_release);
+#ifdef _WIN32
+        for (std::thread& worker : workerThreads) {
+            worker.join();
+        }
+        workerThreads.clear();
+#else
+        for (int pid : workerPids) {
+            if (pid > 0) {
+                waitpid(pid, nullptr, 0);
+            }
+        }
+        workerPids.clear();
+#endif
+        unlinkSegments();
+    }
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        PlaneMemory::release(segments[i], segmentSizes[i]);
+    }
+    segments.clear();
+    segmentSizes.clear();
+    PlaneMemory::release(control, controlSize);
+
+    control = nullptr;
+    header = nullptr;
+    slots = nullptr;
+}
+
+bool DistributedUniverse::stopping() const {
+    if (header->shutdown.load(std::memory_order_acquire)) {
+        return true;
+    }
+#ifndef _WIN32
+    // A worker process whose coordinator has died is handed to another parent
+    if (attached && getppid() != static_cast<pid_t>(header->coordinator)) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool DistributedUniverse::workerExited() {
+#ifndef _WIN32
+    for (int& pid : workerPids) {
+        if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+            pid = -1;
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+void DistributedUniverse::exchangeHalo(int index, std::int64_t generationReached) const {
+    const Subdomain own = layout(slots[index]);
+    const GridPlanes halo = localPlanes(index, generationReached);
+    const int right = 64 + own.ownedWidth, bottom = own.height - 1;
+
+    auto copyCell = [&](const GridPlanes& from, int fromX, int fromY, int toX, int toY) {
+        std::uint64_t word = loadShared(from.cells[static_cast<size_t>(fromY) * from.wordsPerRow + (fromX >> 6)]);
+        storeSharedBit(halo.cells[static_cast<size_t>(toY) * halo.wordsPerRow + (toX >> 6)], toX & 63, (word >> (fromX & 63)) & 1);
+        halo.colors[static_cast<size_t>(toY) * halo.width + toX] = from.colors[static_cast<size_t>(fromY) * from.width + fromX];
+    };
+
+    // The rows above and below come first: they bring the neighbour's whole last word, with
+    // whatever its halo cell past 'right' holds, which the corners then put right. Ages never
+    // affect a step, so only the alive and colour planes are exchanged.
+    static const int DIRECTIONS[8][2] = { { 0, -1 }, { 0, 1 }, { -1, -1 }, { -1, 0 }, { -1, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } };
+    for (const int* direction : DIRECTIONS) {
+        int dx = direction[0], dy = direction[1];
+        int neighbor = neighborOf(index, dx, dy);
+        if (neighbor < 0) {
+            continue;  // Past a bounded edge the halo stays dead
+        }
+        int spins = 0;
+        while (slots[neighbor].completed.load(std::memory_order_acquire) < generationReached) {
+            if (stopping()) {
+                return;
+            }
+            backoff(spins);
+        }
+
+        const Subdomain other = layout(slots[neighbor]);
+        const GridPlanes from = localPlanes(neighbor, generationReached);
+        int fromRow = dy < 0 ? other.ownedHeight : 1;
+        if (dx == 0) {
+            // Neighbours above and below cover the same columns
+            int toRow = dy < 0 ? 0 : bottom;
+            const std::uint64_t* fromCells = from.cells + static_cast<size_t>(fromRow) * from.wordsPerRow;
+            std::uint64_t* toCells = halo.cells + static_cast<size_t>(toRow) * halo.wordsPerRow;
+            for (int word = 1; word < own.words - 1; word++) {
+                toCells[word] = loadShared(fromCells[word]);
+            }
+            const std::uint32_t* fromColors = from.colors + static_cast<size_t>(fromRow) * from.width + 64;
+            std::copy(fromColors, fromColors + own.ownedWidth, halo.colors + static_cast<size_t>(toRow) * halo.width + 64);
+            continue;
+        }
+
+        int fromColumn = dx < 0 ? 64 + other.ownedWidth - 1 : 64, toColumn = dx < 0 ? 63 : right;
+        if (dy == 0) {
+            for (int row = 1; row < bottom; row++) {
+                copyCell(from, fromColumn, row, toColumn, row);
+            }
+        }
+        else {
+            copyCell(from, fromColumn, fromRow, toColumn, dy < 0 ? 0 : bottom);
+        }
+    }
+}
+
+void DistributedUniverse::touchSubdomain(int index) {
+    WorkerSlot& slot = slots[index];
+    int node = PlaneMemory::nodeForWorker(index, workerCount);
+    if (PlaneMemory::nodeCount() > 1 && PlaneMemory::pinToNode(node)) {
+        slot.node = node;
+    }
+
+    // Both generations, so the buffer stepped into is local too; the halo starts out dead
+    std::fill(segments[index], segments[index] + layout(slot).bytes, 0);
+    slot.ready.store(1, std::memory_order_release);
+}
+
+void DistributedUniverse::runWorker(int index) {
+    touchSubdomain(index);
+    int spins = 0;
+    while (!header->loaded.load(std::memory_order_acquire)) {
+        if (stopping()) {
+            return;
+        }
+        backoff(spins);
+    }
+
+    WorkerSlot& slot = slots[index];
+    const Subdomain subdomain = layout(slot);
+    const int right = 64 + subdomain.ownedWidth, bottom = subdomain.height - 1;
+    const int lastWordBegin = 64 * (subdomain.words - 2);  // First column of the last owned word
+    const std::uint64_t lastWordMask = bitRange(0, right - lastWordBegin);
+    TileStepper stepper;
+    stepper.setRule(rule);
+    std::int64_t reached = slot.completed.load(std::memory_order_relaxed);
+    spins = 0;
+
+    while (!stopping()) {
+        if (header->targetGeneration.load(std::memory_order_acquire) <= reached) {
+            backoff(spins);
+            continue;
+        }
+        spins = 0;
+
+        const GridPlanes source = localPlanes(index, reached);
+        const GridPlanes target = localPlanes(index, reached + 1);
+        auto stepArea = [&](int x0, int x1, int y0, int y1) {
+            for (int y = y0; y < y1; y += Universe::TILE_HEIGHT) {
+                for (int x = x0; x < x1; x += Universe::TILE_WIDTH) {
+                    stepper.load(source, x, y, std::min(Universe::TILE_WIDTH, x1 - x), std::min(Universe::TILE_HEIGHT, y1 - y), 1);
+                    stepper.run(1);
+                    stepper.store(target);
+                }
+            }
+        };
+
+        // Cells away from the boundary only read owned cells, so they can be stepped before the
+        // halo is in. The stepper stores whole words, so the first and last words of each row go
+        // with the boundary.
+        stepArea(128, lastWordBegin, 2, bottom - 1);
+
+        // The boundary needs the neighbours' edges at this generation; waiting for those also
+        // guarantees the neighbours have finished reading our edges from the buffer we are about
+        // to overwrite
+        exchangeHalo(index, reached);
+        stepArea(64, right, 1, 2);
+        if (bottom - 1 > 1) {
+            stepArea(64, right, bottom - 1, bottom);
+        }
+        stepArea(64, std::min(128, right), 2, bottom - 1);
+        if (lastWordBegin >= 128) {
+            stepArea(lastWordBegin, right, 2, bottom - 1);
+        }
+
+        std::int64_t population = 0;
+        for (int y = 1; y < bottom; y++) {
+            const std::uint64_t* row = target.cells + static_cast<size_t>(y) * target.wordsPerRow;
+            for (int word = 1; word < subdomain.words - 2; word++) {
+                population += std::popcount(row[word]);
+            }
+            population += std::popcount(row[subdomain.words - 2] & lastWordMask);
+        }
+        slot.population.store(population, std::memory_order_relaxed);
+        slot.completed.store(++reached, std::memory_order_release);
+    }
+}
+
+bool DistributedUniverse::attach(const std::string& name, int index) {
+    control = static_cast<unsigned char*>(PlaneMemory::openShared(name + "-control", controlSize));
+    if (!control) {
+        return false;
+    }
+    attached = true;
+    header = reinterpret_cast<Header*>(control);
+    slots = reinterpret_cast<WorkerSlot*>(control + alignUp(sizeof(Header)));
+    width = header->width;
+    height = header->height;
+    wordsPerRow = header->wordsPerRow;
+    toroidal = header->toroidal != 0;
+    rule = header->rule;
+    columns = header->columns;
+    rows = header->rows;
+    workerCount = header->workerCount;
+    if (index < 0 || index >= workerCount) {
+        return false;
+    }
+
+    // Only this worker's own segment and its neighbours' are mapped
+    segments.assign(workerCount, nullptr);
+    segmentSizes.assign(workerCount, 0);
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int neighbor = neighborOf(index, dx, dy);
+            if (neighbor < 0 || segments[neighbor]) {
+                continue;
+            }
+            segments[neighbor] = static_cast<unsigned char*>(PlaneMemory::openShared(name + "-" + std::to_string(neighbor), segmentSizes[neighbor]));
+            if (!segments[neighbor]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool DistributedUniverse::isWorkerCommand(int argc, char** argv) {
+    return argc == 4 && std::strcmp(argv[1], WORKER_ARGUMENT) == 0;
+}
+
+int DistributedUniverse::runWorkerProcess(int argc, char** argv) {
+#ifdef _WIN32
+    // Windows runs the workers as threads
+    (void)argc;
+    (void)argv;
+    return 1;
+#else
+    if (!isWorkerCommand(argc, argv)) {
+        return 1;
+    }
+#ifdef __linux__
+    // Dies with the coordinator's thread that spawned it; stopping() also checks the parent, which
+    // covers other systems and a coordinator that died before this line
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+    int index = std::atoi(argv[3]);
+    DistributedUniverse worker;
+    if (!worker.attach(argv[2], index)) {
+        return 1;
+    }
+    worker.runWorker(index);
+    return 0;
+#endif
+}
+
+bool DistributedUniverse::run(int generations) {
+    if (!control) {
+        return false;
+    }
+    if (generations <= 0) {
+        return true;
+    }
+    std::int64_t target = generation + generations;
+    header->targetGeneration.store(target, std::memory_order_release);
+
+    for (int i = 0; i < workerCount; i++) {
+        int spins = 0;
+        while (slots[i].completed.load(std::memory_order_acquire) < target) {
+            if ((spins & 1023) == 1023 && workerExited()) {
+                stop();
+                return false;
+            }
+            backoff(spins);
+        }
+    }
+    generation = target;
+    populationHistory.push_back(getPopulation());
+    return true;
+}
+
+std::int64_t DistributedUniverse::getPopulation() const {
+    std::int64_t population = 0;
+    for (int i = 0; i < workerCount && control; i++) {
+        population += slots[i].population.load(std::memory_order_relaxed);
+    }
+    return population;
+}
+
+void DistributedUniverse::snapshot(Universe& target) const {
+    if (!control) {
+        return;
+    }
+    if (target.getWidth() != width || target.getHeight() != height) {
+        target.resize(width, height);
+    }
+    target.setToroidal(toroidal);
+    snapshot(target, 0, 0, width, height);
+}
+
+void DistributedUniverse::snapshot(Universe& target, int x, int y, int regionWidth, int regionHeight) const {
+    if (!control || target.getWidth() != width || target.getHeight() != height) {
+        return;
+    }
+    int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    int x1 = static_cast<int>(std::min<long long>(static_cast<long long>(x) + regionWidth, width));
+    int y1 = static_cast<int>(std::min<long long>(static_cast<long long>(y) + regionHeight, height));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // The workers are idle between calls to run(), so their segments can be read directly
+    GridPlanes planes = target.getPlanes();
+    for (int i = 0; i < workerCount; i++) {
+        const WorkerSlot& slot = slots[i];
+        int left = std::max(x0, slot.columnBegin), right = std::min(x1, slot.columnEnd);
+        int top = std::max(y0, slot.rowBegin), bottom = std::min(y1, slot.rowEnd);
+        if (left >= right || top >= bottom) {
+            continue;
+        }
+        const GridPlanes local = localPlanes(i, generation);
+        int wordOffset = 1 - (slot.columnBegin >> 6);
+        for (int row = top; row < bottom; row++) {
+            size_t localRow = static_cast<size_t>(row - slot.rowBegin + 1);
+            const std::uint64_t* from = local.cells + localRow * local.wordsPerRow;
+            std::uint64_t* to = planes.cells + static_cast<size_t>(row) * wordsPerRow;
+            for (int word = left >> 6; word <= (right - 1) >> 6; word++) {
+                std::uint64_t mask = bitRange(std::max(left - 64 * word, 0), std::min(right - 64 * word, 64));
+                to[word] = (to[word] & ~mask) | (from[word + wordOffset] & mask);
+            }
+            size_t fromCell = localRow * local.width + (left - slot.columnBegin + 64), toCell = static_cast<size_t>(row) * width + left;
+            std::copy(local.colors + fromCell, local.colors + fromCell + (right - left), planes.colors + toCell);
+            std::copy(local.ages + fromCell, local.ages + fromCell + (right - left), planes.ages + toCell);
+        }
+    }
+    target.markPlanesChanged();
+}
+
+std::string DistributedUniverse::describePlacement() const {
+    if (!control) {
+        return std::string();
+    }
+    std::string text = std::to_string(workerCount) + " workers in a " + std::to_string(columns) + "x" + std::to_string(rows) + " grid";
+    if (PlaneMemory::nodeCount() > 1) {
+        text += " on nodes";
+        for (int i = 0; i < workerCount; i++) {
+            text += (i == 0 ? " " : ",") + (slots[i].node >= 0 ? std::to_string(slots[i].node) : std::string("-"));
+        }
+    }
+    else {
+        text += ", one NUMA node";
+    }
+
+    PlaneMemory::Placement placement;
+    for (int i = 0; i < workerCount; i++) {
+        PlaneMemory::Placement part = PlaneMemory::queryPlacement(segments[i], layout(slots[i]).bytes);
+        placement.bytes += part.bytes;
+        placement.residentBytes += part.residentBytes;
+        placement.hugePageBytes += part.hugePageBytes;
+        if (part.bytesPerNode.size() > placement.bytesPerNode.size()) {
+            placement.bytesPerNode.resize(part.bytesPerNode.size(), 0);
+        }
+        for (size_t node = 0; node < part.bytesPerNode.size(); node++) {
+            placement.bytesPerNode[node] += part.bytesPerNode[node];
+        }
+    }
+    return text + "; " + placement.describe();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Universe.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs one universe split across several worker processes. The grid is cut into a grid of
+// rectangular subdomains, shaped to keep the total boundary short, and each worker owns one.
+// Every subdomain lives in its own shared segment together with a one-cell halo, double-buffered
+// by generation parity. Before stepping its edges a worker copies the halo in from the edge
+// cells of its (up to eight) neighbours' segments; it steps its interior first, which overlaps
+// computation with the exchange. This process acts as the coordinator: it hands out generation
+// targets and reads back population counts, and cells only when a caller asks for them.
+//
+// On POSIX systems the workers are this executable started again (posix_spawn, so nothing runs
+// between fork and exec in the multithreaded GUI) and map the segments by name; they exit if the
+// coordinator dies. On Windows they are threads over the same segments in ordinary memory.
+// Either way each worker is pinned to a NUMA node where there are several and first-touches its
+// own segment, so the cells it steps are local to it.
+class DistributedUniverse {
+public:
+    DistributedUniverse() = default;
+    ~DistributedUniverse();
+
+    DistributedUniverse(const DistributedUniverse&) = delete;
+    DistributedUniverse& operator=(const DistributedUniverse&) = delete;
+
+    // Launches the workers and copies each its part of 'initial'; returns false if a segment or
+    // a worker could not be created
+    bool start(Universe& initial, int workers);
+
+    // Advances all workers by the given number of generations and waits for them; returns false,
+    // and stops the rest, if a worker has died
+    bool run(int generations);
+
+    // Copies the current state of every subdomain into 'target', resizing it if needed
+    void snapshot(Universe& target) const;
+    // Copies only the given rectangle, clipped to the grid, from the subdomains it overlaps;
+    // 'target' must already have the grid's size
+    void snapshot(Universe& target, int x, int y, int regionWidth, int regionHeight) const;
+
+    // Gets the generation all workers have reached
+    std::int64_t getGeneration() const { return generation; }
+
+    // Gets the live cell count summed over all workers at the current generation
+    std::int64_t getPopulation() const;
+
+    // Population recorded by the coordinator after every call to run()
+    const std::vector<std::int64_t>& getPopulationHistory() const { return populationHistory; }
+
+    // Fewer than asked for if the grid is too small to give each worker a subdomain
+    int getWorkerCount() const { return workerCount; }
+
+    // One line on how the grid was cut, where the workers run and where the segments' pages ended up
+    std::string describePlacement() const;
+
+    // A worker process is this executable started with these arguments; main must hand it to
+    // runWorkerProcess before anything else, in particular before the GUI, is started
+    static bool isWorkerCommand(int argc, char** argv);
+    static int runWorkerProcess(int argc, char** argv);
+
+private:
+    struct Header;
+    struct WorkerSlot;
+
+    // Where the planes of one subdomain sit in its segment. Local coordinates put the owned cells
+    // at column 64 and row 1, so the west halo is a whole word and the owned words stay aligned.
+    struct Subdomain {
+        int ownedWidth;
+        int ownedHeight;
+        int words;                // Words per local row: the owned words and a halo word either side
+        int height;               // Local rows: the owned rows and a halo row either side
+        size_t cellsOffset;
+        size_t colorsOffset;
+        size_t agesOffset;
+        size_t bytes;
+    };
+    static Subdomain layout(const WorkerSlot& slot);
+
+    bool attach(const std::string& name, int index);
+    void touchSubdomain(int index);
+    void runWorker(int index);
+    void stop();
+    void unlinkSegments();
+    bool stopping() const;
+    bool workerExited();
+    int neighborOf(int index, int dx, int dy) const;
+    GridPlanes localPlanes(int index, std::int64_t generationParity) const;
+    void exchangeHalo(int index, std::int64_t generationReached) const;
+
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    bool toroidal = false;
+    LifeRule rule;
+    int columns = 0;                    // Subdomains across and down the grid
+    int rows = 0;
+    int workerCount = 0;
+    std::int64_t generation = 0;
+    std::vector<std::int64_t> populationHistory;
+
+    unsigned char* control = nullptr;   // Shared header and worker slots
+    size_t controlSize = 0;
+    Header* header = nullptr;
+    WorkerSlot* slots = nullptr;
+    std::vector<unsigned char*> segments;   // Each worker's subdomain and halo; in a worker process only its own and its neighbours'
+    std::vector<size_t> segmentSizes;
+    bool attached = false;              // This is a worker process mapping the coordinator's segments
+
+#ifdef _WIN32
+    std::vector<std::thread> workerThreads;
+#else
+    std::string segmentName;            // Prefix of the segments' names, until every worker has mapped them
+    std::vector<int> workerPids;        // -1 once a worker has been waited for
+#endif
+};
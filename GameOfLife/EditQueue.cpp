@@ -0,0 +1,161 @@
+#include "EditQueue.h"
+#include <algorithm>
+#include <cstdlib>
+
+EditQueue::~EditQueue() {
+    Batch* batch = head.exchange(nullptr, std::memory_order_acquire);
+    while (batch) {
+        Batch* next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+void EditQueue::push(UniverseEdit edit) {
+    std::vector<UniverseEdit> edits;
+    edits.push_back(std::move(edit));
+    push(std::move(edits));
+}
+
+void EditQueue::push(std::vector<UniverseEdit> edits) {
+    if (edits.empty()) {
+        return;
+    }
+    Batch* batch = new Batch{ std::move(edits), head.load(std::memory_order_relaxed) };
+    // The consumer only ever removes the whole stack, so a node is never popped and pushed back
+    // while a producer holds it, and the classic ABA problem cannot arise
+    while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+EditQueue::Batch* EditQueue::takeAll() {
+    Batch* newest = head.exchange(nullptr, std::memory_order_acquire);
+
+    // The stack is newest first; reverse it so edits land in the order they were made
+    Batch* oldest = nullptr;
+    while (newest) {
+        Batch* next = newest->next;
+        newest->next = oldest;
+        oldest = newest;
+        newest = next;
+    }
+    return oldest;
+}
+
+EditStats EditQueue::apply(Universe& universe) {
+    EditStats stats;
+    Batch* oldest = takeAll();
+    while (oldest) {
+        for (const UniverseEdit& edit : oldest->edits) {
+            switch (edit.kind) {
+            case EditKind::Run:
+                universe.fillRegion(edit.x, edit.y, edit.length, 1, edit.alive, edit.color);
+                stats.cellsPainted += edit.length;
+                break;
+            case EditKind::Stamp:
+                if (edit.pattern) {
+                    universe.stamp(*edit.pattern, edit.x, edit.y, edit.color, edit.alive);
+                }
+                break;
+            case EditKind::Place:
+                if (edit.libraryPattern && PatternLibrary::place(universe, *edit.libraryPattern, edit.placement) == 0) {
+                    stats.unplaced = edit.libraryPattern;
+                }
+                break;
+            case EditKind::Clear:
+                universe.clearAll(Universe::unpackColor(edit.color));
+                break;
+            case EditKind::Cycle:
+                universe.setCellAlive(edit.x, edit.y, !universe.getCellState(edit.x, edit.y), Universe::unpackColor(edit.color));
+                break;
+            }
+            stats.edits++;
+        }
+        stats.batches++;
+        Batch* next = oldest->next;
+        delete oldest;
+        oldest = next;
+    }
+    return stats;
+}
+
+EditStats EditQueue::apply(MultiStateUniverse& universe) {
+    EditStats stats;
+    const int drawState = universe.getRule().drawState();
+    Batch* oldest = takeAll();
+    while (oldest) {
+        for (const UniverseEdit& edit : oldest->edits) {
+            switch (edit.kind) {
+            case EditKind::Run:
+                for (int x = std::max(edit.x, 0); x < std::min<long long>(static_cast<long long>(edit.x) + edit.length, universe.getWidth()); x++) {
+                    universe.setState(x, edit.y, edit.alive ? drawState : 0);
+                }
+                stats.cellsPainted += edit.length;
+                break;
+            case EditKind::Stamp:
+                if (edit.pattern) {
+                    for (int y = 0; y < edit.pattern->height; y++) {
+                        for (int x = 0; x < edit.pattern->width; x++) {
+                            if (edit.pattern->get(x, y) || edit.alive) {
+                                universe.setState(edit.x + x, edit.y + y, edit.pattern->get(x, y) ? drawState : 0);
+                            }
+                        }
+                    }
+                }
+                break;
+            case EditKind::Place:
+                break;  // The commands that place patterns are disabled in multi-state mode
+            case EditKind::Clear:
+                universe.clear();
+                break;
+            case EditKind::Cycle:
+                universe.setState(edit.x, edit.y, (universe.getState(edit.x, edit.y) + 1) % universe.getRule().states);
+                break;
+            }
+            stats.edits++;
+        }
+        stats.batches++;
+        Batch* next = oldest->next;
+        delete oldest;
+        oldest = next;
+    }
+    return stats;
+}
+
+void EditQueue::strokeRuns(int x0, int y0, int x1, int y1, bool alive, std::uint32_t color, std::vector<UniverseEdit>& runs) {
+    int dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+    int stepX = x0 < x1 ? 1 : -1, stepY = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+
+    // Cells of a Bresenham line on one row are contiguous, so each row becomes a single run
+    int runStart = x0, x = x0, y = y0;
+    auto flush = [&](int runEnd) {
+        UniverseEdit run;
+        run.kind = EditKind::Run;
+        run.x = std::min(runStart, runEnd);
+        run.y = y;
+        run.length = std::abs(runEnd - runStart) + 1;
+        run.alive = alive;
+        run.color = color;
+        runs.push_back(run);
+    };
+    while (x != x1 || y != y1) {
+        int doubled = 2 * error;
+        int nextX = x, nextY = y;
+        if (doubled >= dy) {
+            error += dy;
+            nextX += stepX;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            nextY += stepY;
+        }
+        if (nextY != y) {
+            flush(x);
+            runStart = nextX;
+        }
+        x = nextX;
+        y = nextY;
+    }
+    flush(x);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "BitPattern.h"
+#include "MultiStateUniverse.h"
+#include "PatternLibrary.h"
+#include "Universe.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class EditKind {
+    Run,    // Sets or clears 'length' cells of row y starting at x
+    Stamp,  // Writes 'pattern' with its top-left corner at (x, y)
+    Place,  // Places 'libraryPattern' at a free spot chosen when the edit is applied
+    Clear,  // Kills every cell and repaints the colour plane
+    Cycle   // Moves the cell at (x, y) on to its next state; a two-state cell is toggled
+};
+
+struct UniverseEdit {
+    EditKind kind = EditKind::Run;
+    int x = 0;
+    int y = 0;
+    int length = 0;                                 // Run
+    bool alive = true;                              // Run: set or clear; Stamp: also clear the pattern's dead cells
+    std::uint32_t color = 0;                        // Colour of cells brought to life, or the background for Clear
+    std::shared_ptr<const BitPattern> pattern;      // Stamp
+    const Pattern* libraryPattern = nullptr;        // Place; owned by a library that outlives the queue
+    PlacementOptions placement;                     // Place
+};
+
+// What one call to EditQueue::apply did
+struct EditStats {
+    int batches = 0;
+    int edits = 0;
+    long long cellsPainted = 0;                     // Cells covered by runs
+    const Pattern* unplaced = nullptr;              // Last pattern that found no free spot, if any
+};
+
+// Edits to a running universe from any number of threads. Producers push batches onto a
+// lock-free stack with a single compare-and-swap and never wait for the engine; the engine
+// takes the whole stack with one exchange between generations and applies it oldest first,
+// so every batch lands completely within the same generation.
+class EditQueue {
+public:
+    EditQueue() = default;
+    ~EditQueue();
+
+    EditQueue(const EditQueue&) = delete;
+    EditQueue& operator=(const EditQueue&) = delete;
+
+    // Safe from any thread; the edits of a batch are applied together, in order
+    void push(UniverseEdit edit);
+    void push(std::vector<UniverseEdit> edits);
+
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+    // Applies everything pushed so far. Only the thread that steps the universe may call this.
+    EditStats apply(Universe& universe);
+    // The same for a multi-state universe: live cells are drawn in the rule's drawing state and
+    // dead ones in state 0. Place edits need a two-state universe and are dropped.
+    EditStats apply(MultiStateUniverse& universe);
+
+    // Rasterises a brush stroke from (x0, y0) to (x1, y1), both ends included, into row runs,
+    // merging the cells a line visits on the same row
+    static void strokeRuns(int x0, int y0, int x1, int y1, bool alive, std::uint32_t color, std::vector<UniverseEdit>& runs);
+
+private:
+    struct Batch {
+        std::vector<UniverseEdit> edits;
+        Batch* next = nullptr;
+    };
+
+    // Takes the whole stack and returns it oldest first
+    Batch* takeAll();
+
+    std::atomic<Batch*> head{ nullptr };            // Newest batch first
+};
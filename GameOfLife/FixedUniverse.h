@@ -0,0 +1,154 @@
+#pragma once
+
+#include "LifeRule.h"
+#include "LifeUniverse.h"
+#include "TileStepper.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+enum class Topology {
+    Bounded,    // Cells beyond the edges are dead
+    Toroidal    // The edges wrap around
+};
+
+// A universe whose size and edges are fixed at build time. Its alive plane lives in std::array
+// rows inside the object, packed like Universe's, so it never allocates; with every bound a
+// constant the compiler can unroll the row loop and keep the kernel in registers. Only the alive
+// plane is kept, without colours or ages, and everything down to a step is constexpr, so small
+// boards can even be run at compile time.
+template <int W, int H, Topology T = Topology::Bounded>
+class FixedUniverse {
+    static_assert(W > 0 && H > 0, "A fixed universe needs at least one cell");
+
+public:
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int WORDS_PER_ROW = (W + 63) / 64;
+    static constexpr bool TOROIDAL = T == Topology::Toroidal;
+
+    constexpr int getWidth() const { return W; }
+    constexpr int getHeight() const { return H; }
+    constexpr bool getToroidal() const { return TOROIDAL; }
+    constexpr bool isWithinBounds(int x, int y) const { return x >= 0 && x < W && y >= 0 && y < H; }
+
+    // Unchecked access for loops that stay inside the board
+    constexpr bool get(int x, int y) const {
+        return (planes[current][static_cast<size_t>(y) * WORDS_PER_ROW + (x >> 6)] >> (x & 63)) & 1ULL;
+    }
+    constexpr void set(int x, int y, bool alive) {
+        std::uint64_t& word = planes[current][static_cast<size_t>(y) * WORDS_PER_ROW + (x >> 6)];
+        std::uint64_t bit = 1ULL << (x & 63);
+        word = alive ? (word | bit) : (word & ~bit);
+    }
+
+    // Checked access, as Universe has it; cells outside the board read as dead
+    constexpr bool getCellState(int x, int y) const { return isWithinBounds(x, y) && get(x, y); }
+    constexpr void setCellAlive(int x, int y, bool alive) {
+        if (isWithinBounds(x, y)) {
+            set(x, y, alive);
+        }
+    }
+
+    constexpr void clear() { planes[current].fill(0); }
+    constexpr void setRule(const LifeRule& lifeRule) { rule = lifeRule; }
+    constexpr const LifeRule& getRule() const { return rule; }
+
+    constexpr long long getPopulation() const {
+        long long population = 0;
+        for (std::uint64_t word : planes[current]) {
+            population += std::popcount(word);
+        }
+        return population;
+    }
+
+    constexpr void play() { step(); }
+    constexpr void advance(int generations) {
+        for (int i = 0; i < generations; i++) {
+            step();
+        }
+    }
+
+    // The alive plane for code that takes GridPlanes, such as PatternSearch; there are no colour
+    // or age planes. Valid until the next step.
+    GridPlanes getPlanes() {
+        return GridPlanes{ W, H, WORDS_PER_ROW, TOROIDAL, planes[current].data(), nullptr, nullptr };
+    }
+
+private:
+    using Plane = std::array<std::uint64_t, static_cast<size_t>(WORDS_PER_ROW) * H>;
+    static constexpr std::uint64_t LAST_WORD_MASK = W % 64 == 0 ? ~0ULL : (1ULL << (W % 64)) - 1;
+
+    constexpr void step() {
+        if (rule.isConway()) {
+            stepWith<true>();
+        }
+        else {
+            stepWith<false>();
+        }
+    }
+
+    template <bool Conway>
+    constexpr void stepWith() {
+        const Plane& source = planes[current];
+        Plane& target = planes[current ^ 1];
+        const std::uint64_t* empty = emptyRow.data();
+        for (int y = 0; y < H; y++) {
+            const std::uint64_t* above = y > 0 ? &source[static_cast<size_t>(y - 1) * WORDS_PER_ROW]
+                : TOROIDAL ? &source[static_cast<size_t>(H - 1) * WORDS_PER_ROW] : empty;
+            const std::uint64_t* row = &source[static_cast<size_t>(y) * WORDS_PER_ROW];
+            const std::uint64_t* below = y < H - 1 ? &source[static_cast<size_t>(y + 1) * WORDS_PER_ROW]
+                : TOROIDAL ? &source[0] : empty;
+            std::uint64_t* next = &target[static_cast<size_t>(y) * WORDS_PER_ROW];
+            for (int w = 0; w < WORDS_PER_ROW; w++) {
+                std::uint64_t result = 0;
+                if constexpr (Conway) {
+                    result = TileStepper::nextWord(westOf(above, w), above[w], eastOf(above, w), westOf(row, w), row[w], eastOf(row, w),
+                        westOf(below, w), below[w], eastOf(below, w));
+                }
+                else {
+                    result = TileStepper::nextWord(westOf(above, w), above[w], eastOf(above, w), westOf(row, w), row[w], eastOf(row, w),
+                        westOf(below, w), below[w], eastOf(below, w), rule);
+                }
+                next[w] = w == WORDS_PER_ROW - 1 ? result & LAST_WORD_MASK : result;
+            }
+        }
+        current ^= 1;
+    }
+
+    // Each bit's western and eastern neighbour, carried in from the adjacent words or, on a
+    // torus, from the other end of the row
+    static constexpr std::uint64_t westOf(const std::uint64_t* row, int w) {
+        std::uint64_t carry = w > 0 ? row[w - 1] >> 63 : TOROIDAL ? (row[WORDS_PER_ROW - 1] >> ((W - 1) & 63)) & 1 : 0;
+        return (row[w] << 1) | carry;
+    }
+    static constexpr std::uint64_t eastOf(const std::uint64_t* row, int w) {
+        std::uint64_t carry = w + 1 < WORDS_PER_ROW ? row[w + 1] << 63 : TOROIDAL ? (row[0] & 1) << ((W - 1) & 63) : 0;
+        return (row[w] >> 1) | carry;
+    }
+
+    std::array<Plane, 2> planes{};      // The current generation and the step target, by 'current'
+    int current = 0;
+    std::array<std::uint64_t, WORDS_PER_ROW> emptyRow{};    // Stands in for the rows beyond bounded edges
+    LifeRule rule;                      // Conway's B3/S23 unless set
+};
+
+static_assert(LifeUniverse<FixedUniverse<100, 100>>);
+static_assert(LifeUniverse<FixedUniverse<256, 256, Topology::Toroidal>>);
+
+namespace FixedUniverseChecks {
+    // A blinker laid across the wrapped edge of the default board turns and turns back, worked
+    // out entirely by the compiler
+    constexpr bool blinkerWrapsAround() {
+        FixedUniverse<100, 100, Topology::Toroidal> board;
+        board.setCellAlive(99, 1, true);
+        board.setCellAlive(0, 1, true);
+        board.setCellAlive(1, 1, true);
+        board.play();
+        bool turned = board.getPopulation() == 3 && board.get(0, 0) && board.get(0, 1) && board.get(0, 2);
+        board.play();
+        return turned && board.getPopulation() == 3 && board.get(99, 1) && board.get(0, 1) && board.get(1, 1);
+    }
+    static_assert(blinkerWrapsAround());
+}
@@ -0,0 +1,255 @@
+#include "FrameCodec.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+    void putU32(std::vector<unsigned char>& out, std::uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    void putU64(std::vector<unsigned char>& out, std::uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    std::uint32_t getU32(const unsigned char* data) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<std::uint32_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t getU64(const unsigned char* data) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    void writeHeader(std::vector<unsigned char>& out, const FrameHeader& header) {
+        putU32(out, FRAME_MAGIC);
+        out.push_back(static_cast<unsigned char>(header.type));
+        out.insert(out.end(), 3, 0);
+        putU64(out, static_cast<std::uint64_t>(header.generation));
+        putU32(out, static_cast<std::uint32_t>(header.universeWidth));
+        putU32(out, static_cast<std::uint32_t>(header.universeHeight));
+        putU32(out, static_cast<std::uint32_t>(header.region.x));
+        putU32(out, static_cast<std::uint32_t>(header.region.y));
+        putU32(out, static_cast<std::uint32_t>(header.region.width));
+        putU32(out, static_cast<std::uint32_t>(header.region.height));
+        putU32(out, header.tileCount);
+        putU64(out, header.checksum);
+    }
+}
+
+void TileRegion::reset(const FrameRegion& requestedRegion, int width, int height) {
+    // Sizes and regions may come off the wire, so nothing here is trusted to be in range
+    universeWidth = std::max(width, 0);
+    universeHeight = std::max(height, 0);
+
+    requested = requestedRegion;
+    region = requestedRegion;
+    if (region.width <= 0 || region.height <= 0) {
+        region = FrameRegion{ 0, 0, universeWidth, universeHeight };
+    }
+    // Clamped in 64 bits, since x + width can overflow an int; every sum of a clamped
+    // coordinate and size after this stays within the universe
+    long long x0 = std::clamp<long long>(region.x, 0, universeWidth);
+    long long y0 = std::clamp<long long>(region.y, 0, universeHeight);
+    long long x1 = std::clamp<long long>(static_cast<long long>(region.x) + region.width, x0, universeWidth);
+    long long y1 = std::clamp<long long>(static_cast<long long>(region.y) + region.height, y0, universeHeight);
+    region = FrameRegion{ static_cast<int>(x0), static_cast<int>(y0), static_cast<int>(x1 - x0), static_cast<int>(y1 - y0) };
+
+    if (region.width == 0 || region.height == 0) {
+        firstTileX = firstTileY = tilesAcross = tilesDown = 0;
+    }
+    else {
+        firstTileX = region.x / FRAME_TILE_SIZE;
+        firstTileY = region.y / FRAME_TILE_SIZE;
+        tilesAcross = (region.x + region.width - 1) / FRAME_TILE_SIZE - firstTileX + 1;
+        tilesDown = (region.y + region.height - 1) / FRAME_TILE_SIZE - firstTileY + 1;
+    }
+    tiles.assign(static_cast<size_t>(tilesAcross) * tilesDown * FRAME_TILE_SIZE, 0);
+}
+
+bool TileRegion::containsTile(int tileX, int tileY) const {
+    return tileX >= firstTileX && tileX < firstTileX + tilesAcross && tileY >= firstTileY && tileY < firstTileY + tilesDown;
+}
+
+std::uint64_t* TileRegion::tileRows(int tileX, int tileY) {
+    size_t index = static_cast<size_t>(tileY - firstTileY) * tilesAcross + (tileX - firstTileX);
+    return &tiles[index * FRAME_TILE_SIZE];
+}
+
+const std::uint64_t* TileRegion::tileRows(int tileX, int tileY) const {
+    size_t index = static_cast<size_t>(tileY - firstTileY) * tilesAcross + (tileX - firstTileX);
+    return &tiles[index * FRAME_TILE_SIZE];
+}
+
+bool TileRegion::getCell(int x, int y) const {
+    if (x < region.x || x >= region.x + region.width || y < region.y || y >= region.y + region.height) {
+        return false;
+    }
+    const std::uint64_t* rows = tileRows(x / FRAME_TILE_SIZE, y / FRAME_TILE_SIZE);
+    return (rows[y % FRAME_TILE_SIZE] >> (x % FRAME_TILE_SIZE)) & 1ULL;
+}
+
+std::uint64_t TileRegion::checksum() const {
+    // FNV-1a over the tile words
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::uint64_t word : tiles) {
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+void TileRegion::extract(std::uint64_t* cells, int wordsPerRow) const {
+    // Tiles are one word wide and the encoder masks out columns beyond the region
+    for (int tileY = firstTileY; tileY < firstTileY + tilesDown; tileY++) {
+        for (int tileX = firstTileX; tileX < firstTileX + tilesAcross; tileX++) {
+            const std::uint64_t* rows = tileRows(tileX, tileY);
+            for (int row = 0; row < FRAME_TILE_SIZE; row++) {
+                int y = tileY * FRAME_TILE_SIZE + row;
+                if (y >= region.y && y < region.y + region.height) {
+                    cells[static_cast<size_t>(y) * wordsPerRow + tileX] = rows[row];
+                }
+            }
+        }
+    }
+}
+
+std::uint32_t TileFrameEncoder::encode(const std::uint64_t* cells, int width, int height, int wordsPerRow,
+    std::int64_t generation, bool keyframe, std::vector<unsigned char>& out) {
+    if (width != universeWidth || height != universeHeight) {
+        // Keep asking for the same area; it is re-clamped against the new size
+        reset(requested, width, height);
+        synchronized = false;
+    }
+    keyframe = keyframe || !synchronized;
+
+    size_t headerAt = out.size();
+    FrameHeader header;
+    header.type = keyframe ? FrameType::Keyframe : FrameType::Delta;
+    header.generation = generation;
+    header.universeWidth = width;
+    header.universeHeight = height;
+    header.region = region;
+    writeHeader(out, header);
+
+    if (keyframe) {
+        std::fill(tiles.begin(), tiles.end(), 0);
+    }
+
+    std::uint32_t tileCount = 0;
+    std::uint64_t current[FRAME_TILE_SIZE];
+    for (int tileY = firstTileY; tileY < firstTileY + tilesDown; tileY++) {
+        for (int tileX = firstTileX; tileX < firstTileX + tilesAcross; tileX++) {
+            // Only the columns of this word that fall inside the region are sent
+            std::uint64_t columnMask = ~0ULL;
+            int left = region.x - tileX * FRAME_TILE_SIZE;
+            int right = tileX * FRAME_TILE_SIZE + FRAME_TILE_SIZE - (region.x + region.width);
+            if (left > 0) {
+                columnMask &= ~0ULL << left;
+            }
+            if (right > 0) {
+                columnMask &= ~0ULL >> right;
+            }
+
+            bool empty = true;
+            for (int row = 0; row < FRAME_TILE_SIZE; row++) {
+                int y = tileY * FRAME_TILE_SIZE + row;
+                bool inside = y >= region.y && y < region.y + region.height;
+                current[row] = inside ? cells[static_cast<size_t>(y) * wordsPerRow + tileX] & columnMask : 0;
+                empty = empty && current[row] == 0;
+            }
+
+            std::uint64_t* held = tileRows(tileX, tileY);
+            bool send = keyframe ? !empty : !std::equal(current, current + FRAME_TILE_SIZE, held);
+            if (!send) {
+                continue;
+            }
+            std::copy(current, current + FRAME_TILE_SIZE, held);
+            putU32(out, static_cast<std::uint32_t>(tileX));
+            putU32(out, static_cast<std::uint32_t>(tileY));
+            for (int row = 0; row < FRAME_TILE_SIZE; row++) {
+                putU64(out, current[row]);
+            }
+            tileCount++;
+        }
+    }
+    synchronized = true;
+
+    // Patch the tile count and checksum now that both are known
+    header.tileCount = tileCount;
+    header.checksum = checksum();
+    std::vector<unsigned char> patched;
+    writeHeader(patched, header);
+    std::copy(patched.begin(), patched.end(), out.begin() + headerAt);
+    return tileCount;
+}
+
+bool TileFrameDecoder::readHeader(const unsigned char* data, size_t size, FrameHeader& header) {
+    if (size < FRAME_HEADER_BYTES || getU32(data) != FRAME_MAGIC) {
+        return false;
+    }
+    header.type = static_cast<FrameType>(data[4]);
+    header.generation = static_cast<std::int64_t>(getU64(data + 8));
+    header.universeWidth = static_cast<int>(getU32(data + 16));
+    header.universeHeight = static_cast<int>(getU32(data + 20));
+    header.region.x = static_cast<int>(getU32(data + 24));
+    header.region.y = static_cast<int>(getU32(data + 28));
+    header.region.width = static_cast<int>(getU32(data + 32));
+    header.region.height = static_cast<int>(getU32(data + 36));
+    header.tileCount = getU32(data + 40);
+    header.checksum = getU64(data + 44);
+    return true;
+}
+
+bool TileFrameDecoder::apply(const unsigned char* data, size_t size) {
+    FrameHeader header;
+    if (!readHeader(data, size, header) || size < frameSize(header)) {
+        return false;
+    }
+
+    if (header.type == FrameType::Keyframe) {
+        reset(header.region, header.universeWidth, header.universeHeight);
+        synchronized = true;
+    }
+    else if (!synchronized) {
+        return false;
+    }
+
+    const unsigned char* tile = data + FRAME_HEADER_BYTES;
+    for (std::uint32_t i = 0; i < header.tileCount; i++, tile += FRAME_TILE_BYTES) {
+        int tileX = static_cast<int>(getU32(tile));
+        int tileY = static_cast<int>(getU32(tile + 4));
+        if (!containsTile(tileX, tileY)) {
+            synchronized = false;
+            return false;
+        }
+        std::uint64_t* rows = tileRows(tileX, tileY);
+        for (int row = 0; row < FRAME_TILE_SIZE; row++) {
+            rows[row] = getU64(tile + 8 + 8 * row);
+        }
+    }
+
+    generation = header.generation;
+    if (checksum() != header.checksum) {
+        synchronized = false;
+        return false;
+    }
+    return true;
+}
+
+std::int64_t TileFrameDecoder::getPopulation() const {
+    std::int64_t population = 0;
+    for (std::uint64_t word : tiles) {
+        population += std::popcount(word);
+    }
+    return population;
+}
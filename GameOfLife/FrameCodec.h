@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frames describe the alive cells of a rectangular region of the universe as 64x64 tiles
+// aligned to the global grid. A keyframe carries every non-empty tile of the region; a delta
+// frame carries only the tiles that changed since the previous frame sent to the same receiver.
+//
+// Wire layout (little-endian):
+//   u32 magic, u8 type, u8[3] reserved, i64 generation,
+//   i32 universeWidth, i32 universeHeight, i32 regionX, i32 regionY, i32 regionWidth, i32 regionHeight,
+//   u32 tileCount, u64 checksum,
+//   tileCount x { i32 tileX, i32 tileY, u64 rows[64] }
+// The checksum is taken over the whole region after the frame is applied, so a receiver can
+// verify it reconstructed exactly what the sender holds.
+
+static const std::uint32_t FRAME_MAGIC = 0x464C4F47;  // "GOLF"
+static const int FRAME_TILE_SIZE = 64;
+static const size_t FRAME_HEADER_BYTES = 4 + 4 + 8 + 6 * 4 + 4 + 8;
+static const size_t FRAME_TILE_BYTES = 8 + FRAME_TILE_SIZE * 8;
+
+enum class FrameType : std::uint8_t {
+    Keyframe = 0,
+    Delta = 1
+};
+
+struct FrameRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct FrameHeader {
+    FrameType type = FrameType::Keyframe;
+    std::int64_t generation = 0;
+    int universeWidth = 0;
+    int universeHeight = 0;
+    FrameRegion region;
+    std::uint32_t tileCount = 0;
+    std::uint64_t checksum = 0;
+};
+
+// The tiles covering a region, one word per tile row, as held by a sender or receiver
+class TileRegion {
+public:
+    // Clamps 'region' to the universe (an empty region means the whole universe) and clears the tiles
+    void reset(const FrameRegion& region, int universeWidth, int universeHeight);
+
+    const FrameRegion& getRegion() const { return region; }
+    int getUniverseWidth() const { return universeWidth; }
+    int getUniverseHeight() const { return universeHeight; }
+
+    // Gets whether the cell at universe coordinates (x, y) is alive
+    bool getCell(int x, int y) const;
+
+    // Hash of every tile in the region
+    std::uint64_t checksum() const;
+
+    // Writes the region's tiles into an alive plane of the universe's size laid out like
+    // GridPlanes::cells. Tiles are whole words, so columns of a word outside the region come out dead.
+    void extract(std::uint64_t* cells, int wordsPerRow) const;
+
+protected:
+    std::uint64_t* tileRows(int tileX, int tileY);
+    const std::uint64_t* tileRows(int tileX, int tileY) const;
+    bool containsTile(int tileX, int tileY) const;
+
+    FrameRegion requested;      // Region as asked for, before clamping
+    FrameRegion region;
+    int universeWidth = 0;
+    int universeHeight = 0;
+    int firstTileX = 0;         // Global tile coordinates covered by the region
+    int firstTileY = 0;
+    int tilesAcross = 0;
+    int tilesDown = 0;
+    std::vector<std::uint64_t> tiles;
+};
+
+// Produces the frames that bring a receiver's copy of a region up to date
+class TileFrameEncoder : public TileRegion {
+public:
+    // Forces the next frame to be a keyframe
+    void invalidate() { synchronized = false; }
+
+    // Appends a frame for the alive plane 'cells' to 'out'. A keyframe is produced when
+    // requested, after invalidate(), or when the universe size changed; otherwise a delta.
+    // Returns the number of tiles written.
+    std::uint32_t encode(const std::uint64_t* cells, int width, int height, int wordsPerRow,
+        std::int64_t generation, bool keyframe, std::vector<unsigned char>& out);
+
+private:
+    bool synchronized = false;
+};
+
+// Rebuilds a region from a sequence of frames
+class TileFrameDecoder : public TileRegion {
+public:
+    // Parses a header; returns false if 'size' is too short or the magic is wrong
+    static bool readHeader(const unsigned char* data, size_t size, FrameHeader& header);
+
+    // Total encoded size of the frame described by 'header'
+    static size_t frameSize(const FrameHeader& header) { return FRAME_HEADER_BYTES + header.tileCount * FRAME_TILE_BYTES; }
+
+    // Applies one complete frame; returns false if a delta arrives without a keyframe before it
+    // or the reconstructed region does not match the frame's checksum
+    bool apply(const unsigned char* data, size_t size);
+
+    std::int64_t getGeneration() const { return generation; }
+    std::int64_t getPopulation() const;
+
+private:
+    bool synchronized = false;
+    std::int64_t generation = -1;
+};
@@ -0,0 +1,214 @@
+#include "FrameExporter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <wx/image.h>
+
+namespace {
+    std::int64_t nowNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline void putPixel(unsigned char* pixel, std::uint32_t color) {
+        pixel[0] = static_cast<unsigned char>(color >> 16);
+        pixel[1] = static_cast<unsigned char>(color >> 8);
+        pixel[2] = static_cast<unsigned char>(color);
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    cancel();
+}
+
+bool FrameExporter::start(const Universe& source, const ExportOptions& exportOptions) {
+    cancel();
+
+    options = exportOptions;
+    options.frames = std::max(1, options.frames);
+    options.generationsPerFrame = std::max(0, options.generationsPerFrame);
+    options.cellSize = std::max(1, options.cellSize);
+    options.imageWidth = std::max(1, options.imageWidth);
+    options.imageHeight = std::max(1, options.imageHeight);
+
+    if (options.format == ExportFormat::RawRgb) {
+        rawOutput = options.path == "-" ? stdout : std::fopen(options.path.c_str(), "wb");
+        if (!rawOutput) {
+            return false;
+        }
+    }
+
+    universe = source;
+    queue = std::make_unique<BoundedQueue<Frame>>(std::max<size_t>(1, options.queueDepth));
+    cancelled = false;
+    failed = false;
+    framesWritten = 0;
+    startedAt = nowNanoseconds();
+    finishedAt = 0;
+    running = true;
+
+    producer = std::thread(&FrameExporter::produce, this);
+    consumer = std::thread(&FrameExporter::consume, this);
+    return true;
+}
+
+void FrameExporter::cancel() {
+    cancelled = true;
+    if (queue) {
+        queue->close();
+    }
+    wait();
+}
+
+void FrameExporter::wait() {
+    if (producer.joinable()) {
+        producer.join();
+    }
+    if (consumer.joinable()) {
+        consumer.join();
+    }
+    if (rawOutput && rawOutput != stdout) {
+        std::fclose(rawOutput);
+    }
+    else if (rawOutput) {
+        std::fflush(rawOutput);
+    }
+    rawOutput = nullptr;
+}
+
+double FrameExporter::getFramesPerSecond() const {
+    std::int64_t end = running.load() ? nowNanoseconds() : finishedAt.load();
+    double seconds = (end - startedAt.load()) / 1e9;
+    return seconds > 0 ? framesWritten.load() / seconds : 0.0;
+}
+
+void FrameExporter::produce() {
+    // Stage one: step and rasterise. Blocks on the queue when the encoder falls behind.
+    for (int index = 0; index < options.frames && !cancelled.load(); index++) {
+        if (index > 0) {
+            universe.advance(options.generationsPerFrame);
+        }
+        Frame frame;
+        frame.index = index;
+        render(universe, options, frame.pixels);
+        if (!queue->push(std::move(frame))) {
+            break;
+        }
+    }
+    queue->close();
+}
+
+void FrameExporter::consume() {
+    // Stage two: encode and write, in frame order
+    Frame frame;
+    while (queue->pop(frame)) {
+        if (cancelled.load()) {
+            continue;  // Drain without writing
+        }
+        if (!writeFrame(frame)) {
+            failed = true;
+            cancelled = true;
+            queue->close();
+            continue;
+        }
+        framesWritten++;
+    }
+    finishedAt = nowNanoseconds();
+    running = false;
+}
+
+std::string FrameExporter::sequencePath(int index) const {
+    // "frames.png" becomes "frames_000001.png"
+    std::string base = options.path;
+    std::string extension;
+    std::size_t dot = base.find_last_of('.');
+    std::size_t slash = base.find_last_of("/\\");
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+        extension = base.substr(dot);
+        base = base.substr(0, dot);
+    }
+    char number[16];
+    std::snprintf(number, sizeof(number), "_%06d", index + 1);
+    return base + number + extension;
+}
+
+bool FrameExporter::writeFrame(const Frame& frame) {
+    switch (options.format) {
+    case ExportFormat::RawRgb:
+        return std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), rawOutput) == frame.pixels.size();
+
+    case ExportFormat::PpmSequence: {
+        std::FILE* file = std::fopen(sequencePath(frame.index).c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::fprintf(file, "P6\n%d %d\n255\n", options.imageWidth, options.imageHeight);
+        bool ok = std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), file) == frame.pixels.size();
+        return std::fclose(file) == 0 && ok;
+    }
+
+    case ExportFormat::PngSequence: {
+        // The image borrows the pixel buffer instead of copying it
+        wxImage image(options.imageWidth, options.imageHeight, const_cast<unsigned char*>(frame.pixels.data()), true);
+        return image.SaveFile(sequencePath(frame.index), wxBITMAP_TYPE_PNG);
+    }
+    }
+    return false;
+}
+
+void FrameExporter::render(Universe& universe, const ExportOptions& options, std::vector<unsigned char>& pixels) {
+    const int imageWidth = options.imageWidth;
+    const int imageHeight = options.imageHeight;
+    const int cellSize = options.cellSize;
+    const bool grid = options.drawGrid && cellSize >= 3;
+    const bool monochrome = universe.getMonochrome();
+    pixels.resize(static_cast<size_t>(imageWidth) * imageHeight * 3);
+
+    GridPlanes planes = universe.getPlanes();
+    const int visibleColumns = std::min(planes.width, (imageWidth + cellSize - 1) / cellSize);
+    const size_t rowBytes = static_cast<size_t>(imageWidth) * 3;
+
+    // Build one pixel row per cell row, then repeat it down the cell's height
+    std::vector<unsigned char> cellRow(rowBytes);
+    for (int cellY = 0; cellY * cellSize < imageHeight; cellY++) {
+        unsigned char* out = cellRow.data();
+        for (int px = 0; px < imageWidth; px++) {
+            putPixel(out + 3 * px, options.backgroundColor);
+        }
+        if (cellY < planes.height) {
+            const std::uint64_t* bits = planes.cells + static_cast<size_t>(cellY) * planes.wordsPerRow;
+            const std::uint32_t* colors = planes.colors + static_cast<size_t>(cellY) * planes.width;
+            const std::uint8_t* ages = planes.ages + static_cast<size_t>(cellY) * planes.width;
+            for (int cellX = 0; cellX < visibleColumns; cellX++) {
+                if (!((bits[cellX >> 6] >> (cellX & 63)) & 1ULL)) {
+                    continue;
+                }
+                int x0 = cellX * cellSize;
+                int x1 = std::min(x0 + cellSize, imageWidth);
+                std::uint32_t color = monochrome ? options.cellColor
+                    : options.ageHeatmap ? Universe::ageColor(ages[cellX]) : colors[cellX];
+                for (int px = x0; px < x1; px++) {
+                    putPixel(out + 3 * px, color);
+                }
+            }
+        }
+        if (grid) {
+            for (int px = 0; px < imageWidth; px += cellSize) {
+                putPixel(out + 3 * px, options.gridColor);
+            }
+        }
+
+        int y0 = cellY * cellSize;
+        int y1 = std::min(y0 + cellSize, imageHeight);
+        for (int py = y0; py < y1; py++) {
+            unsigned char* target = pixels.data() + static_cast<size_t>(py) * rowBytes;
+            if (grid && py == y0) {
+                for (int px = 0; px < imageWidth; px++) {
+                    putPixel(target + 3 * px, options.gridColor);
+                }
+            }
+            else {
+                std::copy(cellRow.begin(), cellRow.end(), target);
+            }
+        }
+    }
+}
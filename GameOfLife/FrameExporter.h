@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "Universe.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportFormat {
+    PngSequence,    // One PNG per frame: <name>_000001.png, ...
+    PpmSequence,    // One binary PPM (P6) per frame
+    RawRgb          // Headerless 24-bit RGB frames appended to one file ("-" for stdout),
+                    // e.g. for: ffmpeg -f rawvideo -pix_fmt rgb24 -s <w>x<h> -i frames.rgb out.mp4
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::PngSequence;
+    std::string path;                   // Sequence name pattern or raw output file
+    int frames = 100;                   // Number of frames to write
+    int generationsPerFrame = 1;        // Generations advanced between frames
+    int imageWidth = 1920;              // Output resolution in pixels
+    int imageHeight = 1080;
+    int cellSize = 4;                   // Pixels per cell edge
+    bool drawGrid = true;               // Draw grid lines when cells are at least 3 pixels
+    bool ageHeatmap = false;            // Colour live cells by age instead of by their own colour
+    std::uint32_t backgroundColor = 0xFFFFFF;
+    std::uint32_t gridColor = 0x000000;
+    std::uint32_t cellColor = 0x000000; // Every live cell while the universe is monochrome, whose colours are stale
+    size_t queueDepth = 8;              // Rendered frames that may wait for the encoder
+};
+
+// Renders generations offscreen and writes them out in a two-stage pipeline: one thread
+// advances a private copy of the universe and rasterises each frame, another encodes and
+// writes them. A bounded queue between the stages means throughput is set by the encoder
+// and disk rather than by the GUI timer, while memory stays capped at queueDepth frames.
+class FrameExporter {
+public:
+    FrameExporter() = default;
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // Starts exporting from a copy of 'source'; returns false if the output cannot be opened
+    bool start(const Universe& source, const ExportOptions& options);
+
+    // Stops both stages early and waits for them
+    void cancel();
+
+    // Waits until every frame has been written
+    void wait();
+
+    bool isRunning() const { return running.load(); }
+    bool hasFailed() const { return failed.load(); }
+    int getFramesWritten() const { return framesWritten.load(); }
+    double getFramesPerSecond() const;
+
+    // Rasterises the universe into 'pixels' (RGB, imageWidth * imageHeight * 3 bytes)
+    static void render(Universe& universe, const ExportOptions& options, std::vector<unsigned char>& pixels);
+
+private:
+    struct Frame {
+        int index = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    void produce();
+    void consume();
+    bool writeFrame(const Frame& frame);
+    std::string sequencePath(int index) const;
+
+    ExportOptions options;
+    Universe universe{ 0, 0 };
+    std::unique_ptr<BoundedQueue<Frame>> queue;
+    std::thread producer;
+    std::thread consumer;
+    std::FILE* rawOutput = nullptr;
+
+    std::atomic<bool> running{ false };
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> failed{ false };
+    std::atomic<int> framesWritten{ 0 };
+    std::atomic<std::int64_t> startedAt{ 0 };
+    std::atomic<std::int64_t> finishedAt{ 0 };
+};
@@ -0,0 +1,270 @@
+#include "FrameServer.h"
+#include "SocketUtil.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+const int FrameServer::DEFAULT_PORT = 5757;
+
+struct FrameServer::Client {
+    socket_t socket = INVALID_SOCKET_HANDLE;
+    bool subscribed = false;
+    bool closed = false;
+    int every = 1;                          // Send at most one frame per this many generations
+    std::int64_t nextGeneration = 0;        // Earliest generation this client should get next
+    TileFrameEncoder encoder;
+    std::string inbox;                      // Partial subscribe line
+    std::vector<unsigned char> outbox;      // Encoded frame still being sent
+    size_t sent = 0;
+};
+
+namespace {
+    // Parses "SUBSCRIBE every=<n> region=<x>,<y>,<w>,<h>"
+    bool parseSubscribe(const std::string& line, int& every, FrameRegion& region) {
+        std::istringstream ss(line);
+        std::string word;
+        if (!(ss >> word) || word != "SUBSCRIBE") {
+            return false;
+        }
+        while (ss >> word) {
+            std::size_t pos = word.find('=');
+            if (pos == std::string::npos) {
+                continue;
+            }
+            std::string key = word.substr(0, pos);
+            std::string value = word.substr(pos + 1);
+            if (key == "every") {
+                every = std::max(1, std::atoi(value.c_str()));
+            }
+            else if (key == "region") {
+                std::replace(value.begin(), value.end(), ',', ' ');
+                std::istringstream rs(value);
+                rs >> region.x >> region.y >> region.width >> region.height;
+            }
+        }
+        return true;
+    }
+}
+
+void FrameServer::flush(Client& client) {
+    // Sends as much of the outbox as the socket takes without blocking
+    while (client.sent < client.outbox.size()) {
+        int n = sendBytes(client.socket, client.outbox.data() + client.sent, client.outbox.size() - client.sent);
+        if (n <= 0) {
+            if (n < 0 && socketWouldBlock()) {
+                return;
+            }
+            client.closed = true;
+            return;
+        }
+        client.sent += n;
+    }
+    client.outbox.clear();
+    client.sent = 0;
+}
+
+FrameServer::~FrameServer() {
+    stop();
+}
+
+bool FrameServer::start(int listenPort) {
+    stop();
+    if (!initSockets()) {
+        return false;
+    }
+
+    socket_t listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET_HANDLE) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Local subscribers only
+    address.sin_port = htons(static_cast<unsigned short>(listenPort));
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 8) != 0 || !setNonBlocking(listener)) {
+        closeSocket(listener);
+        return false;
+    }
+
+    port = listenPort;
+    listenSocket = static_cast<std::intptr_t>(listener);
+    running = true;
+    serverThread = std::thread(&FrameServer::serve, this);
+    return true;
+}
+
+void FrameServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    serverThread.join();
+    closeSocket(static_cast<socket_t>(listenSocket));
+    listenSocket = -1;
+    nextWantedGeneration = INT64_MAX;
+    refreshWanted = false;
+    clientCount = 0;
+
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    latest.reset();
+}
+
+void FrameServer::publish(const GridPlanes& planes, std::int64_t generation, bool restart) {
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    bool refresh = refreshWanted.exchange(false, std::memory_order_relaxed) || restart;
+    if (!refresh && generation < nextWantedGeneration.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::shared_ptr<Snapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        snapshot.swap(spare);
+    }
+    if (!snapshot) {
+        snapshot = std::make_shared<Snapshot>();
+    }
+    snapshot->generation = generation;
+    snapshot->width = planes.width;
+    snapshot->height = planes.height;
+    snapshot->wordsPerRow = planes.wordsPerRow;
+    snapshot->restart = restart;
+    snapshot->cells.assign(planes.cells, planes.cells + static_cast<size_t>(planes.wordsPerRow) * planes.height);
+
+    // A generation the server has not picked up yet is replaced by this newer one, which takes
+    // over its break in the sequence
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    if (latest && latest->restart) {
+        snapshot->restart = true;
+    }
+    latest.swap(snapshot);
+    if (snapshot && !spare) {
+        spare = std::move(snapshot);
+    }
+}
+
+void FrameServer::serve() {
+    socket_t listener = static_cast<socket_t>(listenSocket);
+    std::vector<std::unique_ptr<Client>> clients;
+    std::shared_ptr<Snapshot> current;
+
+    while (running.load()) {
+        fd_set readable, writable;
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        FD_SET(listener, &readable);
+        socket_t highest = listener;
+        for (const auto& client : clients) {
+            FD_SET(client->socket, &readable);
+            if (!client->outbox.empty()) {
+                FD_SET(client->socket, &writable);
+            }
+            highest = std::max(highest, client->socket);
+        }
+        timeval timeout{ 0, 5000 };
+        select(static_cast<int>(highest + 1), &readable, &writable, nullptr, &timeout);
+
+        if (FD_ISSET(listener, &readable)) {
+            socket_t accepted = accept(listener, nullptr, nullptr);
+            if (accepted != INVALID_SOCKET_HANDLE && setNonBlocking(accepted)) {
+                int noDelay = 1;
+                setsockopt(accepted, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+                auto client = std::make_unique<Client>();
+                client->socket = accepted;
+                clients.push_back(std::move(client));
+            }
+            else if (accepted != INVALID_SOCKET_HANDLE) {
+                closeSocket(accepted);
+            }
+        }
+
+        for (auto& client : clients) {
+            if (!FD_ISSET(client->socket, &readable)) {
+                continue;
+            }
+            unsigned char buffer[512];
+            int n = receiveBytes(client->socket, buffer, sizeof(buffer));
+            if (n <= 0) {
+                if (n == 0 || !socketWouldBlock()) {
+                    client->closed = true;
+                }
+                continue;
+            }
+            client->inbox.append(reinterpret_cast<const char*>(buffer), n);
+            std::size_t newline;
+            while ((newline = client->inbox.find('\n')) != std::string::npos) {
+                std::string line = client->inbox.substr(0, newline);
+                client->inbox.erase(0, newline + 1);
+                int every = 1;
+                FrameRegion region;
+                if (parseSubscribe(line, every, region)) {
+                    // A new subscription always starts from a keyframe, of the generation on
+                    // screen rather than whatever older one the server still holds
+                    client->subscribed = true;
+                    client->every = every;
+                    client->encoder.reset(region, 0, 0);
+                    client->encoder.invalidate();
+                    client->nextGeneration = 0;
+                    current.reset();
+                    refreshWanted = true;
+                }
+            }
+        }
+
+        // Pick up the newest generation, returning the one it replaces for reuse
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            if (latest) {
+                if (current && !spare) {
+                    spare = std::move(current);
+                }
+                current = std::move(latest);
+            }
+        }
+
+        // After a break in the sequence the generations subscribers were waiting for may never
+        // come, so every one starts over from a keyframe of this generation
+        if (current && current->restart) {
+            current->restart = false;
+            for (auto& client : clients) {
+                client->encoder.invalidate();
+                client->nextGeneration = current->generation;
+            }
+        }
+
+        std::int64_t wanted = INT64_MAX;
+        for (auto& client : clients) {
+            flush(*client);
+            if (client->closed || !client->subscribed) {
+                continue;
+            }
+            // Clients still draining a frame skip this generation; their next delta covers it
+            if (current && client->outbox.empty() && current->generation >= client->nextGeneration) {
+                client->encoder.encode(current->cells.data(), current->width, current->height, current->wordsPerRow,
+                    current->generation, false, client->outbox);
+                client->nextGeneration = current->generation + client->every;
+                flush(*client);
+            }
+            wanted = std::min(wanted, client->nextGeneration);
+        }
+        nextWantedGeneration.store(wanted, std::memory_order_relaxed);
+
+        for (auto& client : clients) {
+            if (client->closed) {
+                closeSocket(client->socket);
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+            [](const std::unique_ptr<Client>& client) { return client->closed; }), clients.end());
+        clientCount.store(static_cast<int>(clients.size()));
+    }
+
+    for (auto& client : clients) {
+        closeSocket(client->socket);
+    }
+}
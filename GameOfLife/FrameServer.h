@@ -0,0 +1,78 @@
+#pragma once
+
+#include "FrameCodec.h"
+#include "TileStepper.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Publishes generations of a running simulation to local subscribers over TCP on 127.0.0.1.
+//
+// A subscriber connects and sends one text line:
+//     SUBSCRIBE every=<n> region=<x>,<y>,<width>,<height>
+// (both fields optional; the default is every generation of the whole universe). It then
+// receives a keyframe followed by delta frames in the FrameCodec format. Generations increase
+// from frame to frame, except after the simulation seeks back, when a keyframe starts over at an
+// earlier generation.
+//
+// The engine only hands over the latest generation; frames are encoded and sent on the
+// server's own thread. A subscriber that cannot keep up simply misses generations: its next
+// frame is a delta against what it last received, so dropped frames never need resending
+// and a slow reader never holds up the simulation.
+class FrameServer {
+public:
+    static const int DEFAULT_PORT;
+
+    FrameServer() = default;
+    ~FrameServer();
+
+    FrameServer(const FrameServer&) = delete;
+    FrameServer& operator=(const FrameServer&) = delete;
+
+    // Starts listening on the given local port; returns false if the port cannot be bound
+    bool start(int port);
+    void stop();
+    bool isRunning() const { return running.load(); }
+    int getPort() const { return port; }
+
+    // Offers a generation to the subscribers. The alive plane is only copied when some
+    // subscriber wants this generation, so this is nearly free when nobody is listening.
+    // With 'restart' the generation breaks the sequence, as after a seek back: every subscriber
+    // gets it as a keyframe and then counts its next generation from there.
+    void publish(const GridPlanes& planes, std::int64_t generation, bool restart = false);
+
+    // True once a new subscriber is waiting for its keyframe. A paused engine publishes no
+    // generations, so it should poll this and publish the one on screen when it is set.
+    bool wantsRefresh() const { return refreshWanted.load(std::memory_order_relaxed); }
+
+    int getClientCount() const { return clientCount.load(); }
+
+private:
+    struct Snapshot {
+        std::int64_t generation = 0;
+        int width = 0;
+        int height = 0;
+        int wordsPerRow = 0;
+        bool restart = false;
+        std::vector<std::uint64_t> cells;
+    };
+    struct Client;
+
+    void serve();
+    static void flush(Client& client);
+
+    int port = 0;
+    std::atomic<bool> running{ false };
+    std::atomic<int> clientCount{ 0 };
+    std::atomic<std::int64_t> nextWantedGeneration{ INT64_MAX };
+    std::atomic<bool> refreshWanted{ false };   // The next publish() is taken whatever its generation
+    std::thread serverThread;
+    std::intptr_t listenSocket = -1;
+
+    std::mutex snapshotMutex;                   // Guards only the pointer swaps below
+    std::shared_ptr<Snapshot> latest;           // Newest generation offered by the engine
+    std::shared_ptr<Snapshot> spare;            // Buffer handed back for reuse by publish()
+};
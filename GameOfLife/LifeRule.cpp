@@ -0,0 +1,179 @@
+#include "LifeRule.h"
+#include <cctype>
+
+namespace {
+    // Reads a run of neighbour counts 0-8 into a mask; stops at the first other character
+    size_t readCounts(const std::string& text, size_t at, std::uint16_t& mask) {
+        while (at < text.size() && text[at] >= '0' && text[at] <= '8') {
+            mask |= static_cast<std::uint16_t>(1 << (text[at] - '0'));
+            at++;
+        }
+        return at;
+    }
+}
+
+bool LifeRule::parse(const std::string& text, LifeRule& rule) {
+    std::string compact;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            compact += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    size_t slash = compact.find('/');
+    if (slash == std::string::npos || compact.find('/', slash + 1) != std::string::npos) {
+        return false;
+    }
+    std::string first = compact.substr(0, slash);
+    std::string second = compact.substr(slash + 1);
+
+    LifeRule parsed;
+    parsed.birth = 0;
+    parsed.survival = 0;
+    bool lettered = (!first.empty() && (first[0] == 'B' || first[0] == 'S')) || (!second.empty() && (second[0] == 'B' || second[0] == 'S'));
+    if (lettered) {
+        // Each half names its own set, so the order does not matter
+        bool seenBirth = false, seenSurvival = false;
+        for (const std::string* part : { &first, &second }) {
+            if (part->empty() || (((*part)[0] != 'B') && ((*part)[0] != 'S'))) {
+                return false;
+            }
+            bool isBirth = (*part)[0] == 'B';
+            if (isBirth ? seenBirth : seenSurvival) {
+                return false;
+            }
+            (isBirth ? seenBirth : seenSurvival) = true;
+            if (readCounts(*part, 1, isBirth ? parsed.birth : parsed.survival) != part->size()) {
+                return false;
+            }
+        }
+    }
+    else {
+        // Survival/birth, as in "23/3"
+        if (readCounts(first, 0, parsed.survival) != first.size() || readCounts(second, 0, parsed.birth) != second.size()) {
+            return false;
+        }
+    }
+    rule = parsed;
+    return true;
+}
+
+std::string LifeRule::toString() const {
+    std::string text = "B";
+    for (int n = 0; n <= 8; n++) {
+        if ((birth >> n) & 1) {
+            text += static_cast<char>('0' + n);
+        }
+    }
+    text += "/S";
+    for (int n = 0; n <= 8; n++) {
+        if ((survival >> n) & 1) {
+            text += static_cast<char>('0' + n);
+        }
+    }
+    return text;
+}
+
+const int MultiStateRule::MAX_STATES = 16;
+
+bool MultiStateRule::parse(const std::string& text, MultiStateRule& rule) {
+    std::string compact;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            compact += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    if (compact == "WIREWORLD") {
+        MultiStateRule parsed;
+        parsed.family = Family::WireWorld;
+        parsed.states = 4;
+        rule = parsed;
+        return true;
+    }
+
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (size_t slash = compact.find('/'); ; slash = compact.find('/', start)) {
+        parts.push_back(compact.substr(start, slash == std::string::npos ? std::string::npos : slash - start));
+        if (slash == std::string::npos) {
+            break;
+        }
+        start = slash + 1;
+    }
+    if (parts.size() != 3) {
+        return false;
+    }
+
+    // Take out the state count, then hand the birth and survival halves to LifeRule
+    std::string count, lifeText;
+    bool lettered = false;
+    for (const std::string& part : parts) {
+        lettered = lettered || (!part.empty() && std::isalpha(static_cast<unsigned char>(part[0])));
+    }
+    if (lettered) {
+        for (const std::string& part : parts) {
+            if (!part.empty() && (part[0] == 'C' || part[0] == 'G')) {
+                if (!count.empty()) {
+                    return false;
+                }
+                count = part.substr(1);
+            }
+            else {
+                lifeText += (lifeText.empty() ? "" : "/") + part;
+            }
+        }
+    }
+    else {
+        // Survival/birth/count, as in "345/2/4"
+        count = parts[2];
+        lifeText = parts[0] + "/" + parts[1];
+    }
+    if (count.empty() || count.size() > 2 || count.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    MultiStateRule parsed;
+    parsed.states = std::stoi(count);
+    if (parsed.states < 2 || parsed.states > MAX_STATES || !LifeRule::parse(lifeText, parsed.lifeRule)) {
+        return false;
+    }
+    rule = parsed;
+    return true;
+}
+
+std::string MultiStateRule::toString() const {
+    if (family == Family::WireWorld) {
+        return "WireWorld";
+    }
+    return lifeRule.toString() + "/C" + std::to_string(states);
+}
+
+int MultiStateRule::planeCount() const {
+    int planes = 1;
+    while ((1 << planes) < states) {
+        planes++;
+    }
+    return planes;
+}
+
+std::vector<std::uint32_t> MultiStateRule::palette(std::uint32_t liveColor, std::uint32_t backgroundColor) const {
+    std::vector<std::uint32_t> colors(states, backgroundColor);
+    if (family == Family::WireWorld) {
+        colors[1] = 0x0080FF;
+        colors[2] = 0xFF4000;
+        colors[3] = 0xFFC000;
+        return colors;
+    }
+    colors[1] = liveColor;
+    for (int state = 2; state < states; state++) {
+        // Dying states start a little short of the live colour so the two can be told apart
+        double t = static_cast<double>(state - 1) / states;
+        std::uint32_t color = 0;
+        for (int shift = 0; shift <= 16; shift += 8) {
+            double from = (liveColor >> shift) & 0xFF;
+            double to = (backgroundColor >> shift) & 0xFF;
+            color |= static_cast<std::uint32_t>(from + (to - from) * t + 0.5) << shift;
+        }
+        colors[state] = color;
+    }
+    return colors;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// An outer-totalistic rule on the eight-cell neighbourhood. Bit n of 'birth' is set if a dead
+// cell with n live neighbours comes alive, bit n of 'survival' if a live one stays alive.
+// The default is Conway's B3/S23.
+struct LifeRule {
+    std::uint16_t birth = 1 << 3;
+    std::uint16_t survival = (1 << 2) | (1 << 3);
+
+    constexpr bool isConway() const { return birth == (1 << 3) && survival == ((1 << 2) | (1 << 3)); }
+    constexpr bool operator==(const LifeRule& other) const { return birth == other.birth && survival == other.survival; }
+
+    // Reads B/S notation ("B36/S23", either case, either order) or the older survival/birth
+    // form ("23/36"). Returns false and leaves the rule alone if the text is not a valid rule.
+    static bool parse(const std::string& text, LifeRule& rule);
+
+    // Always in B/S notation
+    std::string toString() const;
+};
+
+// A rule for cells with more than two states, in one of two families.
+//
+// Generations rules extend B/S with a state count C, written "B2/S/C3" or, in the older
+// survival/birth/count order, "/2/3". State 0 is dead and 1 alive; a live cell that does not
+// survive starts dying instead, passing through states 2 to C-1 before it is dead again, and
+// only live cells count as neighbours or can be born into. Brian's Brain is B2/S/C3, Star Wars
+// B2/S345/C4; C2 is the two-state rule itself.
+//
+// WireWorld has four states: empty (0), electron head (1), electron tail (2) and conductor (3).
+// A head becomes a tail, a tail a conductor, and a conductor a head if one or two of its
+// neighbours are heads.
+struct MultiStateRule {
+    enum class Family {
+        Generations,
+        WireWorld
+    };
+
+    static const int MAX_STATES;    // Four bit planes
+
+    Family family = Family::Generations;
+    LifeRule lifeRule = LifeRule{ 1 << 2, 0 };  // Birth and survival of a Generations rule
+    int states = 3;                             // Brian's Brain unless set
+
+    bool operator==(const MultiStateRule& other) const {
+        return family == other.family && states == other.states && (family == Family::WireWorld || lifeRule == other.lifeRule);
+    }
+
+    // Reads "B2/S/C3" (either case, any order), "/2/3" or "WireWorld". Returns false and leaves
+    // the rule alone if the text is not a valid rule.
+    static bool parse(const std::string& text, MultiStateRule& rule);
+
+    // Generations rules always in B/S/C notation
+    std::string toString() const;
+
+    int planeCount() const;         // Bit planes needed to hold every state
+    int drawState() const { return family == Family::WireWorld ? 3 : 1; }  // State of a drawn or imported cell
+    // Whether a state counts as a live cell for populations and when going back to two states:
+    // state 1 of a Generations rule, anything but empty in WireWorld
+    bool isLive(int state) const { return family == Family::WireWorld ? state != 0 : state == 1; }
+
+    // Packed 0xRRGGBB colour of each state: dying Generations states fade from the live colour
+    // towards the background, WireWorld uses the customary blue heads, red tails and yellow wire
+    std::vector<std::uint32_t> palette(std::uint32_t liveColor, std::uint32_t backgroundColor) const;
+};
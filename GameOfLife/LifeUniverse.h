@@ -0,0 +1,31 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+
+// What the dynamic Universe and every FixedUniverse have in common, so code written against it
+// runs on either
+template <typename U>
+concept LifeUniverse = requires(U universe, const U& view, int x, int y, bool alive, int generations) {
+    { view.getWidth() } -> std::convertible_to<int>;
+    { view.getHeight() } -> std::convertible_to<int>;
+    { view.getToroidal() } -> std::convertible_to<bool>;
+    { view.getCellState(x, y) } -> std::convertible_to<bool>;
+    { view.getPopulation() } -> std::convertible_to<long long>;
+    universe.setCellAlive(x, y, alive);
+    universe.play();
+    universe.advance(generations);
+};
+
+// Copies the live and dead cells of one universe into another over the area both cover, so a
+// board can move between a fixed and a dynamic universe
+template <LifeUniverse From, LifeUniverse To>
+void copyCells(const From& from, To& to) {
+    int width = std::min<int>(from.getWidth(), to.getWidth());
+    int height = std::min<int>(from.getHeight(), to.getHeight());
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            to.setCellAlive(x, y, from.getCellState(x, y));
+        }
+    }
+}
@@ -2,11 +2,26 @@
 
 
 #include "Universe.h"
+#include "MultiStateUniverse.h"
+#include "DistributedUniverse.h"
+#include "EditQueue.h"
+#include "TiledUniverse.h"
+#include "FrameExporter.h"
+#include "FrameServer.h"
+#include "RunRecording.h"
+#include "SoupCensus.h"
+#include "ObjectCensus.h"
+#include "PatternLibrary.h"
+#include "PatternSearch.h"
+#include "Profiler.h"
 #include <wx/wx.h>
 #include <random>
 #include <wx/colordlg.h>
 #include <wx/dcbuffer.h>
 #include <wx/file.h>
+#include <wx/numdlg.h>
+#include <wx/choicdlg.h>
+#include <wx/dirdlg.h>
 #include <iosfwd>
 #include <sstream>
 #include "../Binaries/include/wx/app.h"
@@ -30,7 +45,25 @@ public:
         ID_Menu_SaveSettings,
         ID_Menu_LoadSettings,
         ID_Menu_ResetDefaults,
-        ID_TOROIDAL
+        ID_TOROIDAL,
+        ID_Menu_RunDistributed,
+        ID_Menu_RunOutOfCore,
+        ID_Menu_FrameServer,
+        ID_Menu_ExportFrames,
+        ID_Menu_SoupCensus,
+        ID_Menu_RandomizeSeeded,
+        ID_Menu_LoadPatterns,
+        ID_Menu_PlacePatterns,
+        ID_Menu_AgeHeatmap,
+        ID_Menu_RecordTrace,
+        ID_Menu_UniverseSize,
+        ID_Menu_ObjectCensus,
+        ID_Menu_RecordRun,
+        ID_Menu_OpenRecording,
+        ID_Menu_SeekRecording,
+        ID_Menu_FindPattern,
+        ID_Menu_Monochrome,
+        ID_Menu_MultiStateRule
     };
 
 
@@ -38,19 +71,37 @@ public:
 
     static const int GRID_WIDTH;
     static const int GRID_HEIGHT;
+    static const int FAST_FORWARD_GENERATIONS;
+    static const char* const MULTI_STATE_AUTOSAVE_PATH;
     void OnStart(wxCommandEvent& event);
     void OnDrawCell(wxMouseEvent& event);
+    void OnPaintDrag(wxMouseEvent& event);
+    void OnPaintEnd(wxMouseEvent& event);
+    void OnPaintCaptureLost(wxMouseCaptureLostEvent& event);
     void OnPaint(wxPaintEvent& event);
     void OnInsertGlider(wxCommandEvent& event);
     void OnInsertSpaceship(wxCommandEvent& event);
     void OnInsertPulsar(wxCommandEvent& event);
     void OnRandomize(wxCommandEvent& event);
+    void OnRandomizeSeeded(wxCommandEvent& event);
+    void OnLoadPatterns(wxCommandEvent& event);
+    void OnPlacePatterns(wxCommandEvent& event);
+    void OnFindPattern(wxCommandEvent& event);
+    void OnToggleAgeHeatmap(wxCommandEvent& event);
+    void OnToggleMonochrome(wxCommandEvent& event);
+    void OnMultiStateRule(wxCommandEvent& event);
+    void OnUniverseSize(wxCommandEvent& event);
+#ifdef GOL_PROFILING
+    void OnRecordTrace(wxCommandEvent& event);
+    void OnProfileTimer(wxTimerEvent& event);
+#endif
     void OnClearAll(wxCommandEvent& event);
     void OnResize(wxSizeEvent& event);
     void OnChangeColor(wxCommandEvent& event);
     void UpdateStatusBar();
     void OnNext(wxCommandEvent& event);
     void OnPause(wxCommandEvent& event);
+    void OnFastForward(wxCommandEvent& event);
     void OnMenuSave(wxCommandEvent& event);
     void OnMenuLoad(wxCommandEvent& event);
     void OnChangeGridColor(wxCommandEvent& event);
@@ -59,8 +110,22 @@ public:
     void OnLoadSettings(wxCommandEvent& event);
     void OnResetDefaults(wxCommandEvent& event);
     void RefreshGrid();
-    void InitializeGrid();
+    wxSize GetCellSize() const;  // Pixels per cell in the viewport, at least 1 in each direction
     void OnToggleToroidal(wxCommandEvent& event);
+    void OnRunDistributed(wxCommandEvent& event);
+    void OnRunOutOfCore(wxCommandEvent& event);
+    void OnToggleFrameServer(wxCommandEvent& event);
+    void OnFrameServerTimer(wxTimerEvent& event);
+    void PublishFrame(bool sequenceBreak = false);
+    void OnRecordRun(wxCommandEvent& event);
+    void OnOpenRecording(wxCommandEvent& event);
+    void OnSeekRecording(wxCommandEvent& event);
+    void OnExportFrames(wxCommandEvent& event);
+    void OnExportTimer(wxTimerEvent& event);
+    void OnSoupCensus(wxCommandEvent& event);
+    void OnCensusTimer(wxTimerEvent& event);
+    void OnObjectCensus(wxCommandEvent& event);
+    void OnObjectCensusTimer(wxTimerEvent& event);
     void OnClose(wxCloseEvent& event);
     wxString GetToroidalMenuItemLabel() const;
     wxColour currentGridColor;
@@ -80,6 +145,7 @@ private:
     wxButton* clearButton;
     wxButton* nextButton;
     wxButton* pauseButton; 
+    wxButton* fastForwardButton;
     bool paused = false; 
     wxTimer* timer;
     wxMenu* settingsMenu;
@@ -90,11 +156,43 @@ private:
     bool simulationRunning = false;
     wxColour currentCellColor = *wxBLACK;  // Default color for alive cells
     wxColour backgroundColor = *wxWHITE;   // Default background color
-
-    void DrawPattern(const std::vector<std::vector<int>>& pattern);
+    long long generationCount = 0;         // Generations stepped since the program started
+    FrameServer frameServer;               // Streams generations to local viewers when started
+    FrameExporter exporter;                // Writes image sequences in the background
+    RunRecorder recorder;                  // Appends every generation to a recording while checked
+    RunPlayer player;                      // Recording opened for playback, if any
+    wxTimer* exportTimer;                  // Polls the exporter for progress
+    SoupCensus census;                     // Batch random-soup experiments
+    wxTimer* censusTimer;                  // Polls the census for progress
+    ObjectCensus objectCensus;             // Labels and names the objects on the board every few generations
+    wxTimer* objectCensusTimer;            // Collects finished object census reports
+    wxTimer* frameServerTimer;             // Publishes the board to new viewers while paused
+    PatternLibrary patterns;               // Built-in patterns plus any loaded from disk
+    bool showAgeHeatmap = false;           // Colour live cells by how long they have been alive
+    std::vector<PatternMatch> searchMatches;   // Outlined on the canvas while the generation is unchanged
+    long long searchGeneration = -1;       // Generation the matches were found in
+    long long colorsShownGeneration = -1;  // Generation whose visible colours were last replayed in monochrome mode
+    MultiStateUniverse multiState;         // Stepped and drawn instead of 'universe' while multiStateMode is set
+    bool multiStateMode = false;
+#ifdef GOL_PROFILING
+    wxTimer* profileTimer;                 // Refreshes the per-phase timings in the status bar
+#endif
+
+    EditQueue edits;                       // Drawing, stamps and clears waiting for the next generation
+    bool painting = false;                 // The left button went down on the canvas and is still held
+    bool paintAlive = true;                // Whether the current stroke brings cells to life or kills them
+    int lastPaintX = 0;                    // Cell the current stroke reached last
+    int lastPaintY = 0;
+
+    void InsertPattern(const std::string& name);
+    void QueueEdits(std::vector<UniverseEdit> batch, const wxRect& dirty = wxRect());
+    void ApplyEdits();
+    void SetMultiStateMode(bool enabled);  // Also disables the commands that only work on two states
 };
 const int GameOfLifeFrame::GRID_WIDTH = Universe::getGridWidth();
 const int GameOfLifeFrame::GRID_HEIGHT = Universe::getGridHeight();
+const int GameOfLifeFrame::FAST_FORWARD_GENERATIONS = 100;
+const char* const GameOfLifeFrame::MULTI_STATE_AUTOSAVE_PATH = "autosave.rle";
 
 GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
     : wxFrame(NULL, wxID_ANY, title, pos, size), universe(GRID_WIDTH, GRID_HEIGHT) {
@@ -106,9 +204,17 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
 
     canvas->SetBackgroundStyle(wxBG_STYLE_PAINT);
     canvas->Bind(wxEVT_LEFT_DOWN, &GameOfLifeFrame::OnDrawCell, this);
+    canvas->Bind(wxEVT_MOTION, &GameOfLifeFrame::OnPaintDrag, this);
+    canvas->Bind(wxEVT_LEFT_UP, &GameOfLifeFrame::OnPaintEnd, this);
+    canvas->Bind(wxEVT_MOUSE_CAPTURE_LOST, &GameOfLifeFrame::OnPaintCaptureLost, this);
     canvas->Bind(wxEVT_SIZE, &GameOfLifeFrame::OnResize, this);
 
-    CreateStatusBar(2); // Creates a status bar with 2 fields
+    // Alive and dead counts, then the object census
+#ifdef GOL_PROFILING
+    CreateStatusBar(4); // The fourth field shows per-phase timings
+#else
+    CreateStatusBar(3);
+#endif
     wxColour currentGridColor = wxColour(0, 0, 0);
 
    
@@ -122,6 +228,10 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
     wxMenu* fileMenu = new wxMenu;
     fileMenu->Append(ID_Menu_Save, "&Save", "Save the current game state");
     fileMenu->Append(ID_Menu_Load, "&Load", "Load a game state");
+    fileMenu->Append(ID_Menu_ExportFrames, "&Export Frames...", "Render generations to an image sequence or raw video stream");
+    fileMenu->AppendCheckItem(ID_Menu_RecordRun, "&Record Run...", "Record every generation to a seekable file until unchecked");
+    fileMenu->Append(ID_Menu_OpenRecording, "&Open Recording...", "Open a recorded run and show one of its generations");
+    fileMenu->Append(ID_Menu_SeekRecording, "&Go To Recorded Generation...", "Show another generation of the open recording");
     fileMenu->AppendSeparator();
     fileMenu->Append(ID_Menu_Exit, "E&xit", "Exit the application");
     menuBar->Append(fileMenu, "&File");
@@ -135,6 +245,22 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
     settingsMenu->Append(ID_Menu_ResetDefaults, _("Reset to Default"), _("Restore default application settings"));
     wxMenuItem* toggleToroidalMenuItem = new wxMenuItem(settingsMenu, ID_TOROIDAL, "Toggle Universe Type");
     settingsMenu->Append(toggleToroidalMenuItem);
+    settingsMenu->Append(ID_Menu_RunDistributed, _("Run Distributed..."), _("Advance the universe across several worker processes"));
+    settingsMenu->Append(ID_Menu_RunOutOfCore, _("Run Out-of-Core..."), _("Advance an RLE pattern too large for memory, paging tiles from disk"));
+    settingsMenu->Append(ID_Menu_UniverseSize, _("Universe Size..."), _("Set the number of cells, independently of the window size"));
+    settingsMenu->AppendCheckItem(ID_Menu_AgeHeatmap, _("Age Heatmap"), _("Colour live cells by how many generations they have been alive"));
+    settingsMenu->AppendCheckItem(ID_Menu_Monochrome, _("Monochrome"), _("Step only the alive cells, without colours or ages, for the fastest runs"));
+    settingsMenu->AppendCheckItem(ID_Menu_MultiStateRule, _("Multi-State Rule..."), _("Run a Generations or WireWorld rule until unchecked"));
+#ifdef GOL_PROFILING
+    settingsMenu->AppendCheckItem(ID_Menu_RecordTrace, _("Record Trace..."), _("Record timed phases to a Chrome trace file until unchecked"));
+#endif
+    settingsMenu->AppendCheckItem(ID_Menu_FrameServer, _("Stream Frames"), _("Publish generations to local viewers"));
+    settingsMenu->Append(ID_Menu_LoadPatterns, _("Load Pattern Library..."), _("Add the .rle and .cells files in a directory to the pattern library"));
+    settingsMenu->Append(ID_Menu_PlacePatterns, _("Place Patterns..."), _("Scatter copies of a library pattern without touching existing cells"));
+    settingsMenu->Append(ID_Menu_FindPattern, _("Find Pattern..."), _("Find and outline every copy of a library pattern in any orientation"));
+    settingsMenu->Append(ID_Menu_RandomizeSeeded, _("Randomize With Seed..."), _("Fill the grid reproducibly from a seed and density"));
+    settingsMenu->Append(ID_Menu_SoupCensus, _("Soup Census..."), _("Run many random soups in parallel and log what they become"));
+    settingsMenu->AppendCheckItem(ID_Menu_ObjectCensus, _("Object Census..."), _("Count and name the objects on the board every few generations"));
 
 
     menuBar->Append(settingsMenu, _("Settings"));
@@ -153,12 +279,32 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
 
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnMenuSave, this, ID_Menu_Save);
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnMenuLoad, this, ID_Menu_Load);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnExportFrames, this, ID_Menu_ExportFrames);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnRecordRun, this, ID_Menu_RecordRun);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnOpenRecording, this, ID_Menu_OpenRecording);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnSeekRecording, this, ID_Menu_SeekRecording);
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnChangeGridColor, this, ID_Menu_ChangeGridColor);
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnChangeBackgroundColor, this, ID_Menu_ChangeBackgroundColor);
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnSaveSettings, this, ID_Menu_SaveSettings);
     Bind(wxEVT_COMMAND_MENU_SELECTED, &GameOfLifeFrame::OnLoadSettings, this, ID_Menu_LoadSettings);
     Bind(wxEVT_COMMAND_MENU_SELECTED, &GameOfLifeFrame::OnResetDefaults, this, ID_Menu_ResetDefaults);
     Bind(wxEVT_MENU, &GameOfLifeFrame::OnToggleToroidal, this, ID_TOROIDAL); // Bind the event handler
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnRunDistributed, this, ID_Menu_RunDistributed);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnRunOutOfCore, this, ID_Menu_RunOutOfCore);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnToggleFrameServer, this, ID_Menu_FrameServer);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnSoupCensus, this, ID_Menu_SoupCensus);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnObjectCensus, this, ID_Menu_ObjectCensus);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnRandomizeSeeded, this, ID_Menu_RandomizeSeeded);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnLoadPatterns, this, ID_Menu_LoadPatterns);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnPlacePatterns, this, ID_Menu_PlacePatterns);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnFindPattern, this, ID_Menu_FindPattern);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnToggleAgeHeatmap, this, ID_Menu_AgeHeatmap);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnToggleMonochrome, this, ID_Menu_Monochrome);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnMultiStateRule, this, ID_Menu_MultiStateRule);
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnUniverseSize, this, ID_Menu_UniverseSize);
+#ifdef GOL_PROFILING
+    Bind(wxEVT_MENU, &GameOfLifeFrame::OnRecordTrace, this, ID_Menu_RecordTrace);
+#endif
     // Inside the GameOfLifeFrame constructor
     Bind(wxEVT_CLOSE_WINDOW, &GameOfLifeFrame::OnClose, this);
 
@@ -186,12 +332,15 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
     nextButton->Disable(); // Disable the button initially
     pauseButton = new wxButton(this, wxID_ANY, "Pause");
     pauseButton->Bind(wxEVT_BUTTON, &GameOfLifeFrame::OnPause, this);
+    fastForwardButton = new wxButton(this, wxID_ANY, "Fast Forward");
+    fastForwardButton->Bind(wxEVT_BUTTON, &GameOfLifeFrame::OnFastForward, this);
 
 
     wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
     buttonSizer->Add(startButton, 0, wxALL, 10);
     buttonSizer->Add(pauseButton, 0, wxALL, 10);
     buttonSizer->Add(nextButton, 0, wxALL, 10);
+    buttonSizer->Add(fastForwardButton, 0, wxALL, 10);
     buttonSizer->Add(randomizeButton, 0, wxALL, 10);
     buttonSizer->Add(clearButton, 0, wxALL, 10);
     buttonSizer->Add(insertGliderButton, 0, wxALL, 10);
@@ -209,9 +358,21 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
 
     timer = new wxTimer(this);
     Bind(wxEVT_TIMER, &GameOfLifeFrame::OnTimer, this, timer->GetId());
+    exportTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &GameOfLifeFrame::OnExportTimer, this, exportTimer->GetId());
+    censusTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &GameOfLifeFrame::OnCensusTimer, this, censusTimer->GetId());
+    objectCensusTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &GameOfLifeFrame::OnObjectCensusTimer, this, objectCensusTimer->GetId());
+    frameServerTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &GameOfLifeFrame::OnFrameServerTimer, this, frameServerTimer->GetId());
+#ifdef GOL_PROFILING
+    profileTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &GameOfLifeFrame::OnProfileTimer, this, profileTimer->GetId());
+    profileTimer->Start(1000);
+#endif
 
     GameOfLifeFrame::RefreshGrid();
-    GameOfLifeFrame::InitializeGrid();
 
     // Define the autosave file path.
     std::string autosavePath = "autosave.gol";
@@ -235,6 +396,14 @@ GameOfLifeFrame::GameOfLifeFrame(const wxString& title, const wxPoint& pos, cons
         canvas->Update();  // This forces an immediate redraw; use it if you're facing issues with delayed updates.
     }
 
+    // A multi-state board open at exit was saved beside the two-state one and takes its place
+    if (std::filesystem::exists(MULTI_STATE_AUTOSAVE_PATH) && multiState.load(MULTI_STATE_AUTOSAVE_PATH)) {
+        universe.resize(multiState.getWidth(), multiState.getHeight());
+        multiState.setToroidal(universe.getToroidal());
+        SetMultiStateMode(true);
+        canvas->Refresh();
+    }
+
 
     
 
@@ -275,31 +444,58 @@ GameOfLifeFrame::~GameOfLifeFrame() {
         timer->Stop();
     }
     delete timer;
+    exportTimer->Stop();
+    delete exportTimer;
+    censusTimer->Stop();
+    delete censusTimer;
+    objectCensusTimer->Stop();
+    delete objectCensusTimer;
+    frameServerTimer->Stop();
+    delete frameServerTimer;
+#ifdef GOL_PROFILING
+    profileTimer->Stop();
+    delete profileTimer;
+    Profiler::instance().stopTrace();
+#endif
 }
 
-void GameOfLifeFrame::DrawPattern(const std::vector<std::vector<int>>& pattern) {
-    int patternWidth = pattern[0].size();
-    int patternHeight = pattern.size();
+void GameOfLifeFrame::InsertPattern(const std::string& name) {
+    const Pattern* pattern = patterns.find(name);
+    if (!pattern) {
+        return;
+    }
 
-    // Generate a random starting position for the pattern.
+    // One copy at a random free spot, looked for when the edit is applied so it is free then
     std::random_device rd;
-    std::mt19937 mt(rd());
-    std::uniform_int_distribution<int> distX(0, this->GRID_WIDTH - patternWidth);
-    std::uniform_int_distribution<int> distY(0, this->GRID_HEIGHT - patternHeight);
-
-    int startX = distX(mt);
-    int startY = distY(mt);
-
-    // Update the universe with the pattern.
-    for (int i = 0; i < patternHeight; i++) {
-        for (int j = 0; j < patternWidth; j++) {
-            bool alive = pattern[i][j] == 1;
-            int actualX = startX + j; // startX is the starting x position for your pattern on the universe
-            int actualY = startY + i; // startY is the starting y position for your pattern on the universe
-            universe.setCellAlive(actualX, actualY, alive, currentCellColor);
-        }
+    UniverseEdit edit;
+    edit.kind = EditKind::Place;
+    edit.libraryPattern = pattern;
+    edit.placement.seed = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    edit.placement.orientation = 0;
+    edit.placement.color = Universe::packColor(currentCellColor);
+    QueueEdits({ edit });
+}
+
+void GameOfLifeFrame::QueueEdits(std::vector<UniverseEdit> batch, const wxRect& dirty) {
+    edits.push(std::move(batch));
+    if (simulationRunning && !paused) {
+        return;  // The timer applies them just before the next generation
+    }
+    ApplyEdits();
+    if (dirty.IsEmpty()) {
+        canvas->Refresh();
+    }
+    else {
+        canvas->RefreshRect(dirty);
+    }
+    UpdateStatusBar();
+}
+
+void GameOfLifeFrame::ApplyEdits() {
+    EditStats stats = multiStateMode ? edits.apply(multiState) : edits.apply(universe);
+    if (stats.unplaced) {
+        SetStatusText(wxString::Format("No free space for a %s", stats.unplaced->name), 1);
     }
-    canvas->Refresh();
 }
 
 void GameOfLifeFrame::OnStart(wxCommandEvent& event) {
@@ -333,26 +529,74 @@ void GameOfLifeFrame::OnStart(wxCommandEvent& event) {
 }
 
 void GameOfLifeFrame::OnDrawCell(wxMouseEvent& event) {
-    int cellWidth = canvas->GetSize().GetWidth() / GRID_WIDTH;
-    int cellHeight = canvas->GetSize().GetHeight() / GRID_HEIGHT;
+    int cellWidth = GetCellSize().GetWidth();
+    int cellHeight = GetCellSize().GetHeight();
 
     int x = event.GetX() / cellWidth;
     int y = event.GetY() / cellHeight;
+    if (!universe.isWithinBounds(x, y)) {
+        return;  // Clicked beyond the edge of the universe
+    }
+    if (multiStateMode) {
+        // A click steps the cell on through the rule's states, between generations like any edit
+        UniverseEdit cycle;
+        cycle.kind = EditKind::Cycle;
+        cycle.x = x;
+        cycle.y = y;
+        QueueEdits({ cycle }, wxRect(x * cellWidth, y * cellHeight, cellWidth, cellHeight));
+        return;
+    }
 
-    bool currentState = universe.getCellState(x, y);
-    universe.setCellAlive(x, y, !currentState, currentCellColor);  // Pass the current color when setting a cell alive
-
-    int topLeftX = x * cellWidth;
-    int topLeftY = y * cellHeight;
-    canvas->RefreshRect(wxRect(topLeftX, topLeftY, cellWidth, cellHeight));
-    UpdateStatusBar();
-  
+    // A stroke brings cells to life if it starts on a dead one and kills them otherwise, so a
+    // plain click still toggles the cell under the pointer
+    painting = true;
+    paintAlive = !universe.getCellState(x, y);
+    lastPaintX = x;
+    lastPaintY = y;
+    canvas->CaptureMouse();
+
+    std::vector<UniverseEdit> runs;
+    EditQueue::strokeRuns(x, y, x, y, paintAlive, Universe::packColor(currentCellColor), runs);
+    QueueEdits(std::move(runs), wxRect(x * cellWidth, y * cellHeight, cellWidth, cellHeight));
 }
 
+void GameOfLifeFrame::OnPaintDrag(wxMouseEvent& event) {
+    if (!painting || !event.LeftIsDown()) {
+        return;
+    }
+    int cellWidth = GetCellSize().GetWidth();
+    int cellHeight = GetCellSize().GetHeight();
 
+    // Outside the canvas the division may round towards the edge; the runs are clipped anyway
+    int x = event.GetX() / cellWidth;
+    int y = event.GetY() / cellHeight;
+    if (x == lastPaintX && y == lastPaintY) {
+        return;
+    }
+
+    // Motion events arrive far apart on a fast drag, so join the cells with a line
+    std::vector<UniverseEdit> runs;
+    EditQueue::strokeRuns(lastPaintX, lastPaintY, x, y, paintAlive, Universe::packColor(currentCellColor), runs);
+    wxRect dirty(std::min(x, lastPaintX) * cellWidth, std::min(y, lastPaintY) * cellHeight,
+        (std::abs(x - lastPaintX) + 1) * cellWidth, (std::abs(y - lastPaintY) + 1) * cellHeight);
+    lastPaintX = x;
+    lastPaintY = y;
+    QueueEdits(std::move(runs), dirty);
+}
 
+void GameOfLifeFrame::OnPaintEnd(wxMouseEvent& event) {
+    painting = false;
+    if (canvas->HasCapture()) {
+        canvas->ReleaseMouse();
+    }
+}
+
+void GameOfLifeFrame::OnPaintCaptureLost(wxMouseCaptureLostEvent& event) {
+    painting = false;
+}
 
 void GameOfLifeFrame::OnPaint(wxPaintEvent& event) {
+    PROFILE_SCOPE(ProfilePhase::Paint);
     wxBufferedPaintDC dc(canvas);
 
     // Ensure buffer bitmap has the correct size
@@ -364,31 +608,83 @@ void GameOfLifeFrame::OnPaint(wxPaintEvent& event) {
     wxMemoryDC memDC;
     memDC.SelectObject(bufferBitmap);
 
-    // Use dynamic grid dimensions
-    int cellWidth = canvas->GetSize().GetWidth() / universe.getGridWidth();
-    int cellHeight = canvas->GetSize().GetHeight() / universe.getGridHeight();
+    // Only the cells that fit in the canvas are drawn
+    int cellWidth = GetCellSize().GetWidth();
+    int cellHeight = GetCellSize().GetHeight();
+    int visibleColumns = std::min(universe.getWidth(), (canvas->GetSize().GetWidth() + cellWidth - 1) / cellWidth);
+    int visibleRows = std::min(universe.getHeight(), (canvas->GetSize().GetHeight() + cellHeight - 1) / cellHeight);
+
+    memDC.SetBackground(wxBrush(backgroundColor));
+    memDC.Clear();
+
+    // A running monochrome board is drawn in the cell colour alone; once it stops, the colours
+    // of the visible cells are replayed from the provenance if there is one
+    if (universe.getMonochrome() && universe.hasProvenance() && !timer->IsRunning() && colorsShownGeneration != generationCount) {
+        universe.reconstructColors(0, 0, visibleColumns, visibleRows);
+        colorsShownGeneration = generationCount;
+    }
+    bool showColors = !universe.getMonochrome() || colorsShownGeneration == generationCount;
 
-    // Draw cells on memDC
-    for (int i = 0; i < universe.getGridHeight(); i++) {
-        for (int j = 0; j < universe.getGridWidth(); j++) {
-            if (universe.getCellState(j, i)) {
-                memDC.SetBrush(wxBrush(universe.getCellColor(j, i)));
+    // Draw the live cells on memDC; the background is already cleared, so the population index
+    // hands over only the blocks of the visible region that have something in them
+    memDC.SetPen(currentGridColor);
+    std::vector<PopulationBlock> occupied;
+    if (multiStateMode) {
+        std::vector<std::uint32_t> palette = multiState.getRule().palette(Universe::packColor(currentCellColor), Universe::packColor(backgroundColor));
+        for (int i = 0; i < visibleRows; i++) {
+            for (int j = 0; j < visibleColumns; j++) {
+                int state = multiState.getState(j, i);
+                if (state != 0) {
+                    memDC.SetBrush(wxBrush(Universe::unpackColor(palette[state])));
+                    memDC.DrawRectangle(j * cellWidth, i * cellHeight, cellWidth, cellHeight);
+                }
             }
-            else {
-                memDC.SetBrush(backgroundColor);
+        }
+    }
+    else {
+        occupied = universe.occupiedBlocks(0, 0, visibleColumns, visibleRows);
+    }
+    for (const PopulationBlock& block : occupied) {
+        int lastRow = std::min(block.y + block.height, visibleRows);
+        int lastColumn = std::min(block.x + block.width, visibleColumns);
+        for (int i = block.y; i < lastRow; i++) {
+            for (int j = block.x; j < lastColumn; j++) {
+                if (!universe.getCellState(j, i)) {
+                    continue;
+                }
+                if (!showColors) {
+                    memDC.SetBrush(wxBrush(currentCellColor));
+                }
+                else if (showAgeHeatmap) {
+                    memDC.SetBrush(wxBrush(Universe::unpackColor(Universe::ageColor(universe.getCellAge(j, i)))));
+                }
+                else {
+                    memDC.SetBrush(wxBrush(universe.getCellColor(j, i)));
+                }
+                memDC.DrawRectangle(j * cellWidth, i * cellHeight, cellWidth, cellHeight);
             }
-            memDC.DrawRectangle(j * cellWidth, i * cellHeight, cellWidth, cellHeight);
         }
     }
 
     // Draw gridlines on memDC
     
     memDC.SetPen(currentGridColor);
-    for (int i = 0; i <= universe.getGridHeight(); i++) {
-        memDC.DrawLine(0, i * cellHeight, universe.getGridWidth() * cellWidth, i * cellHeight);
+    for (int i = 0; i <= visibleRows; i++) {
+        memDC.DrawLine(0, i * cellHeight, visibleColumns * cellWidth, i * cellHeight);
+    }
+    for (int j = 0; j <= visibleColumns; j++) {
+        memDC.DrawLine(j * cellWidth, 0, j * cellWidth, visibleRows * cellHeight);
     }
-    for (int j = 0; j <= universe.getGridWidth(); j++) {
-        memDC.DrawLine(j * cellWidth, 0, j * cellWidth, universe.getGridHeight() * cellHeight);
+
+    // Outline the matches of the last search until the board moves on
+    if (searchGeneration == generationCount) {
+        memDC.SetPen(wxPen(*wxRED, 2));
+        memDC.SetBrush(*wxTRANSPARENT_BRUSH);
+        for (const PatternMatch& match : searchMatches) {
+            if (match.x < visibleColumns && match.y < visibleRows) {
+                memDC.DrawRectangle(match.x * cellWidth, match.y * cellHeight, match.width * cellWidth, match.height * cellHeight);
+            }
+        }
     }
 
     // Copy from memDC to the actual device context
@@ -399,39 +695,26 @@ bool simulationRunning = false;
 
 void GameOfLifeFrame::OnTimer(wxTimerEvent& event) {
     if (simulationRunning) {
-        // Create a copy of the current grid to store the next generation temporarily
-        Universe nextGeneration = universe;
-
-        // Calculate the next generation of the grid
-        for (int i = 0; i < GRID_HEIGHT; i++) {
-            for (int j = 0; j < GRID_WIDTH; j++) {
-                int neighbors = universe.countNeighbors(j, i);
-
-                if (universe.getCellState(j, i)) {
-                    // Existing cell: Just update alive status without changing color
-                    if (neighbors < 2 || neighbors > 3) {
-                        nextGeneration.setCellAlive(j, i, false);
-                        UpdateStatusBar();
-                    }
-                    // For alive cells that survive, we don't need to change the color or set them alive again.
-                }
-                else {
-                    // Dead cell: If it becomes alive, set its color to the current picked color
-                    if (neighbors == 3) {
-                        nextGeneration.setCellAlive(j, i, true, universe.determineBirthColor(j, i));
-                    }
-                    // For dead cells that remain dead, no action is required.
-                }
-               
-
+        // Whatever was drawn since the last tick lands before this generation is computed
+        ApplyEdits();
+
+        // Advance the whole universe one generation with the tiled kernel
+        {
+            PROFILE_SCOPE(ProfilePhase::Step);
+            if (multiStateMode) {
+                multiState.play();
+            }
+            else {
+                universe.play();
             }
         }
-
-        // Update the universe with the calculated next generation
-        universe = nextGeneration;
+        generationCount++;
+        PROFILE_COUNT(ProfileCounter::Generations, 1);
+        PublishFrame();
 
         // Refresh the canvas to display the next generation
         canvas->Refresh();
+        UpdateStatusBar();
     }
 }
 
@@ -440,83 +723,78 @@ void GameOfLifeFrame::OnTimer(wxTimerEvent& event) {
 
 
 void GameOfLifeFrame::OnInsertGlider(wxCommandEvent& event) {
-    std::vector<std::vector<int>> gliderPattern = {
-        {0, 1, 0},
-        {0, 0, 1},
-        {1, 1, 1}
-    };
-    DrawPattern(gliderPattern);
-    UpdateStatusBar();
+    InsertPattern("Glider");
 }
 
 void GameOfLifeFrame::OnInsertSpaceship(wxCommandEvent& event) {
-    std::vector<std::vector<int>> spaceshipPattern = {
-        {0, 1, 1, 1, 1},
-        {1, 0, 0, 0, 1},
-        {0, 0, 0, 0, 1},
-        {1, 0, 0, 1, 0}
-    };
-    DrawPattern(spaceshipPattern);  // Using the generalized function
-    UpdateStatusBar();
+    InsertPattern("Lightweight spaceship");
 }
 
 void GameOfLifeFrame::OnInsertPulsar(wxCommandEvent& event) {
-    std::vector<std::vector<int>>  pulsarPattern = {
-         {0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0},
-    };
-    DrawPattern(pulsarPattern);  // Using the generalized function
-    UpdateStatusBar();
+    InsertPattern("Pulsar");
 }
 
 
 
 
 void GameOfLifeFrame::OnRandomize(wxCommandEvent& event) {
+    // Drain the queue first, or edits made before the soup would land on it afterwards
+    ApplyEdits();
     universe.initializeRandomUniverse();
+    if (multiStateMode) {
+        multiState.importAlive(universe.getPlanes(), multiState.getRule().drawState());
+    }
     canvas->Refresh();
     UpdateStatusBar();
+    SetStatusText(wxString::Format("Seed: %llu", static_cast<unsigned long long>(universe.getSeed())), 1);
 }
-void GameOfLifeFrame::OnClearAll(wxCommandEvent& event) {
-    universe.clearAll(backgroundColor);
+
+void GameOfLifeFrame::OnRandomizeSeeded(wxCommandEvent& event) {
+    // Defaults to the last seed so a soup can be regenerated exactly
+    wxString seedText = wxGetTextFromUser(_("Seed:"), _("Randomize With Seed"),
+        wxString::Format("%llu", static_cast<unsigned long long>(universe.getSeed())), this);
+    unsigned long long seed = 0;
+    if (seedText.IsEmpty() || !seedText.ToULongLong(&seed)) {
+        return;
+    }
+    long density = wxGetNumberFromUser(_("Percentage of cells alive:"), _("Density"), _("Randomize With Seed"), 50, 0, 100, this);
+    if (density < 0) {
+        return;  // User cancelled
+    }
+
+    ApplyEdits();
+    universe.initializeRandomUniverse(seed, density / 100.0);
+    if (multiStateMode) {
+        multiState.importAlive(universe.getPlanes(), multiState.getRule().drawState());
+    }
     canvas->Refresh();
     UpdateStatusBar();
+    SetStatusText(wxString::Format("Seed: %llu", seed), 1);
+}
+void GameOfLifeFrame::OnClearAll(wxCommandEvent& event) {
+    UniverseEdit clear;
+    clear.kind = EditKind::Clear;
+    clear.color = Universe::packColor(backgroundColor);
+    QueueEdits({ clear });
 }
 
 void GameOfLifeFrame::RefreshGrid() {
-    // Get the current size of the canvas
-    wxSize canvasSize = canvas->GetSize();
-
-    // Update the size of the grid based on the canvas size
-    int newWidth = canvasSize.GetWidth();
-    int newHeight = canvasSize.GetHeight();
-
-    // Resize the universe with the new size
-    universe.resize(newWidth, newHeight);
-
-    // Refresh the canvas to redraw the updated grid
+    // The universe keeps its own size; only the viewport follows the canvas
     canvas->Refresh();
 }
 
+wxSize GameOfLifeFrame::GetCellSize() const {
+    wxSize canvasSize = canvas->GetSize();
+    return wxSize(std::max(1, canvasSize.GetWidth() / std::max(1, universe.getWidth())),
+        std::max(1, canvasSize.GetHeight() / std::max(1, universe.getHeight())));
+}
+
 
 void GameOfLifeFrame::OnResize(wxSizeEvent& event) {
     // This ensures that the event is propagated (e.g., allowing min/max size logic, if any, to work).
     event.Skip();
 
-    // Update the universe's dimensions based on the canvas size
-    // TODO: Ensure the Universe class has methods to support dynamic resizing without reinitialization, if required.
-
+    // Only the viewport changes; dragging the window edge never touches the universe
     RefreshGrid();
 }
 
@@ -540,22 +818,21 @@ void GameOfLifeFrame::OnChangeColor(wxCommandEvent& event) {
 }
 
 void GameOfLifeFrame::UpdateStatusBar() {
-    int aliveCount = 0;
-    int deadCount = 0;
-
-    for (int i = 0; i < GRID_HEIGHT; i++) {
-        for (int j = 0; j < GRID_WIDTH; j++) {
-            if (universe.getCellState(j, i)) {
-                aliveCount++;
-            }
-            else {
-                deadCount++;
-            }
-        }
+    PROFILE_SCOPE(ProfilePhase::StatusBar);
+    if (multiStateMode) {
+        SetStatusText(wxString::Format("Live cells: %lld (%s)", multiState.getPopulation(), multiState.getRule().toString().c_str()), 0);
+        SetStatusText(wxString::Format("Empty cells: %lld", multiState.countState(0)), 1);
+        return;
     }
+    long long aliveCount = universe.getPopulation();
+    long long deadCount = static_cast<long long>(universe.getWidth()) * universe.getHeight() - aliveCount;
 
-    wxString aliveStr = wxString::Format("Alive cells: %d", aliveCount);
-    wxString deadStr = wxString::Format("Dead cells: %d", deadCount);
+    wxString aliveStr = wxString::Format("Alive cells: %lld", aliveCount);
+    int boundsX = 0, boundsY = 0, boundsWidth = 0, boundsHeight = 0;
+    if (universe.getBounds(boundsX, boundsY, boundsWidth, boundsHeight)) {
+        aliveStr += wxString::Format(" in %dx%d at (%d, %d)", boundsWidth, boundsHeight, boundsX, boundsY);
+    }
+    wxString deadStr = wxString::Format("Dead cells: %lld", deadCount);
 
     SetStatusText(aliveStr, 0);
     SetStatusText(deadStr, 1);
@@ -582,38 +859,71 @@ void GameOfLifeFrame::OnPause(wxCommandEvent& event) {
 
 
 void GameOfLifeFrame::OnNext(wxCommandEvent& event) {
-    // Create a copy of the current grid to store the next generation temporarily
-    Universe nextGeneration = universe;
-
-    // Calculate the next generation of the grid
-    for (int i = 0; i < GRID_HEIGHT; i++) {
-        for (int j = 0; j < GRID_WIDTH; j++) {
-            int neighbors = universe.countNeighbors(j, i);
-
-            if (universe.getCellState(j, i)) {
-                // Existing cell: Just update alive status without changing color
-                if (neighbors < 2 || neighbors > 3) {
-                    nextGeneration.setCellAlive(j, i, false);
-                }
-            }
-            else {
-                // Dead cell: If it becomes alive, set its color to the current picked color
-                if (neighbors == 3) {
-                    nextGeneration.setCellAlive(j, i, true, universe.determineBirthColor(j, i));
-                }
-            }
+    ApplyEdits();
+
+    // Advance the whole universe one generation with the tiled kernel
+    {
+        PROFILE_SCOPE(ProfilePhase::Step);
+        if (multiStateMode) {
+            multiState.play();
+        }
+        else {
+            universe.play();
         }
     }
-
-    // Update the universe with the calculated next generation
-    universe = nextGeneration;
+    generationCount++;
+    PROFILE_COUNT(ProfileCounter::Generations, 1);
+    PublishFrame();
 
     // Refresh the canvas to display the next generation
     canvas->Refresh();
     UpdateStatusBar();
 }
 
+void GameOfLifeFrame::OnFastForward(wxCommandEvent& event) {
+    // Skip ahead without drawing the intermediate generations; the universe advances
+    // them in temporally blocked tiles so large grids aren't streamed every generation.
+    ApplyEdits();
+    if (multiStateMode) {
+        PROFILE_SCOPE(ProfilePhase::Step);
+        multiState.advance(FAST_FORWARD_GENERATIONS);
+    }
+    else if (recorder.isRecording()) {
+        // A recording needs every generation, so step them one at a time
+        for (int i = 1; i <= FAST_FORWARD_GENERATIONS; i++) {
+            {
+                PROFILE_SCOPE(ProfilePhase::Step);
+                universe.play();
+            }
+            recorder.record(universe.getPlanes(), generationCount + i);
+        }
+    }
+    else {
+        PROFILE_SCOPE(ProfilePhase::Step);
+        universe.advance(FAST_FORWARD_GENERATIONS);
+    }
+    generationCount += FAST_FORWARD_GENERATIONS;
+    PROFILE_COUNT(ProfileCounter::Generations, FAST_FORWARD_GENERATIONS);
+    PublishFrame();
+
+    canvas->Refresh();
+    UpdateStatusBar();
+}
+
 void GameOfLifeFrame::OnMenuSave(wxCommandEvent& event) {
+    if (multiStateMode) {
+        // Multi-state boards are saved as RLE with their rule, which other Life programs read too
+        wxFileDialog rleFileDialog(this, "Save Game State", "", "",
+            "Multi-state RLE files (*.rle)|*.rle", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+        if (rleFileDialog.ShowModal() == wxID_CANCEL) {
+            return;  // User cancelled
+        }
+        if (!multiState.save(rleFileDialog.GetPath().ToStdString())) {
+            wxMessageBox(_("Failed to save the game state."), _("Error"), wxICON_ERROR);
+        }
+        return;
+    }
+
     wxFileDialog saveFileDialog(this, "Save Game State", "", "",
         "Game State files (*.gol)|*.gol", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
     if (saveFileDialog.ShowModal() == wxID_CANCEL) {
@@ -622,16 +932,32 @@ void GameOfLifeFrame::OnMenuSave(wxCommandEvent& event) {
 
     // Log the colors for debugging purposes
 
+    // A monochrome board replays its colours first, if it can, so the file holds real ones
+    universe.reconstructColors(0, 0, universe.getWidth(), universe.getHeight());
+
     // Save the current state of the universe to the selected file
     universe.save(saveFileDialog.GetPath().ToStdString(), currentGridColor, backgroundColor);
 }
 
 void GameOfLifeFrame::OnMenuLoad(wxCommandEvent& event) {
     wxFileDialog openFileDialog(this, "Load Game State", "", "",
-        "Game State files (*.gol)|*.gol", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+        "Game State files (*.gol)|*.gol|Multi-state RLE files (*.rle)|*.rle", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
     if (openFileDialog.ShowModal() == wxID_CANCEL) {
         return;  // User cancelled
     }
+    if (openFileDialog.GetFilterIndex() == 1) {
+        if (!multiState.load(openFileDialog.GetPath().ToStdString())) {
+            wxMessageBox(_("Failed to load the game state."), _("Error"), wxICON_ERROR);
+            return;
+        }
+        // The two-state universe keeps the same size so the viewport fits the loaded board
+        universe.resize(multiState.getWidth(), multiState.getHeight());
+        multiState.setToroidal(universe.getToroidal());
+        SetMultiStateMode(true);
+        canvas->Refresh();
+        UpdateStatusBar();
+        return;
+    }
 
     // Here you'd load the 'universe' object from the chosen file
     // For example:
@@ -642,6 +968,7 @@ void GameOfLifeFrame::OnMenuLoad(wxCommandEvent& event) {
         wxMessageBox(_("Failed to load the game state."), _("Error"), wxICON_ERROR);
         return;
     }
+    SetMultiStateMode(false);  // A two-state file replaces any multi-state board
 
     // Now, 'currentGridColor' and 'backgroundColor' should contain the new colors.
     // Update your GUI components with these colors. For example:
@@ -660,6 +987,325 @@ void GameOfLifeFrame::OnMenuLoad(wxCommandEvent& event) {
     canvas->Refresh();
 }
 
+void GameOfLifeFrame::OnExportFrames(wxCommandEvent& event) {
+    if (exporter.isRunning()) {
+        wxMessageBox(_("An export is already running."), _("Export Frames"), wxICON_INFORMATION);
+        return;
+    }
+
+    wxFileDialog exportFileDialog(this, "Export Frames", "", "frames",
+        "PNG sequence (*.png)|*.png|PPM sequence (*.ppm)|*.ppm|Raw RGB stream (*.rgb)|*.rgb", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (exportFileDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+
+    ExportOptions options;
+    options.format = static_cast<ExportFormat>(exportFileDialog.GetFilterIndex());
+    options.path = exportFileDialog.GetPath().ToStdString();
+    options.backgroundColor = Universe::packColor(backgroundColor);
+    options.gridColor = Universe::packColor(currentGridColor);
+    options.cellColor = Universe::packColor(currentCellColor);  // A monochrome board is exported as it is drawn while running
+    options.ageHeatmap = showAgeHeatmap;
+
+    long frames = wxGetNumberFromUser(_("Number of frames:"), _("Frames"), _("Export Frames"), 300, 1, 10000000, this);
+    long cellSize = frames < 1 ? -1 : wxGetNumberFromUser(_("Pixels per cell:"), _("Cell size"), _("Export Frames"), 4, 1, 64, this);
+    if (cellSize < 1) {
+        return;  // User cancelled
+    }
+    long imageWidth = wxGetNumberFromUser(_("Image width in pixels:"), _("Width"), _("Export Frames"),
+        std::min(3840L, universe.getWidth() * cellSize), 16, 16384, this);
+    long imageHeight = imageWidth < 1 ? -1 : wxGetNumberFromUser(_("Image height in pixels:"), _("Height"), _("Export Frames"),
+        std::min(2160L, universe.getHeight() * cellSize), 16, 16384, this);
+    if (imageHeight < 1) {
+        return;  // User cancelled
+    }
+    options.frames = static_cast<int>(frames);
+    options.cellSize = static_cast<int>(cellSize);
+    options.imageWidth = static_cast<int>(imageWidth);
+    options.imageHeight = static_cast<int>(imageHeight);
+
+    // The exporter steps its own copy, so the window stays responsive while it runs
+    if (!exporter.start(universe, options)) {
+        wxMessageBox(_("Failed to open the export file."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    exportTimer->Start(500);
+}
+
+void GameOfLifeFrame::OnExportTimer(wxTimerEvent& event) {
+    SetStatusText(wxString::Format("Exported %d frames (%.1f fps)", exporter.getFramesWritten(), exporter.getFramesPerSecond()), 1);
+    if (!exporter.isRunning()) {
+        exportTimer->Stop();
+        exporter.wait();
+        if (exporter.hasFailed()) {
+            wxMessageBox(_("Failed to write an exported frame."), _("Error"), wxICON_ERROR);
+        }
+    }
+}
+
+void GameOfLifeFrame::OnUniverseSize(wxCommandEvent& event) {
+    if (multiStateMode) {
+        wxMessageBox(_("Go back to two states to change the universe size."), _("Universe Size"), wxICON_INFORMATION);
+        return;
+    }
+    long newWidth = wxGetNumberFromUser(_("Width in cells:"), _("Width"), _("Universe Size"), universe.getWidth(), 1, 100000, this);
+    long newHeight = newWidth < 1 ? -1 : wxGetNumberFromUser(_("Height in cells:"), _("Height"), _("Universe Size"), universe.getHeight(), 1, 100000, this);
+    if (newHeight < 1) {
+        return;  // User cancelled
+    }
+    wxArrayString anchors;
+    anchors.Add(_("Keep the top-left corner in place"));
+    anchors.Add(_("Keep the centre in place"));
+    int anchor = wxGetSingleChoiceIndex(_("When the size changes:"), _("Universe Size"), anchors, this);
+    if (anchor < 0) {
+        return;
+    }
+
+    universe.resize(static_cast<int>(newWidth), static_cast<int>(newHeight), anchor == 1 ? ResizeAnchor::Center : ResizeAnchor::TopLeft);
+    canvas->Refresh();
+    UpdateStatusBar();
+}
+
+void GameOfLifeFrame::OnToggleAgeHeatmap(wxCommandEvent& event) {
+    showAgeHeatmap = event.IsChecked();
+    canvas->Refresh();
+}
+
+void GameOfLifeFrame::OnToggleMonochrome(wxCommandEvent& event) {
+    if (!event.IsChecked()) {
+        // Replays the colours of every generation run in monochrome, if provenance was kept
+        universe.setMonochrome(false);
+        colorsShownGeneration = -1;
+        canvas->Refresh();
+        return;
+    }
+    int answer = wxMessageBox(_("Keep a copy of the current colours so they can be restored exactly later?\n"
+        "This takes extra memory but nothing per generation; drawing while monochrome discards it."),
+        _("Monochrome"), wxYES_NO | wxICON_INFORMATION, this);
+    universe.setMonochrome(true, answer == wxYES);
+    colorsShownGeneration = generationCount;  // Colours are exact until the next generation
+    canvas->Refresh();
+}
+
+void GameOfLifeFrame::OnMultiStateRule(wxCommandEvent& event) {
+    ApplyEdits();
+    if (!event.IsChecked()) {
+        // Back to two states: the cells the rule counts as live stay alive, in the cell colour
+        universe.stamp(multiState.liveCells(), 0, 0, Universe::packColor(currentCellColor), true);
+        SetMultiStateMode(false);
+        canvas->Refresh();
+        UpdateStatusBar();
+        return;
+    }
+
+    wxString ruleText = wxGetTextFromUser(_("Generations rule, such as B2/S/C3 or 345/2/4, or WireWorld:"),
+        _("Multi-State Rule"), wxString::Format("%s", multiState.getRule().toString().c_str()), this);
+    if (ruleText.IsEmpty()) {
+        GetMenuBar()->Check(ID_Menu_MultiStateRule, false);
+        return;  // User cancelled
+    }
+    MultiStateRule rule;
+    if (!MultiStateRule::parse(ruleText.ToStdString(), rule)) {
+        wxMessageBox(_("Not a Generations rule or WireWorld."), _("Error"), wxICON_ERROR);
+        GetMenuBar()->Check(ID_Menu_MultiStateRule, false);
+        return;
+    }
+
+    // Live cells start out in the rule's drawing state: alive, or conductor for WireWorld
+    multiState.setRule(rule);
+    multiState.importAlive(universe.getPlanes(), rule.drawState());
+    SetMultiStateMode(true);
+    canvas->Refresh();
+    UpdateStatusBar();
+}
+
+void GameOfLifeFrame::SetMultiStateMode(bool enabled) {
+    multiStateMode = enabled;
+    GetMenuBar()->Check(ID_Menu_MultiStateRule, enabled);
+
+    // These read, edit or step the two-state universe, which is hidden while multi-state runs;
+    // whatever they did would be overwritten by the multi-state board on the way back
+    for (int id : { ID_Menu_ExportFrames, ID_Menu_OpenRecording, ID_Menu_SeekRecording, ID_Menu_RunDistributed,
+        ID_Menu_RunOutOfCore, ID_Menu_PlacePatterns, ID_Menu_FindPattern, ID_Menu_ObjectCensus }) {
+        GetMenuBar()->Enable(id, !enabled);
+    }
+    insertGliderButton->Enable(!enabled);
+    insertSpaceshipButton->Enable(!enabled);
+    insertPulsarButton->Enable(!enabled);
+    searchMatches.clear();
+}
+
+#ifdef GOL_PROFILING
+void GameOfLifeFrame::OnRecordTrace(wxCommandEvent& event) {
+    if (!event.IsChecked()) {
+        if (!Profiler::instance().stopTrace()) {
+            wxMessageBox(_("Failed to write the trace file."), _("Error"), wxICON_ERROR);
+        }
+        return;
+    }
+
+    wxFileDialog traceFileDialog(this, "Record Trace", "", "trace.json", "Chrome trace files (*.json)|*.json", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (traceFileDialog.ShowModal() == wxID_CANCEL || !Profiler::instance().startTrace(traceFileDialog.GetPath().ToStdString())) {
+        GetMenuBar()->Check(ID_Menu_RecordTrace, false);
+    }
+}
+
+void GameOfLifeFrame::OnProfileTimer(wxTimerEvent& event) {
+    // Milliseconds spent per second in each phase, so the numbers read as a share of the frame budget
+    ProfileSample sample = Profiler::instance().sample();
+    wxString text;
+    for (ProfilePhase phase : { ProfilePhase::Step, ProfilePhase::BirthColor, ProfilePhase::Paint, ProfilePhase::StatusBar }) {
+        const PhaseStats& stats = sample.phases[static_cast<int>(phase)];
+        text += wxString::Format("%s %.1f ms  ", Profiler::phaseName(phase), sample.seconds > 0 ? stats.milliseconds / sample.seconds : 0.0);
+    }
+    text += wxString::Format("%.1f gen/s", sample.generationsPerSecond);
+    SetStatusText(text, 3);
+}
+#endif
+
+void GameOfLifeFrame::OnLoadPatterns(wxCommandEvent& event) {
+    wxDirDialog dirDialog(this, "Choose a directory of .rle and .cells patterns", "", wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+    if (dirDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+    int loaded = patterns.loadDirectory(dirDialog.GetPath().ToStdString());
+    SetStatusText(wxString::Format("Loaded %d patterns (%d in library)", loaded, static_cast<int>(patterns.size())), 1);
+}
+
+void GameOfLifeFrame::OnPlacePatterns(wxCommandEvent& event) {
+    std::vector<const Pattern*> choices = patterns.fittingWithin(universe.getWidth(), universe.getHeight());
+    wxArrayString labels;
+    for (const Pattern* pattern : choices) {
+        wxString period = pattern->period > 0 ? wxString::Format("p%d", pattern->period) : wxString("p?");
+        labels.Add(wxString::Format("%s (%dx%d, %s)", pattern->name, pattern->width, pattern->height, period));
+    }
+    int choice = wxGetSingleChoiceIndex(_("Pattern:"), _("Place Patterns"), labels, this);
+    if (choice < 0) {
+        return;  // User cancelled
+    }
+    long count = wxGetNumberFromUser(_("Number of copies:"), _("Copies"), _("Place Patterns"), 10, 1, 1000000, this);
+    if (count < 1) {
+        return;
+    }
+
+    std::random_device rd;
+    PlacementOptions options;
+    options.count = count;
+    options.seed = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    options.color = Universe::packColor(currentCellColor);
+    // Anything still queued goes in first, so the copies only take spots that are free after it
+    ApplyEdits();
+    int placed = PatternLibrary::place(universe, *choices[choice], options);
+    canvas->Refresh();
+    UpdateStatusBar();
+    SetStatusText(wxString::Format("Placed %d of %ld", placed, count), 1);
+}
+
+void GameOfLifeFrame::OnFindPattern(wxCommandEvent& event) {
+    std::vector<const Pattern*> choices = patterns.fittingWithin(universe.getWidth(), universe.getHeight());
+    wxArrayString labels;
+    for (const Pattern* pattern : choices) {
+        labels.Add(wxString::Format("%s (%dx%d)", pattern->name, pattern->width, pattern->height));
+    }
+    int choice = wxGetSingleChoiceIndex(_("Pattern:"), _("Find Pattern"), labels, this);
+    if (choice < 0) {
+        return;  // User cancelled
+    }
+
+    // Search what is on screen, including anything drawn since the last generation
+    ApplyEdits();
+    SearchResult result = PatternSearch::find(universe.getPlanes(), choices[choice]->orientations[0]);
+    searchMatches = std::move(result.matches);
+    searchGeneration = generationCount;
+    canvas->Refresh();
+    UpdateStatusBar();
+    if (searchMatches.empty()) {
+        SetStatusText(wxString::Format("No %s found (%.0f ms)", choices[choice]->name, result.milliseconds), 1);
+        return;
+    }
+    SetStatusText(wxString::Format("%zu x %s, first at (%d, %d) (%.0f ms)", searchMatches.size(), choices[choice]->name,
+        searchMatches.front().x, searchMatches.front().y, result.milliseconds), 1);
+}
+
+void GameOfLifeFrame::OnSoupCensus(wxCommandEvent& event) {
+    if (census.isRunning()) {
+        // Choosing the command again stops the run; it can be resumed from the same file later
+        census.cancel();
+        censusTimer->Stop();
+        SetStatusText(wxString::Format("Census stopped after %lld soups", static_cast<long long>(census.getSoupsCompleted())), 1);
+        return;
+    }
+
+    wxFileDialog logFileDialog(this, "Soup Census Log", "", "census.csv", "CSV files (*.csv)|*.csv", wxFD_SAVE);
+    if (logFileDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+    long soups = wxGetNumberFromUser(_("Number of soups:"), _("Soups"), _("Soup Census"), 1000000, 1, 2000000000, this);
+    if (soups < 1) {
+        return;  // User cancelled
+    }
+    wxString seedText = wxGetTextFromUser(_("Seed (an existing log continues only with its own seed):"), _("Soup Census"), "1", this);
+    unsigned long long seed = 0;
+    if (seedText.IsEmpty() || !seedText.ToULongLong(&seed)) {
+        return;
+    }
+
+    CensusOptions options;
+    options.path = logFileDialog.GetPath().ToStdString();
+    options.soups = soups;
+    options.seed = seed;
+    if (!census.start(options)) {
+        wxMessageBox(_("Failed to open the census log, or it belongs to a different seed or an older format."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    censusTimer->Start(500);
+}
+
+void GameOfLifeFrame::OnCensusTimer(wxTimerEvent& event) {
+    SetStatusText(wxString::Format("Census: %lld/%lld soups (%.0f soups/sec)", static_cast<long long>(census.getSoupsCompleted()),
+        static_cast<long long>(census.getSoupsTotal()), census.getSoupsPerSecond()), 1);
+    if (!census.isRunning()) {
+        censusTimer->Stop();
+        census.wait();
+    }
+}
+
+void GameOfLifeFrame::OnObjectCensus(wxCommandEvent& event) {
+    if (!event.IsChecked()) {
+        objectCensus.setInterval(0);
+        objectCensus.closeLog();
+        objectCensusTimer->Stop();
+        SetStatusText("", 2);
+        return;
+    }
+
+    long interval = wxGetNumberFromUser(_("Take a census every N generations:"), _("N"), _("Object Census"), 10, 1, 1000000, this);
+    if (interval < 1) {
+        GetMenuBar()->Check(ID_Menu_ObjectCensus, false);
+        return;  // User cancelled
+    }
+    // The log is optional; cancelling the file dialog just shows the census in the status bar
+    wxFileDialog logFileDialog(this, "Object Census Log (optional)", "", "objects.csv", "CSV files (*.csv)|*.csv", wxFD_SAVE);
+    if (logFileDialog.ShowModal() == wxID_OK && !objectCensus.openLog(logFileDialog.GetPath().ToStdString())) {
+        wxMessageBox(_("Failed to open the object census log."), _("Error"), wxICON_ERROR);
+    }
+
+    objectCensus.setInterval(interval);
+    objectCensus.submit(universe.getPlanes(), generationCount);  // Census what is on screen right away
+    objectCensusTimer->Start(250);
+}
+
+void GameOfLifeFrame::OnObjectCensusTimer(wxTimerEvent& event) {
+    ObjectReport report;
+    if (!objectCensus.takeReport(report)) {
+        return;
+    }
+    SetStatusText(wxString::Format("Gen %lld: %d objects (%d still, %d osc, %d ships, %d other)", report.generation,
+        static_cast<int>(report.objects.size()), report.kinds[static_cast<int>(ObjectKind::StillLife)],
+        report.kinds[static_cast<int>(ObjectKind::Oscillator)], report.kinds[static_cast<int>(ObjectKind::Spaceship)],
+        report.kinds[static_cast<int>(ObjectKind::Unknown)]), 2);
+}
+
 void GameOfLifeFrame::OnChangeGridColor(wxCommandEvent& event) {
     wxColourData data;
     data.SetChooseFull(true);
@@ -732,23 +1378,11 @@ void GameOfLifeFrame::OnResetDefaults(wxCommandEvent& event) {
 }
 
 
-void GameOfLifeFrame::InitializeGrid() {
-  
-    // Get the current size of the canvas
-    wxSize canvasSize = canvas->GetSize();
-
-    // Calculate the initial size of the grid based on the canvas size
-    int initialWidth = canvasSize.GetWidth();
-    int initialHeight = canvasSize.GetHeight();
-
-    // Initialize the grid with the initial size
-    universe = Universe(initialWidth, initialHeight);
-}
-
 void GameOfLifeFrame::OnToggleToroidal(wxCommandEvent& event) {
     // Toggle the toroidal state based on the current state
     bool isCurrentlyToroidal = universe.getToroidal();
     universe.setToroidal(!isCurrentlyToroidal);
+    multiState.setToroidal(!isCurrentlyToroidal);
 
     // Update the menu item label to reflect the new state
     /*wxMenuItem* toggleToroidalMenuItem = settingsMenu->FindItem(ID_TOROIDAL);
@@ -759,6 +1393,215 @@ void GameOfLifeFrame::OnToggleToroidal(wxCommandEvent& event) {
     canvas->Refresh();
 }
 
+void GameOfLifeFrame::OnRunDistributed(wxCommandEvent& event) {
+    long workers = wxGetNumberFromUser(_("Number of worker processes:"), _("Workers"), _("Run Distributed"), 4, 1, 256, this);
+    if (workers < 1) {
+        return;  // User cancelled
+    }
+    long generations = wxGetNumberFromUser(_("Generations to run:"), _("Generations"), _("Run Distributed"), 1000, 1, 100000000, this);
+    if (generations < 1) {
+        return;  // User cancelled
+    }
+
+    // Split the universe into subdomains, let the workers advance it and gather the result back
+    ApplyEdits();
+
+    // The workers step colours too, so a monochrome board has its colours replayed first
+    bool monochrome = universe.getMonochrome(), provenance = universe.hasProvenance();
+    universe.setMonochrome(false);
+    DistributedUniverse distributed;
+    if (!distributed.start(universe, static_cast<int>(workers))) {
+        universe.setMonochrome(monochrome, provenance);
+        wxMessageBox(_("Failed to start the distributed workers."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    bool completed = false;
+    {
+        PROFILE_SCOPE(ProfilePhase::Step);
+        completed = distributed.run(static_cast<int>(generations));
+    }
+    if (!completed) {
+        universe.setMonochrome(monochrome, provenance);
+        wxMessageBox(_("A distributed worker stopped unexpectedly; the universe was left as it was."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    distributed.snapshot(universe);
+    universe.setMonochrome(monochrome, provenance);
+    generationCount += generations;
+    PROFILE_COUNT(ProfileCounter::Generations, generations);
+    PublishFrame();
+
+    canvas->Refresh();
+    UpdateStatusBar();
+    SetStatusText(wxString::Format("%s", distributed.describePlacement().c_str()), 1);
+}
+
+void GameOfLifeFrame::OnRunOutOfCore(wxCommandEvent& event) {
+    wxFileDialog openFileDialog(this, "Open Large Pattern", "", "",
+        "RLE files (*.rle)|*.rle", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (openFileDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+    long memory = wxGetNumberFromUser(_("Memory for tiles held in RAM (MB):"), _("MB"), _("Run Out-of-Core"), 1024, 4, 1048576, this);
+    if (memory < 1) {
+        return;  // User cancelled
+    }
+    long generations = wxGetNumberFromUser(_("Generations to run:"), _("Generations"), _("Run Out-of-Core"), 1000, 1, 100000000, this);
+    if (generations < 1) {
+        return;  // User cancelled
+    }
+    wxFileDialog saveFileDialog(this, "Save Result", "", "result.rle",
+        "RLE files (*.rle)|*.rle", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (saveFileDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+
+    // Tiles are paged to a scratch file next to the result, which is deleted afterwards
+    std::string resultPath = saveFileDialog.GetPath().ToStdString();
+    TiledUniverse tiled;
+    if (!tiled.open(resultPath + ".tiles", static_cast<size_t>(memory) << 20)) {
+        wxMessageBox(_("Failed to create the tile store."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    if (!tiled.loadRle(openFileDialog.GetPath().ToStdString())) {
+        wxMessageBox(_("Failed to read the pattern."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    {
+        PROFILE_SCOPE(ProfilePhase::Step);
+        tiled.advance(static_cast<int>(generations));
+    }
+    PROFILE_COUNT(ProfileCounter::Generations, generations);
+    if (!tiled.saveRle(resultPath) || tiled.getStats().ioErrors > 0) {
+        wxMessageBox(_("Failed to write the result; the disk may be full."), _("Error"), wxICON_ERROR);
+    }
+
+    // Show the top-left corner of the result on the board
+    std::int64_t x = 0, y = 0, width = 0, height = 0;
+    if (tiled.getBounds(x, y, width, height)) {
+        tiled.copyTo(universe, x, y, Universe::packColor(currentCellColor));
+    }
+    canvas->Refresh();
+    UpdateStatusBar();
+    TiledUniverse::Stats stats = tiled.getStats();
+    SetStatusText(wxString::Format("Out-of-core: %lld cells in %zu tiles, %lld tiles paged in", static_cast<long long>(tiled.getPopulation()),
+        stats.tiles, static_cast<long long>(stats.pageIns)), 1);
+}
+
+void GameOfLifeFrame::OnToggleFrameServer(wxCommandEvent& event) {
+    if (frameServer.isRunning()) {
+        frameServerTimer->Stop();
+        frameServer.stop();
+        return;
+    }
+    if (!frameServer.start(FrameServer::DEFAULT_PORT)) {
+        wxMessageBox(wxString::Format("Failed to listen on port %d.", FrameServer::DEFAULT_PORT), "Error", wxICON_ERROR);
+        return;
+    }
+    frameServerTimer->Start(100);
+    SetStatusText(wxString::Format("Streaming on 127.0.0.1:%d", FrameServer::DEFAULT_PORT), 1);
+}
+
+void GameOfLifeFrame::OnFrameServerTimer(wxTimerEvent& event) {
+    // A running simulation publishes every generation anyway; a paused one still owes a new
+    // viewer the board it shows
+    if (frameServer.wantsRefresh() && !multiStateMode) {
+        frameServer.publish(universe.getPlanes(), generationCount);
+    }
+}
+
+void GameOfLifeFrame::PublishFrame(bool sequenceBreak) {
+    if (multiStateMode) {
+        return;  // Viewers, the object census and recordings all read the two-state planes
+    }
+    // Cheap when nobody is subscribed; the server copies the generation only if a viewer wants it
+    frameServer.publish(universe.getPlanes(), generationCount, sequenceBreak);
+    // Likewise returns at once unless a census is due and the last one has finished
+    objectCensus.submit(universe.getPlanes(), generationCount);
+    // Encodes the changed tiles here and leaves the writing to the recorder's own thread
+    recorder.record(universe.getPlanes(), generationCount);
+}
+
+void GameOfLifeFrame::OnRecordRun(wxCommandEvent& event) {
+    if (!event.IsChecked()) {
+        long long frames = recorder.getFramesRecorded();
+        if (!recorder.stop()) {
+            wxMessageBox(_("Failed to write the recording; the disk may be full."), _("Error"), wxICON_ERROR);
+            return;
+        }
+        SetStatusText(wxString::Format("Recorded %lld generations", frames), 1);
+        return;
+    }
+
+    wxFileDialog recordFileDialog(this, "Record Run", "", "run.golrec", "Recordings (*.golrec)|*.golrec", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (recordFileDialog.ShowModal() == wxID_CANCEL) {
+        GetMenuBar()->Check(ID_Menu_RecordRun, false);
+        return;  // User cancelled
+    }
+    ApplyEdits();
+    if (!recorder.start(recordFileDialog.GetPath().ToStdString(), universe, generationCount)) {
+        GetMenuBar()->Check(ID_Menu_RecordRun, false);
+        wxMessageBox(_("Failed to create the recording."), _("Error"), wxICON_ERROR);
+    }
+}
+
+void GameOfLifeFrame::OnOpenRecording(wxCommandEvent& event) {
+    wxFileDialog openFileDialog(this, "Open Recording", "", "", "Recordings (*.golrec)|*.golrec", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (openFileDialog.ShowModal() == wxID_CANCEL) {
+        return;  // User cancelled
+    }
+    if (!player.open(openFileDialog.GetPath().ToStdString())) {
+        wxMessageBox(_("The file is not a recording."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    LifeRule rule;
+    if (LifeRule::parse(player.getRule(), rule)) {
+        universe.setRule(rule);
+    }
+    OnSeekRecording(event);
+}
+
+void GameOfLifeFrame::OnSeekRecording(wxCommandEvent& event) {
+    if (!player.isOpen()) {
+        wxMessageBox(_("Open a recording first."), _("Go To Recorded Generation"), wxICON_INFORMATION);
+        return;
+    }
+    long generation = wxGetNumberFromUser(wxString::Format("Generation (%lld to %lld):", static_cast<long long>(player.getFirstGeneration()),
+        static_cast<long long>(player.getLastGeneration())), _("Generation"), _("Go To Recorded Generation"),
+        static_cast<long>(player.getFirstGeneration()), static_cast<long>(player.getFirstGeneration()), static_cast<long>(player.getLastGeneration()), this);
+    if (generation < 0) {
+        return;  // User cancelled
+    }
+
+    // Playback replaces the board, so anything drawn meanwhile is dropped with it
+    ApplyEdits();
+    std::int64_t reached = player.seek(generation, universe, Universe::packColor(currentCellColor));
+    if (reached < 0) {
+        wxMessageBox(_("The recording is damaged."), _("Error"), wxICON_ERROR);
+        return;
+    }
+    generationCount = reached;
+
+    // A seek breaks the generation sequence: viewers start over from a keyframe of the board,
+    // and a recording that would go back carries on in a new file
+    wxString status = wxString::Format("Recording at generation %lld", static_cast<long long>(reached));
+    if (recorder.isRecording() && reached <= recorder.getLastGeneration()) {
+        if (!recorder.restart(universe, generationCount)) {
+            wxMessageBox(_("Failed to write the recording; the disk may be full."), _("Error"), wxICON_ERROR);
+        }
+        if (recorder.isRecording()) {
+            status += wxString::Format(", now recording to %s", recorder.getPath().c_str());
+        }
+        else {
+            GetMenuBar()->Check(ID_Menu_RecordRun, false);
+        }
+    }
+    PublishFrame(true);
+    canvas->Refresh();
+    UpdateStatusBar();
+    SetStatusText(status, 1);
+}
+
 wxString GameOfLifeFrame::GetToroidalMenuItemLabel() const {
     return universe.getToroidal() ? "Change to Non-Toroidal" : "Change to Toroidal";
 }
@@ -768,6 +1611,25 @@ void GameOfLifeFrame::OnClose(wxCloseEvent& event)
     // Define a path for the autosave file
     std::string autosavePath = "autosave.gol";
 
+    // Anything drawn since the last generation is kept
+    ApplyEdits();
+
+    // A multi-state board is saved beside the two-state one, which still holds the colours, and
+    // reopened at the next start; without one, an old multi-state autosave must not come back
+    if (multiStateMode) {
+        if (!multiState.save(MULTI_STATE_AUTOSAVE_PATH)) {
+            wxMessageBox(_("Failed to save the multi-state board."), _("Error"), wxICON_ERROR);
+        }
+    }
+    else {
+        std::error_code ignored;
+        std::filesystem::remove(MULTI_STATE_AUTOSAVE_PATH, ignored);
+    }
+
+    // Leaving monochrome replays the colours if provenance was kept and otherwise makes the ages
+    // match the alive plane, so the file is not left with those of the generation it was entered at
+    universe.setMonochrome(false);
+
     // Save the current state of the universe to the autosave file
     universe.save(autosavePath, currentGridColor, backgroundColor);
     // Proceed with the close event
@@ -779,6 +1641,9 @@ void GameOfLifeFrame::OnClose(wxCloseEvent& event)
 class GameOfLifeApp : public wxApp {
 public:
     virtual bool OnInit() {
+        // PNG export goes through wxImage
+        wxInitAllImageHandlers();
+
         // Create the frame with the specified title and size (e.g., 1600x900)
         GameOfLifeFrame* frame = new GameOfLifeFrame("Conway's Game of Life", wxDefaultPosition, wxSize(1600, 900));
 
@@ -790,5 +1655,17 @@ public:
 
 };
 
+#ifdef _WIN32
 wxIMPLEMENT_APP(GameOfLifeApp);
+#else
+// Run Distributed starts its workers as this executable again; they must not bring up the GUI
+wxIMPLEMENT_APP_NO_MAIN(GameOfLifeApp);
+
+int main(int argc, char** argv) {
+    if (DistributedUniverse::isWorkerCommand(argc, argv)) {
+        return DistributedUniverse::runWorkerProcess(argc, argv);
+    }
+    return wxEntry(argc, argv);
+}
+#endif
 
@@ -0,0 +1,342 @@
+#include "MultiStateUniverse.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+MultiStateUniverse::MultiStateUniverse(int width, int height) {
+    reset(width, height);
+}
+
+void MultiStateUniverse::reset(int newWidth, int newHeight) {
+    width = std::max(newWidth, 0);
+    height = std::max(newHeight, 0);
+    wordsPerRow = (width + 63) / 64;
+    planes.resize(rule.planeCount());
+    for (PlaneVector<std::uint64_t>& plane : planes) {
+        plane.assign(static_cast<size_t>(wordsPerRow) * height, 0);
+    }
+    // The step buffers are sized on first use
+    nextPlanes.clear();
+    counted.clear();
+}
+
+void MultiStateUniverse::clear() {
+    for (PlaneVector<std::uint64_t>& plane : planes) {
+        std::fill(plane.begin(), plane.end(), 0);
+    }
+}
+
+std::uint64_t MultiStateUniverse::stateMask(size_t word, int state) const {
+    std::uint64_t mask = ~0ULL;
+    for (size_t k = 0; k < planes.size(); k++) {
+        mask &= (state >> k) & 1 ? planes[k][word] : ~planes[k][word];
+    }
+    return mask;
+}
+
+void MultiStateUniverse::setRule(const MultiStateRule& multiStateRule) {
+    int oldPlanes = static_cast<int>(planes.size());
+    rule = multiStateRule;
+    int newPlanes = rule.planeCount();
+
+    // Clear the states past the new count before any planes go, while they can still be told apart
+    if ((1 << oldPlanes) > rule.states) {
+        for (size_t word = 0; word < static_cast<size_t>(wordsPerRow) * height; word++) {
+            std::uint64_t cleared = 0;
+            for (int state = rule.states; state < (1 << oldPlanes); state++) {
+                cleared |= stateMask(word, state);
+            }
+            for (PlaneVector<std::uint64_t>& plane : planes) {
+                plane[word] &= ~cleared;
+            }
+        }
+    }
+    planes.resize(newPlanes, PlaneVector<std::uint64_t>(static_cast<size_t>(wordsPerRow) * height, 0));
+    nextPlanes.clear();
+}
+
+int MultiStateUniverse::getState(int x, int y) const {
+    if (!isWithinBounds(x, y)) {
+        return 0;
+    }
+    size_t word = static_cast<size_t>(y) * wordsPerRow + (x >> 6);
+    int state = 0;
+    for (size_t k = 0; k < planes.size(); k++) {
+        state |= static_cast<int>((planes[k][word] >> (x & 63)) & 1) << k;
+    }
+    return state;
+}
+
+void MultiStateUniverse::setState(int x, int y, int state) {
+    if (!isWithinBounds(x, y)) {
+        return;
+    }
+    state = std::clamp(state, 0, rule.states - 1);
+    size_t word = static_cast<size_t>(y) * wordsPerRow + (x >> 6);
+    std::uint64_t bit = 1ULL << (x & 63);
+    for (size_t k = 0; k < planes.size(); k++) {
+        planes[k][word] = (state >> k) & 1 ? (planes[k][word] | bit) : (planes[k][word] & ~bit);
+    }
+}
+
+void MultiStateUniverse::importAlive(const GridPlanes& source, int state) {
+    isToroidal = source.toroidal;
+    reset(source.width, source.height);
+    state = std::clamp(state, 0, rule.states - 1);
+    for (size_t k = 0; k < planes.size(); k++) {
+        if ((state >> k) & 1) {
+            std::copy(source.cells, source.cells + planes[k].size(), planes[k].begin());
+        }
+    }
+}
+
+BitPattern MultiStateUniverse::liveCells() const {
+    BitPattern live(width, height);
+    for (size_t word = 0; word < live.rows.size(); word++) {
+        std::uint64_t bits = 0;
+        for (int state = 1; state < rule.states; state++) {
+            bits |= rule.isLive(state) ? stateMask(word, state) : 0;
+        }
+        live.rows[word] = bits;
+    }
+    // stateMask(0) is never included, so bits past the width stay clear
+    return live;
+}
+
+long long MultiStateUniverse::countState(int state) const {
+    if (state == 0) {
+        // Bits past the width read as state 0, so count the others instead
+        long long occupied = 0;
+        for (int other = 1; other < rule.states; other++) {
+            occupied += countState(other);
+        }
+        return static_cast<long long>(width) * height - occupied;
+    }
+    long long count = 0;
+    for (size_t word = 0; word < static_cast<size_t>(wordsPerRow) * height; word++) {
+        count += std::popcount(stateMask(word, state));
+    }
+    return count;
+}
+
+long long MultiStateUniverse::getPopulation() const {
+    long long population = 0;
+    for (int state = 1; state < rule.states; state++) {
+        population += rule.isLive(state) ? countState(state) : 0;
+    }
+    return population;
+}
+
+void MultiStateUniverse::advance(int generations) {
+    for (int i = 0; i < generations; i++) {
+        step();
+    }
+}
+
+void MultiStateUniverse::step() {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    const size_t words = static_cast<size_t>(wordsPerRow) * height;
+    const int planeCount = static_cast<int>(planes.size());
+    nextPlanes.resize(planeCount);
+    for (PlaneVector<std::uint64_t>& plane : nextPlanes) {
+        plane.resize(words);
+    }
+    counted.resize(words);
+    for (size_t word = 0; word < words; word++) {
+        counted[word] = stateMask(word, 1);
+    }
+
+    // A WireWorld conductor fires on one or two heads whatever its own state, which is B12/S12
+    const bool wireWorld = rule.family == MultiStateRule::Family::WireWorld;
+    LifeRule countRule = rule.lifeRule;
+    if (wireWorld) {
+        countRule.birth = countRule.survival = (1 << 1) | (1 << 2);
+    }
+    const std::uint64_t lastWordMask = width % 64 == 0 ? ~0ULL : (1ULL << (width % 64)) - 1;
+    const int lastBit = (width - 1) & 63;
+    const std::vector<std::uint64_t> emptyRow(wordsPerRow, 0);
+
+    for (int y = 0; y < height; y++) {
+        const std::uint64_t* rows[3];
+        for (int dy = -1; dy <= 1; dy++) {
+            int row = y + dy;
+            if (row < 0 || row >= height) {
+                row = isToroidal ? (row + height) % height : -1;
+            }
+            rows[dy + 1] = row < 0 ? emptyRow.data() : &counted[static_cast<size_t>(row) * wordsPerRow];
+        }
+
+        for (int w = 0; w < wordsPerRow; w++) {
+            // Neighbours to the west and east of each bit, bringing in the adjacent words and,
+            // on a torus, the cell at the other end of the row
+            std::uint64_t west[3], east[3];
+            for (int r = 0; r < 3; r++) {
+                const std::uint64_t* row = rows[r];
+                std::uint64_t westCarry = w > 0 ? row[w - 1] >> 63 : (isToroidal ? (row[wordsPerRow - 1] >> lastBit) & 1 : 0);
+                std::uint64_t eastCarry = w + 1 < wordsPerRow ? row[w + 1] << 63 : (isToroidal ? (row[0] & 1) << lastBit : 0);
+                west[r] = (row[w] << 1) | westCarry;
+                east[r] = (row[w] >> 1) | eastCarry;
+            }
+            std::uint64_t fired = TileStepper::nextWord(west[0], rows[0][w], east[0], west[1], rows[1][w], east[1],
+                west[2], rows[2][w], east[2], countRule);
+            if (w == wordsPerRow - 1) {
+                fired &= lastWordMask;
+            }
+
+            size_t word = static_cast<size_t>(y) * wordsPerRow + w;
+            if (wireWorld) {
+                // Head 01 -> tail 10, tail -> conductor 11, conductor -> head if fired
+                std::uint64_t low = planes[0][word], high = planes[1][word];
+                std::uint64_t head = low & ~high, tail = ~low & high, conductor = low & high;
+                std::uint64_t newHead = conductor & fired;
+                std::uint64_t newConductor = tail | (conductor & ~fired);
+                nextPlanes[0][word] = newHead | newConductor;
+                nextPlanes[1][word] = head | newConductor;
+                continue;
+            }
+
+            // Generations: 'fired' is survival for live cells and birth for the rest. Live cells
+            // that survive and dead cells that are born end up in state 1; every other occupied
+            // cell moves on one state, which also takes a live cell that dies to state 2, and the
+            // last state wraps around to dead.
+            std::uint64_t live = rows[1][w];
+            std::uint64_t occupied = 0;
+            for (int k = 0; k < planeCount; k++) {
+                occupied |= planes[k][word];
+            }
+            std::uint64_t toLive = fired & (live | ~occupied);
+            std::uint64_t moving = occupied & ~(live & fired);
+            std::uint64_t wrapping = moving & stateMask(word, rule.states - 1);
+            std::uint64_t carry = moving;
+            for (int k = 0; k < planeCount; k++) {
+                std::uint64_t bit = planes[k][word];
+                std::uint64_t incremented = bit ^ carry;
+                carry &= bit;
+                nextPlanes[k][word] = (incremented & moving & ~wrapping) | (k == 0 ? toLive : 0);
+            }
+        }
+    }
+    planes.swap(nextPlanes);
+}
+
+bool MultiStateUniverse::save(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "x = " << width << ", y = " << height << ", rule = " << rule.toString() << "\n";
+
+    // Runs are joined into lines of at most 70 characters, as RLE readers expect
+    std::string line;
+    auto emit = [&](int count, char symbol) {
+        std::string run = (count > 1 ? std::to_string(count) : std::string()) + symbol;
+        if (line.size() + run.size() > 70) {
+            out << line << "\n";
+            line.clear();
+        }
+        line += run;
+    };
+    int pendingRows = 0;
+    for (int y = 0; y < height; y++) {
+        int x = 0;
+        bool rowStarted = false;
+        while (x < width) {
+            int state = getState(x, y);
+            int run = 1;
+            while (x + run < width && getState(x + run, y) == state) {
+                run++;
+            }
+            if (state != 0 || x + run < width) {
+                if (!rowStarted && pendingRows > 0) {
+                    emit(pendingRows, '$');
+                    pendingRows = 0;
+                }
+                rowStarted = true;
+                emit(run, state == 0 ? '.' : static_cast<char>('A' + state - 1));
+            }
+            x += run;
+        }
+        pendingRows++;
+    }
+    line += "!";
+    out << line << "\n";
+    return out.good();
+}
+
+bool MultiStateUniverse::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line, body;
+    int fileWidth = -1, fileHeight = -1;
+    MultiStateRule fileRule = rule;
+    bool headerSeen = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!headerSeen && line[0] == 'x') {
+            headerSeen = true;
+            if (std::sscanf(line.c_str(), "x = %d , y = %d", &fileWidth, &fileHeight) != 2) {
+                return false;
+            }
+            size_t rulePosition = line.find("rule");
+            size_t equals = rulePosition == std::string::npos ? std::string::npos : line.find('=', rulePosition);
+            if (equals != std::string::npos && !MultiStateRule::parse(line.substr(equals + 1), fileRule)) {
+                // A two-state rule is the Generations rule with two states
+                LifeRule lifeRule;
+                if (!LifeRule::parse(line.substr(equals + 1), lifeRule)) {
+                    return false;
+                }
+                fileRule = MultiStateRule();
+                fileRule.lifeRule = lifeRule;
+                fileRule.states = 2;
+            }
+            continue;
+        }
+        body += line;
+    }
+    if (!headerSeen || fileWidth < 0 || fileHeight < 0) {
+        return false;
+    }
+
+    setRule(fileRule);
+    reset(fileWidth, fileHeight);
+    int x = 0, y = 0, run = 0;
+    for (char c : body) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            run = run * 10 + (c - '0');
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            continue;
+        }
+        int count = run == 0 ? 1 : run;
+        run = 0;
+        if (c == '!') {
+            break;
+        }
+        if (c == '$') {
+            y += count;
+            x = 0;
+            continue;
+        }
+        int state = c == '.' || c == 'b' ? 0 : c == 'o' ? 1 : c >= 'A' && c <= 'X' ? c - 'A' + 1 : -1;
+        if (state < 0 || state >= rule.states) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            setState(x++, y, state);
+        }
+    }
+    return true;
+}
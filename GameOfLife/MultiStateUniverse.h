@@ -0,0 +1,69 @@
+#pragma once
+
+#include "BitPattern.h"
+#include "LifeRule.h"
+#include "PlaneMemory.h"
+#include "TileStepper.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A universe whose cells hold one of up to MultiStateRule::MAX_STATES states, for Generations
+// and WireWorld rules.
+//
+// States are bit-sliced: plane k holds bit k of every cell's state, packed like the two-state
+// alive plane, so two to four planes cover every rule. A generation first collects the cells in
+// state 1, the only ones that count as neighbours in either family, and runs them through the
+// same word-parallel neighbour count as the two-state engine; the transitions of each family
+// are then a handful of logic operations on whole words of the state planes, 64 cells at a time.
+class MultiStateUniverse {
+public:
+    MultiStateUniverse(int width = 0, int height = 0);
+
+    // Sizes the universe and clears every cell to state 0
+    void reset(int width, int height);
+    void clear();
+
+    // States the new rule has no room for are cleared
+    void setRule(const MultiStateRule& multiStateRule);
+    const MultiStateRule& getRule() const { return rule; }
+    void setToroidal(bool toroidal) { isToroidal = toroidal; }
+    bool getToroidal() const { return isToroidal; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool isWithinBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    int getState(int x, int y) const;               // 0 outside the universe
+    void setState(int x, int y, int state);         // Clamped to the rule's states
+
+    // Takes the size, edges and live cells of a two-state universe; the live cells get 'state'
+    void importAlive(const GridPlanes& planes, int state);
+    // Cells the rule counts as live, in the layout Universe::stamp takes
+    BitPattern liveCells() const;
+
+    void play() { advance(1); }
+    void advance(int generations);
+
+    long long getPopulation() const;                // Cells the rule counts as live
+    long long countState(int state) const;
+
+    // Multi-state RLE as Golly writes it: '.' for state 0 and 'A' onwards for states 1 and up,
+    // with the rule in the header. Loading takes the size and rule from the file; two-state
+    // files, written with 'b' and 'o', load too.
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+private:
+    void step();
+    std::uint64_t stateMask(size_t word, int state) const;  // Cells of a word in the given state
+
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    bool isToroidal = false;
+    MultiStateRule rule;
+    std::vector<PlaneVector<std::uint64_t>> planes;     // planes[k] holds bit k of each state
+    std::vector<PlaneVector<std::uint64_t>> nextPlanes; // Step targets, swapped with the planes
+    PlaneVector<std::uint64_t> counted;                 // Cells in state 1 for the step under way
+};
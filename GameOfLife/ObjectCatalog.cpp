@@ -0,0 +1,110 @@
+#include "ObjectCatalog.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    // Parses "o" for alive, anything else for dead, rows separated by '/'
+    std::vector<std::pair<int, int>> parseCells(const char* pattern) {
+        std::vector<std::pair<int, int>> cells;
+        int x = 0, y = 0;
+        for (const char* c = pattern; *c; c++) {
+            if (*c == '/') {
+                x = 0;
+                y++;
+                continue;
+            }
+            if (*c == 'o') {
+                cells.push_back({ x, y });
+            }
+            x++;
+        }
+        return cells;
+    }
+
+    const std::unordered_map<std::uint64_t, CatalogEntry>& catalog() {
+        static const std::unordered_map<std::uint64_t, CatalogEntry> table = [] {
+            struct Listing {
+                const char* name;
+                ObjectKind kind;
+                const char* cells;
+            };
+            const Listing objects[] = {
+                { "block", ObjectKind::StillLife, "oo/oo" },
+                { "beehive", ObjectKind::StillLife, ".oo./o..o/.oo." },
+                { "loaf", ObjectKind::StillLife, ".oo./o..o/.o.o/..o." },
+                { "boat", ObjectKind::StillLife, "oo./o.o/.o." },
+                { "ship", ObjectKind::StillLife, "oo./o.o/.oo" },
+                { "tub", ObjectKind::StillLife, ".o./o.o/.o." },
+                { "pond", ObjectKind::StillLife, ".oo./o..o/o..o/.oo." },
+                { "blinker", ObjectKind::Oscillator, "ooo" },
+                { "toad", ObjectKind::Oscillator, ".ooo/ooo." },
+                { "toad", ObjectKind::Oscillator, "..o./o..o/o..o/.o.." },
+                { "beacon", ObjectKind::Oscillator, "oo../oo../..oo/..oo" },
+                { "beacon", ObjectKind::Oscillator, "oo../o.../...o/..oo" },
+                { "glider", ObjectKind::Spaceship, ".o./..o/ooo" },
+                { "glider", ObjectKind::Spaceship, "o.o/.oo/.o." },
+                { "glider", ObjectKind::Spaceship, "..o/o.o/.oo" },
+                { "glider", ObjectKind::Spaceship, "o../.oo/oo." },
+                { "lightweight spaceship", ObjectKind::Spaceship, ".oooo/o...o/....o/o..o." },
+                { "lightweight spaceship", ObjectKind::Spaceship, "..oo./.oooo/oo.oo/.oo.." },
+                { "lightweight spaceship", ObjectKind::Spaceship, "o..o./....o/o...o/.oooo" },
+                { "lightweight spaceship", ObjectKind::Spaceship, ".oo../oooo./oo.oo/..oo." },
+            };
+            std::unordered_map<std::uint64_t, CatalogEntry> built;
+            for (const auto& object : objects) {
+                built[ObjectCatalog::canonicalHash(parseCells(object.cells))] = { object.name, object.kind };
+            }
+            return built;
+        }();
+        return table;
+    }
+}
+
+std::uint64_t ObjectCatalog::canonicalHash(const std::vector<std::pair<int, int>>& cells) {
+    // Each cell becomes one row-major key so that sorting is a plain integer sort; the buffer is
+    // kept per thread because censuses hash a great many small objects
+    thread_local std::vector<std::uint64_t> keys;
+    keys.resize(cells.size());
+    std::uint64_t best = ~0ULL;
+    for (int symmetry = 0; symmetry < 8; symmetry++) {
+        int minX = 1 << 30, minY = 1 << 30;
+        for (const auto& cell : cells) {
+            int x = cell.first, y = cell.second;
+            if (symmetry & 1) x = -x;
+            if (symmetry & 2) y = -y;
+            if (symmetry & 4) std::swap(x, y);
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+        }
+        for (size_t i = 0; i < cells.size(); i++) {
+            int x = cells[i].first, y = cells[i].second;
+            if (symmetry & 1) x = -x;
+            if (symmetry & 2) y = -y;
+            if (symmetry & 4) std::swap(x, y);
+            keys[i] = (static_cast<std::uint64_t>(y - minY) << 32) | static_cast<std::uint32_t>(x - minX);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::uint64_t hash = 0xCBF29CE484222325ULL ^ cells.size();
+        for (std::uint64_t key : keys) {
+            hash = (hash ^ key) * 0x100000001B3ULL;
+            hash ^= hash >> 29;
+        }
+        best = std::min(best, hash);
+    }
+    return best;
+}
+
+const CatalogEntry* ObjectCatalog::find(std::uint64_t hash) {
+    auto found = catalog().find(hash);
+    return found == catalog().end() ? nullptr : &found->second;
+}
+
+const char* ObjectCatalog::kindName(ObjectKind kind) {
+    switch (kind) {
+    case ObjectKind::StillLife: return "still life";
+    case ObjectKind::Oscillator: return "oscillator";
+    case ObjectKind::Spaceship: return "spaceship";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class ObjectKind {
+    Unknown,
+    StillLife,
+    Oscillator,
+    Spaceship
+};
+
+struct CatalogEntry {
+    std::string name;
+    ObjectKind kind;
+};
+
+// Names the common small objects left behind by random soups. Objects are identified by a
+// hash of their cells that is the same for every rotation and reflection, and every phase of
+// an oscillator or spaceship is listed under one name.
+class ObjectCatalog {
+public:
+    // Hash of a set of cells that is the same for all eight rotations and reflections
+    static std::uint64_t canonicalHash(const std::vector<std::pair<int, int>>& cells);
+
+    // The catalogue entry for a hash, or nullptr if the object is not known
+    static const CatalogEntry* find(std::uint64_t hash);
+
+    static const char* kindName(ObjectKind kind);
+};
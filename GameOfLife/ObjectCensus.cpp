@@ -0,0 +1,434 @@
+#include "ObjectCensus.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    struct Run {
+        int y;
+        int start;
+        int end;    // Inclusive
+    };
+
+    // The runs found by one row band, with row y's runs at [rowStart[y - firstRow], rowStart[y - firstRow + 1])
+    struct Band {
+        int firstRow = 0;
+        std::vector<Run> runs;
+        std::vector<int> rowStart;
+        std::vector<int> parent;
+    };
+
+    int findRoot(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(std::vector<int>& parent, int a, int b) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a != b) {
+            // The lower index wins, so roots do not depend on the order of unions
+            if (a < b) {
+                parent[b] = a;
+            }
+            else {
+                parent[a] = b;
+            }
+        }
+    }
+
+    // Appends the runs of live cells in one row. A run starts where a bit is set and its left
+    // neighbour is not, and ends where the reverse happens, so XOR with the row shifted by one
+    // marks both ends and each word needs only one pass over its edges.
+    void findRuns(const std::uint64_t* row, int wordsPerRow, int width, int y, std::vector<Run>& runs) {
+        bool inRun = false;
+        int start = 0;
+        std::uint64_t carry = 0;
+        for (int w = 0; w < wordsPerRow; w++) {
+            std::uint64_t bits = row[w];
+            int valid = width - w * 64;
+            if (valid < 64) {
+                bits &= (1ULL << valid) - 1;
+            }
+            std::uint64_t edges = bits ^ ((bits << 1) | carry);
+            carry = bits >> 63;
+            while (edges) {
+                int x = w * 64 + std::countr_zero(edges);
+                edges &= edges - 1;
+                if (!inRun) {
+                    start = x;
+                }
+                else {
+                    runs.push_back({ y, start, x - 1 });
+                }
+                inRun = !inRun;
+            }
+        }
+        if (inRun) {
+            runs.push_back({ y, start, width - 1 });
+        }
+    }
+
+    // Unites the runs of two rows that come within 'reach' columns of each other
+    void uniteRows(const std::vector<Run>& runs, std::vector<int>& parent, int above, int aboveEnd, int below, int belowEnd, int reach) {
+        while (above < aboveEnd && below < belowEnd) {
+            if (runs[above].end + reach < runs[below].start) {
+                above++;
+                continue;
+            }
+            if (runs[below].end + reach < runs[above].start) {
+                below++;
+                continue;
+            }
+            unite(parent, above, below);
+            if (runs[above].end < runs[below].end) {
+                above++;
+            }
+            else {
+                below++;
+            }
+        }
+    }
+
+    // Unites runs in the same row separated by fewer than 'reach' dead cells
+    void uniteWithinRow(const std::vector<Run>& runs, std::vector<int>& parent, int first, int end, int reach) {
+        for (int i = first + 1; i < end; i++) {
+            if (runs[i].start - runs[i - 1].end <= reach) {
+                unite(parent, i - 1, i);
+            }
+        }
+    }
+
+    void labelBand(const std::uint64_t* cells, int width, int wordsPerRow, int firstRow, int endRow, int reach, Band& band) {
+        band.firstRow = firstRow;
+        band.rowStart.assign(1, 0);
+        for (int y = firstRow; y < endRow; y++) {
+            findRuns(cells + static_cast<size_t>(y) * wordsPerRow, wordsPerRow, width, y, band.runs);
+            band.rowStart.push_back(static_cast<int>(band.runs.size()));
+        }
+        band.parent.resize(band.runs.size());
+        for (size_t i = 0; i < band.parent.size(); i++) {
+            band.parent[i] = static_cast<int>(i);
+        }
+        for (int row = 0; row < endRow - firstRow; row++) {
+            uniteWithinRow(band.runs, band.parent, band.rowStart[row], band.rowStart[row + 1], reach);
+            for (int back = 1; back <= reach && back <= row; back++) {
+                uniteRows(band.runs, band.parent, band.rowStart[row - back], band.rowStart[row - back + 1],
+                    band.rowStart[row], band.rowStart[row + 1], reach);
+            }
+        }
+    }
+
+    template <typename Work>
+    void runParallel(int threadCount, int items, Work work) {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; t++) {
+            threads.emplace_back(work, static_cast<int>(static_cast<long long>(items) * t / threadCount),
+                static_cast<int>(static_cast<long long>(items) * (t + 1) / threadCount));
+        }
+        work(0, items / threadCount);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+ObjectCensus::ObjectCensus() : worker(&ObjectCensus::work, this) {}
+
+ObjectCensus::~ObjectCensus() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    closeLog();
+}
+
+void ObjectCensus::setInterval(int generations) {
+    interval = std::max(0, generations);
+    lastSubmitted = -1;
+}
+
+bool ObjectCensus::openLog(const std::string& path) {
+    closeLog();
+    if (path.empty()) {
+        return true;
+    }
+    std::error_code error;
+    bool fresh = !std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0;
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        return false;
+    }
+    if (fresh) {
+        std::fprintf(file, "generation,objects,still_lifes,oscillators,spaceships,unknown,objects_by_name\n");
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    log = file;
+    return true;
+}
+
+void ObjectCensus::closeLog() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+}
+
+bool ObjectCensus::submit(const GridPlanes& planes, long long generation) {
+    if (interval <= 0 || (lastSubmitted >= 0 && generation >= lastSubmitted && generation - lastSubmitted < interval)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (busy) {
+            return false;  // Still labelling an earlier generation; try again on the next one
+        }
+        // Only the alive plane is needed, and the copy reuses the previous allocation
+        snapshot.assign(planes.cells, planes.cells + static_cast<size_t>(planes.wordsPerRow) * planes.height);
+        width = planes.width;
+        height = planes.height;
+        wordsPerRow = planes.wordsPerRow;
+        toroidal = planes.toroidal;
+        snapshotGeneration = generation;
+        busy = true;
+    }
+    lastSubmitted = generation;
+    wake.notify_one();
+    return true;
+}
+
+bool ObjectCensus::takeReport(ObjectReport& report) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!reportReady) {
+        return false;
+    }
+    report = std::move(latest);
+    reportReady = false;
+    return true;
+}
+
+void ObjectCensus::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return busy || stopping; });
+        if (stopping) {
+            return;
+        }
+        // The submitting side leaves the snapshot alone while busy is set
+        lock.unlock();
+        ObjectReport report = label(snapshot.data(), width, height, wordsPerRow, toroidal);
+        report.generation = snapshotGeneration;
+        lock.lock();
+
+        writeLog(report);
+        latest = std::move(report);
+        reportReady = true;
+        busy = false;
+    }
+}
+
+void ObjectCensus::writeLog(const ObjectReport& report) {
+    // Caller holds the mutex
+    if (!log) {
+        return;
+    }
+    std::string objects;
+    for (const auto& object : report.counts) {
+        if (!objects.empty()) {
+            objects += ';';
+        }
+        objects += object.first + "=" + std::to_string(object.second);
+    }
+    std::fprintf(log, "%lld,%zu,%d,%d,%d,%d,%s\n", report.generation, report.objects.size(),
+        report.kinds[static_cast<int>(ObjectKind::StillLife)], report.kinds[static_cast<int>(ObjectKind::Oscillator)],
+        report.kinds[static_cast<int>(ObjectKind::Spaceship)], report.kinds[static_cast<int>(ObjectKind::Unknown)], objects.c_str());
+    std::fflush(log);
+}
+
+ObjectReport ObjectCensus::label(const std::uint64_t* cells, int width, int height, int wordsPerRow, bool toroidal, int reach, int threads) {
+    auto started = std::chrono::steady_clock::now();
+    ObjectReport report;
+    if (width <= 0 || height <= 0) {
+        return report;
+    }
+    reach = std::max(1, reach);
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Runs and unions within each band, all bands at once
+    int bandCount = std::min(threads, height / 64 + 1);
+    bandCount = std::max(1, std::min(bandCount, height / reach));
+    std::vector<Band> bands(bandCount);
+    runParallel(bandCount, bandCount, [&](int firstBand, int endBand) {
+        for (int b = firstBand; b < endBand; b++) {
+            labelBand(cells, width, wordsPerRow, static_cast<int>(static_cast<long long>(height) * b / bandCount),
+                static_cast<int>(static_cast<long long>(height) * (b + 1) / bandCount), reach, bands[b]);
+        }
+    });
+
+    // Join the bands into one forest; roots stay roots because every band's indices move by the same offset
+    std::vector<Run> runs;
+    std::vector<int> parent;
+    std::vector<int> rowStart;
+    for (Band& band : bands) {
+        int base = static_cast<int>(runs.size());
+        runs.insert(runs.end(), band.runs.begin(), band.runs.end());
+        for (int p : band.parent) {
+            parent.push_back(p + base);
+        }
+        for (size_t row = 0; row + 1 < band.rowStart.size(); row++) {
+            rowStart.push_back(band.rowStart[row] + base);
+        }
+        band = Band();
+    }
+    rowStart.push_back(static_cast<int>(runs.size()));
+
+    // Seams between bands: rows on either side that are within reach of each other. Bands are
+    // at least 'reach' rows tall, so these pairs never skip over a whole band.
+    for (int b = 1; b < bandCount; b++) {
+        int seam = static_cast<int>(static_cast<long long>(height) * b / bandCount);
+        for (int above = std::max(0, seam - reach); above < seam; above++) {
+            for (int below = seam; below < std::min(height, above + reach + 1); below++) {
+                uniteRows(runs, parent, rowStart[above], rowStart[above + 1], rowStart[below], rowStart[below + 1], reach);
+            }
+        }
+    }
+    if (toroidal) {
+        // The same across the top and bottom edges
+        for (int above = std::max(0, height - reach); above < height; above++) {
+            for (int below = 0; below <= above + reach - height && below < above; below++) {
+                uniteRows(runs, parent, rowStart[above], rowStart[above + 1], rowStart[below], rowStart[below + 1], reach);
+            }
+        }
+        // and across the left and right edges, where only the last run of one row and the first
+        // run of another can come close enough
+        for (int y = 0; y < height; y++) {
+            if (rowStart[y] == rowStart[y + 1]) {
+                continue;
+            }
+            int last = rowStart[y + 1] - 1;
+            for (int dy = -reach; dy <= reach; dy++) {
+                int other = ((y + dy) % height + height) % height;
+                if (rowStart[other] != rowStart[other + 1] && runs[rowStart[other]].start + width - runs[last].end <= reach) {
+                    unite(parent, last, rowStart[other]);
+                }
+            }
+        }
+    }
+
+    // Number the objects and find their extents
+    std::vector<int> objectOf(runs.size());
+    std::vector<int> idOfRoot(runs.size(), -1);
+    struct Extent {
+        int minX, maxX, minY, maxY;
+        int population;
+    };
+    std::vector<Extent> extents;
+    for (size_t i = 0; i < runs.size(); i++) {
+        int root = findRoot(parent, static_cast<int>(i));
+        if (idOfRoot[root] < 0) {
+            idOfRoot[root] = static_cast<int>(extents.size());
+            extents.push_back({ width, -1, height, -1, 0 });
+        }
+        int id = idOfRoot[root];
+        objectOf[i] = id;
+        Extent& extent = extents[id];
+        extent.minX = std::min(extent.minX, runs[i].start);
+        extent.maxX = std::max(extent.maxX, runs[i].end);
+        extent.minY = std::min(extent.minY, runs[i].y);
+        extent.maxY = std::max(extent.maxY, runs[i].y);
+        extent.population += runs[i].end - runs[i].start + 1;
+    }
+    parent = std::vector<int>();
+    idOfRoot = std::vector<int>();
+
+    // Group the runs by object so each object's cells can be gathered in one place
+    std::vector<int> firstRun(extents.size() + 1, 0);
+    for (int id : objectOf) {
+        firstRun[id + 1]++;
+    }
+    for (size_t id = 0; id < extents.size(); id++) {
+        firstRun[id + 1] += firstRun[id];
+    }
+    std::vector<int> byObject(runs.size());
+    {
+        std::vector<int> next(firstRun.begin(), firstRun.end() - 1);
+        for (size_t i = 0; i < runs.size(); i++) {
+            byObject[next[objectOf[i]]++] = static_cast<int>(i);
+        }
+    }
+
+    // Bounding boxes and hashes. An object reaching across the edges of a torus is unwrapped by
+    // moving the part in the low half across the seam, which restores the true shape of any
+    // object smaller than half the universe.
+    report.objects.resize(extents.size());
+    int objectCount = static_cast<int>(extents.size());
+    runParallel(std::min(threads, objectCount / 4096 + 1), objectCount, [&](int first, int end) {
+        std::vector<std::pair<int, int>> objectCells;
+        for (int id = first; id < end; id++) {
+            const Extent& extent = extents[id];
+            bool wrapX = toroidal && extent.minX + width - extent.maxX <= reach;
+            bool wrapY = toroidal && extent.minY + height - extent.maxY <= reach;
+            int minX = width * 2, maxX = -1, minY = height * 2, maxY = -1;
+            objectCells.clear();
+            bool hashed = extent.population <= MAX_HASHED_POPULATION;
+            for (int r = firstRun[id]; r < firstRun[id + 1]; r++) {
+                const Run& run = runs[byObject[r]];
+                int shiftX = wrapX && run.start < width / 2 ? width : 0;
+                int y = run.y + (wrapY && run.y < height / 2 ? height : 0);
+                minX = std::min(minX, run.start + shiftX);
+                maxX = std::max(maxX, run.end + shiftX);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+                if (hashed) {
+                    for (int x = run.start; x <= run.end; x++) {
+                        objectCells.push_back({ x + shiftX, y });
+                    }
+                }
+            }
+
+            CensusObject& object = report.objects[id];
+            object.x = minX % width;
+            object.y = minY % height;
+            object.width = maxX - minX + 1;
+            object.height = maxY - minY + 1;
+            object.population = extent.population;
+            if (hashed) {
+                object.hash = ObjectCatalog::canonicalHash(objectCells);
+                object.entry = ObjectCatalog::find(object.hash);
+            }
+        }
+    });
+
+    // Tally by entry and by population first, so each name is built once rather than per object
+    std::unordered_map<const CatalogEntry*, int> known;
+    std::unordered_map<int, int> unknown;
+    for (const CensusObject& object : report.objects) {
+        if (object.entry) {
+            known[object.entry]++;
+            report.kinds[static_cast<int>(object.entry->kind)]++;
+        }
+        else {
+            unknown[object.population]++;
+            report.kinds[static_cast<int>(ObjectKind::Unknown)]++;
+        }
+    }
+    for (const auto& entry : known) {
+        report.counts[entry.first->name] += entry.second;   // Phases share a name
+    }
+    for (const auto& entry : unknown) {
+        report.counts["other" + std::to_string(entry.first)] = entry.second;
+    }
+    report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return report;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ObjectCatalog.h"
+#include "TileStepper.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One group of live cells, each within ObjectCensus::DEFAULT_REACH cells of another
+struct CensusObject {
+    int x = 0;                  // Bounding box; on a torus x and y may lie near the far edge
+    int y = 0;                  // and the box wrap around it
+    int width = 0;
+    int height = 0;
+    int population = 0;
+    std::uint64_t hash = 0;     // ObjectCatalog::canonicalHash, 0 for objects too big to hash
+    const CatalogEntry* entry = nullptr;    // Catalogue entry, or nullptr if not recognised
+};
+
+struct ObjectReport {
+    long long generation = -1;
+    std::vector<CensusObject> objects;
+    std::map<std::string, int> counts;                      // Objects by name; unknown ones as other<population>
+    int kinds[static_cast<int>(ObjectKind::Spaceship) + 1] = {}; // Objects by ObjectKind
+    double milliseconds = 0;                                // Time taken to label and classify
+};
+
+// Splits the live cells of a generation into connected objects and names the ones in the
+// ObjectCatalog. Submitting copies the alive plane and returns; the labeling runs on a
+// background thread, so the step engine never waits for it. If the previous generation is
+// still being labelled when the next is due, the new one is skipped rather than queued.
+//
+// Labeling is run-based: each row band finds its runs of live cells and unites runs within
+// reach of each other with its own union-find, all bands in parallel. The seams between bands,
+// and the wrap-around edges of a toroidal universe, are then united in one short serial pass
+// before objects are collected and hashed.
+class ObjectCensus {
+public:
+    static const int MAX_HASHED_POPULATION = 1024;  // Larger objects are counted but not hashed
+
+    // Cells up to this many rows or columns apart belong to the same object. With 1 objects are
+    // 8-connected, but a lightweight spaceship then loses a cell in two of its four phases.
+    static const int DEFAULT_REACH = 2;
+
+    ObjectCensus();
+    ~ObjectCensus();
+
+    ObjectCensus(const ObjectCensus&) = delete;
+    ObjectCensus& operator=(const ObjectCensus&) = delete;
+
+    // Census every 'interval' generations; 0 turns it off
+    void setInterval(int generations);
+    int getInterval() const { return interval; }
+
+    // Appends one CSV row per report; an empty path stops logging
+    bool openLog(const std::string& path);
+    void closeLog();
+
+    // Starts a census of this generation if one is due and the previous one has finished
+    bool submit(const GridPlanes& planes, long long generation);
+
+    // The newest report finished since the last call, if any
+    bool takeReport(ObjectReport& report);
+
+    // Labels and classifies an alive plane on the calling thread plus up to 'threads' - 1 helpers
+    static ObjectReport label(const std::uint64_t* cells, int width, int height, int wordsPerRow, bool toroidal,
+        int reach = DEFAULT_REACH, int threads = 0);
+
+private:
+    void work();
+    void writeLog(const ObjectReport& report);
+
+    int interval = 0;
+    long long lastSubmitted = -1;
+
+    std::mutex mutex;                   // Guards everything below
+    std::condition_variable wake;
+    std::thread worker;
+    bool busy = false;                  // The worker owns the snapshot
+    bool stopping = false;
+    std::vector<std::uint64_t> snapshot;
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    bool toroidal = false;
+    long long snapshotGeneration = 0;
+    bool reportReady = false;
+    ObjectReport latest;
+    std::FILE* log = nullptr;
+};
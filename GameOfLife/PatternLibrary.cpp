@@ -0,0 +1,321 @@
+#include "PatternLibrary.h"
+#include "CounterRandom.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            return "";
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+    }
+
+    BitPattern fromRows(const std::vector<std::string>& rows, int width) {
+        BitPattern cells(width, static_cast<int>(rows.size()));
+        for (size_t y = 0; y < rows.size(); y++) {
+            for (size_t x = 0; x < rows[y].size(); x++) {
+                if (rows[y][x] != '.') {
+                    cells.set(static_cast<int>(x), static_cast<int>(y));
+                }
+            }
+        }
+        return cells;
+    }
+}
+
+PatternLibrary::PatternLibrary() {
+    add("Glider", fromRows({ ".o.", "..o", "ooo" }, 3));
+    add("Lightweight spaceship", fromRows({ ".oooo", "o...o", "....o", "o..o." }, 5));
+    add("Pulsar", fromRows({
+        "..ooo...ooo..",
+        ".............",
+        "o....o.o....o",
+        "o....o.o....o",
+        "o....o.o....o",
+        "..ooo...ooo..",
+        ".............",
+        "..ooo...ooo..",
+        "o....o.o....o",
+        "o....o.o....o",
+        "o....o.o....o",
+        ".............",
+        "..ooo...ooo..",
+    }, 13));
+}
+
+int PatternLibrary::loadDirectory(const std::string& directory) {
+    std::error_code error;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = toLower(entry.path().extension().string());
+        if (entry.is_regular_file(error) && (extension == ".rle" || extension == ".cells")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());  // Same order, and so the same winner for duplicate names, on every platform
+
+    int loaded = 0;
+    for (const auto& file : files) {
+        loaded += loadFile(file.string());
+    }
+    return loaded;
+}
+
+bool PatternLibrary::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    std::string name;
+    BitPattern cells;
+    std::filesystem::path filePath(path);
+    bool parsed = toLower(filePath.extension().string()) == ".cells"
+        ? parsePlaintext(contents.str(), name, cells)
+        : parseRle(contents.str(), name, cells);
+    if (!parsed || cells.population() == 0) {
+        return false;
+    }
+    add(name.empty() ? filePath.stem().string() : name, cells, path);
+    return true;
+}
+
+void PatternLibrary::add(const std::string& name, const BitPattern& cells, const std::string& source) {
+    Pattern pattern;
+    pattern.name = name;
+    pattern.source = source;
+    pattern.width = cells.width;
+    pattern.height = cells.height;
+    pattern.period = findPeriod(cells);
+    for (int symmetry = 0; symmetry < 8; symmetry++) {
+        pattern.orientations[symmetry] = cells.transformed(symmetry);
+        pattern.footprints[symmetry] = pattern.orientations[symmetry].dilated();
+    }
+
+    auto existing = byName.find(toLower(name));
+    if (existing != byName.end()) {
+        // A later file with the same name replaces the earlier pattern
+        patterns[existing->second] = std::move(pattern);
+        byPeriod.clear();
+        byExtent.clear();
+        for (size_t i = 0; i < patterns.size(); i++) {
+            byPeriod.emplace(patterns[i].period, i);
+            byExtent.emplace(std::max(patterns[i].width, patterns[i].height), i);
+        }
+        return;
+    }
+
+    size_t index = patterns.size();
+    byName[toLower(name)] = index;
+    byPeriod.emplace(pattern.period, index);
+    byExtent.emplace(std::max(pattern.width, pattern.height), index);
+    patterns.push_back(std::move(pattern));
+}
+
+const Pattern* PatternLibrary::find(const std::string& name) const {
+    auto found = byName.find(toLower(name));
+    return found == byName.end() ? nullptr : &patterns[found->second];
+}
+
+std::vector<const Pattern*> PatternLibrary::withPeriod(int period) const {
+    std::vector<const Pattern*> matches;
+    auto range = byPeriod.equal_range(period);
+    for (auto it = range.first; it != range.second; ++it) {
+        matches.push_back(&patterns[it->second]);
+    }
+    return matches;
+}
+
+std::vector<const Pattern*> PatternLibrary::fittingWithin(int maxWidth, int maxHeight) const {
+    // Only patterns whose longer side fits the longer limit can fit, in some orientation
+    std::vector<const Pattern*> matches;
+    int minSide = std::min(maxWidth, maxHeight);
+    for (auto it = byExtent.begin(); it != byExtent.upper_bound(std::max(maxWidth, maxHeight)); ++it) {
+        const Pattern& pattern = patterns[it->second];
+        if (std::min(pattern.width, pattern.height) <= minSide) {
+            matches.push_back(&pattern);
+        }
+    }
+    return matches;
+}
+
+std::vector<const Pattern*> PatternLibrary::all() const {
+    std::vector<const Pattern*> sorted;
+    for (const auto& entry : byName) {
+        sorted.push_back(&patterns[entry.second]);
+    }
+    return sorted;
+}
+
+int PatternLibrary::place(Universe& universe, const Pattern& pattern, const PlacementOptions& options) {
+    const int maxAttempts = 64;
+    int regionX = options.regionX, regionY = options.regionY;
+    int regionWidth = options.regionWidth, regionHeight = options.regionHeight;
+    if (regionWidth <= 0 || regionHeight <= 0) {
+        regionX = 0;
+        regionY = 0;
+        regionWidth = universe.getWidth();
+        regionHeight = universe.getHeight();
+    }
+
+    const CounterRandom random(options.seed);
+    int placed = 0;
+    for (int instance = 0; instance < options.count; instance++) {
+        for (int attempt = 0; attempt < maxAttempts; attempt++) {
+            CounterRandom::Block draw = random(static_cast<std::uint64_t>(instance), static_cast<std::uint64_t>(attempt));
+            int symmetry = options.orientation >= 0 ? (options.orientation & 7) : static_cast<int>(draw[0] & 7);
+            const BitPattern& cells = pattern.orientations[symmetry];
+            int spanX = regionWidth - cells.width + 1;
+            int spanY = regionHeight - cells.height + 1;
+            if (spanX <= 0 || spanY <= 0) {
+                break;  // Does not fit in this orientation
+            }
+            int x = regionX + static_cast<int>(draw[1] % static_cast<std::uint32_t>(spanX));
+            int y = regionY + static_cast<int>(draw[2] % static_cast<std::uint32_t>(spanY));
+
+            // The footprint covers the pattern and its neighbours, so a clear footprint means the
+            // new copy neither overlaps nor touches anything already on the grid
+            if (options.collisionFree && universe.intersects(pattern.footprints[symmetry], x - 1, y - 1)) {
+                continue;
+            }
+            universe.stamp(cells, x, y, options.color);
+            placed++;
+            break;
+        }
+    }
+    return placed;
+}
+
+bool PatternLibrary::parseRle(const std::string& text, std::string& name, BitPattern& cells) {
+    std::istringstream lines(text);
+    std::string line;
+    std::string body;
+    int width = 0, height = 0;
+    bool headerSeen = false;
+    while (std::getline(lines, line)) {
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            if (line.size() > 1 && line[1] == 'N') {
+                name = trim(line.substr(2));
+            }
+            continue;
+        }
+        if (!headerSeen && line[0] == 'x') {
+            headerSeen = true;
+            std::sscanf(line.c_str(), "x = %d , y = %d", &width, &height);
+            continue;
+        }
+        body += line;
+    }
+
+    // Decode the runs; any cell state other than b or . counts as alive
+    std::vector<std::pair<int, int>> live;
+    int x = 0, y = 0, run = 0, extentX = 0;
+    for (char c : body) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            run = run * 10 + (c - '0');
+            continue;
+        }
+        int count = run == 0 ? 1 : run;
+        run = 0;
+        if (c == '!') {
+            break;
+        }
+        if (c == '$') {
+            y += count;
+            x = 0;
+        }
+        else if (c == 'b' || c == '.') {
+            x += count;
+        }
+        else if (std::isalpha(static_cast<unsigned char>(c))) {
+            for (int i = 0; i < count; i++) {
+                live.push_back({ x++, y });
+            }
+        }
+        extentX = std::max(extentX, x);
+    }
+    if (live.empty()) {
+        return false;
+    }
+
+    cells = BitPattern(std::max(width, extentX), std::max(height, live.back().second + 1));
+    for (const auto& cell : live) {
+        cells.set(cell.first, cell.second);
+    }
+    return true;
+}
+
+bool PatternLibrary::parsePlaintext(const std::string& text, std::string& name, BitPattern& cells) {
+    std::istringstream lines(text);
+    std::string line;
+    std::vector<std::string> rows;
+    int width = 0;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] == '!') {
+            if (line.compare(0, 6, "!Name:") == 0) {
+                name = trim(line.substr(6));
+            }
+            continue;
+        }
+        // Alive cells are written O or *, dead ones .
+        for (char& c : line) {
+            c = (c == 'O' || c == 'o' || c == '*') ? 'o' : '.';
+        }
+        rows.push_back(line);
+        width = std::max(width, static_cast<int>(line.size()));
+    }
+    while (!rows.empty() && rows.back().find('o') == std::string::npos) {
+        rows.pop_back();
+    }
+    if (rows.empty() || width == 0) {
+        return false;
+    }
+    cells = fromRows(rows, width);
+    return true;
+}
+
+int PatternLibrary::findPeriod(const BitPattern& cells, int maxPeriod) {
+    // Huge patterns are still indexed, just without a period
+    if (static_cast<long long>(cells.width) * cells.height > 256 * 256) {
+        return 0;
+    }
+
+    // Nothing travels faster than one cell per generation, so this margin keeps the pattern
+    // clear of the board's edges for the whole run
+    int margin = maxPeriod + 2;
+    Universe board(cells.width + 2 * margin, cells.height + 2 * margin);
+    board.stamp(cells, margin, margin, 0);
+    BitPattern initial = cells.trimmed();
+
+    for (int generation = 1; generation <= maxPeriod; generation++) {
+        board.play();
+        BitPattern current = board.extract(0, 0, board.getWidth(), board.getHeight()).trimmed();
+        if (current.population() == 0) {
+            return 0;
+        }
+        if (current == initial) {
+            return generation;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BitPattern.h"
+#include "Universe.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Pattern {
+    std::string name;
+    std::string source;                     // File the pattern was read from, empty for built-ins
+    int width = 0;
+    int height = 0;
+    int period = 0;                         // 1 for still lifes, 0 if no repeat was found
+    std::array<BitPattern, 8> orientations; // Indexed by BitPattern::transformed symmetry
+    std::array<BitPattern, 8> footprints;   // Each orientation dilated by one cell
+};
+
+struct PlacementOptions {
+    int count = 1;
+    std::uint64_t seed = 1;                 // Positions and orientations are derived from the seed
+    int orientation = -1;                   // 0-7 for a fixed orientation, -1 for a random one each time
+    bool collisionFree = true;              // Keep every instance clear of live cells and their neighbours
+    int regionX = 0;                        // Instances are placed entirely within this region,
+    int regionY = 0;                        // or the whole universe if its width is 0
+    int regionWidth = 0;
+    int regionHeight = 0;
+    std::uint32_t color = 0;
+};
+
+// Named patterns loaded from a directory of RLE (.rle) and plaintext (.cells) files, indexed by
+// name, bounding box and period. All eight orientations of each pattern are built when it is
+// added, so placing one is a shifted word copy into the universe's bit plane.
+class PatternLibrary {
+public:
+    PatternLibrary();  // Starts with the built-in glider, lightweight spaceship and pulsar
+
+    // Adds every pattern file in the directory; returns how many were loaded
+    int loadDirectory(const std::string& directory);
+    bool loadFile(const std::string& path);
+    void add(const std::string& name, const BitPattern& cells, const std::string& source = "");
+
+    const Pattern* find(const std::string& name) const;  // Ignores case
+    std::vector<const Pattern*> withPeriod(int period) const;
+    std::vector<const Pattern*> fittingWithin(int maxWidth, int maxHeight) const;
+    std::vector<const Pattern*> all() const;
+    size_t size() const { return patterns.size(); }
+
+    // Stamps up to options.count copies of the pattern at random positions and returns how many
+    // were placed; collision-free placement gives up on a copy after a bounded number of tries
+    static int place(Universe& universe, const Pattern& pattern, const PlacementOptions& options);
+
+    static bool parseRle(const std::string& text, std::string& name, BitPattern& cells);
+    static bool parsePlaintext(const std::string& text, std::string& name, BitPattern& cells);
+
+    // Runs the pattern on an empty board and returns the generation at which it reappears,
+    // allowing for movement, or 0 if it does not within maxPeriod generations (as for guns and puffers)
+    static int findPeriod(const BitPattern& cells, int maxPeriod = 60);
+
+private:
+    std::vector<Pattern> patterns;
+    std::map<std::string, size_t> byName;   // Keyed by lower-case name
+    std::multimap<int, size_t> byPeriod;
+    std::multimap<int, size_t> byExtent;    // Keyed by the longer side, for size queries
+};
@@ -0,0 +1,261 @@
+#include "PatternSearch.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <thread>
+
+namespace {
+    // A cell of the template: the grid cell 'row' rows down and 'column' columns right of the
+    // template's top-left corner must be alive or dead
+    struct Condition {
+        int row;
+        int column;
+        bool alive;
+    };
+
+    // A condition resolved against the padded grid: the word holding the condition's column, and
+    // the shift that brings it down to bit 0
+    struct Probe {
+        size_t offset = 0;
+        int shift = 0;
+        std::uint64_t invert = 0;   // All ones for dead conditions
+    };
+
+    struct Template {
+        int symmetry = 0;
+        int width = 0;              // Pattern box, without the border
+        int height = 0;
+        std::vector<Condition> conditions;  // Leading live cell first
+        Probe lead;
+        std::vector<Probe> probes;          // The rest, less those shared by every orientation
+    };
+
+    Template buildTemplate(const BitPattern& oriented, int symmetry, int border) {
+        Template result;
+        result.symmetry = symmetry;
+        result.width = oriented.width;
+        result.height = oriented.height;
+        // Live conditions first: they reject a position far more often than dead ones do
+        for (int y = 0; y < oriented.height; y++) {
+            for (int x = 0; x < oriented.width; x++) {
+                if (oriented.get(x, y)) {
+                    result.conditions.push_back({ y + border, x + border, true });
+                }
+            }
+        }
+        for (int y = -border; y < oriented.height + border; y++) {
+            for (int x = -border; x < oriented.width + border; x++) {
+                bool inside = x >= 0 && x < oriented.width && y >= 0 && y < oriented.height;
+                if (!inside || !oriented.get(x, y)) {
+                    result.conditions.push_back({ y + border, x + border, false });
+                }
+            }
+        }
+        return result;
+    }
+
+    // A copy of the grid shifted 'border' cells right and down, with the cells past its right
+    // and bottom edges filled in (wrapped on a torus, dead otherwise), so every template
+    // condition reads a plain word-aligned window without bounds checks
+    struct PaddedGrid {
+        int wordsPerRow = 0;
+        std::vector<std::uint64_t> words;
+
+        const std::uint64_t* row(int y) const { return &words[static_cast<size_t>(y) * wordsPerRow]; }
+    };
+
+    PaddedGrid padGrid(const GridPlanes& planes, int border, int extraColumns, int extraRows) {
+        PaddedGrid padded;
+        int paddedWidth = planes.width + extraColumns;
+        int paddedHeight = planes.height + extraRows;
+        padded.wordsPerRow = paddedWidth / 64 + 2;
+        padded.words.assign(static_cast<size_t>(padded.wordsPerRow) * paddedHeight, 0);
+
+        std::uint64_t lastWordMask = planes.width % 64 == 0 ? ~0ULL : (1ULL << (planes.width % 64)) - 1;
+        for (int y = 0; y < paddedHeight; y++) {
+            int gridY = y - border;
+            if (planes.toroidal) {
+                gridY = ((gridY % planes.height) + planes.height) % planes.height;
+            }
+            else if (gridY < 0 || gridY >= planes.height) {
+                continue;
+            }
+            const std::uint64_t* source = planes.cells + static_cast<size_t>(gridY) * planes.wordsPerRow;
+            std::uint64_t* target = &padded.words[static_cast<size_t>(y) * padded.wordsPerRow];
+            int sourceWords = (planes.width + 63) / 64;
+            for (int w = 0; w < sourceWords; w++) {
+                std::uint64_t word = w == sourceWords - 1 ? source[w] & lastWordMask : source[w];
+                target[w] |= word << border;
+                if (border > 0) {
+                    target[w + 1] |= word >> (64 - border);
+                }
+            }
+            if (!planes.toroidal) {
+                continue;
+            }
+            // Columns that wrap: the border on the left and everything past the right edge
+            auto wrap = [&](int column) {
+                int gridX = ((column - border) % planes.width + planes.width) % planes.width;
+                if ((source[gridX >> 6] >> (gridX & 63)) & 1ULL) {
+                    target[column >> 6] |= 1ULL << (column & 63);
+                }
+            };
+            for (int column = 0; column < border; column++) {
+                wrap(column);
+            }
+            for (int column = planes.width + border; column < paddedWidth; column++) {
+                wrap(column);
+            }
+        }
+        return padded;
+    }
+
+    // Candidate positions (x, y) for x from 64 * word: bit i survives if every condition holds at
+    // x + i. 'origin' points at that word in the padded row y.
+    inline std::uint64_t testWord(const std::uint64_t* origin, const Probe* probe, const Probe* end, std::uint64_t candidates) {
+        for (; probe != end; ++probe) {
+            const std::uint64_t* row = origin + probe->offset;
+            // Shifting the next word in two steps keeps a shift of 0 from becoming an undefined 64
+            std::uint64_t cells = (row[0] >> probe->shift) | ((row[1] << 1) << (63 - probe->shift));
+            candidates &= cells ^ probe->invert;
+            if (candidates == 0) {
+                break;
+            }
+        }
+        return candidates;
+    }
+
+    template <typename Work>
+    void runParallel(int threadCount, int items, Work work) {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; t++) {
+            threads.emplace_back(work, static_cast<int>(static_cast<long long>(items) * t / threadCount),
+                static_cast<int>(static_cast<long long>(items) * (t + 1) / threadCount));
+        }
+        work(0, static_cast<int>(static_cast<long long>(items) / threadCount));
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+SearchResult PatternSearch::find(const GridPlanes& planes, const BitPattern& pattern, const SearchOptions& options) {
+    auto started = std::chrono::steady_clock::now();
+    SearchResult result;
+    BitPattern trimmed = pattern.trimmed();
+    if (planes.width <= 0 || planes.height <= 0 || trimmed.width == 0) {
+        return result;
+    }
+
+    // Symmetric patterns look the same in several orientations; search each shape once
+    int border = options.isolated ? 1 : 0;
+    std::vector<BitPattern> seen;
+    std::vector<Template> templates;
+    for (int symmetry = 0; symmetry < 8; symmetry++) {
+        if (options.symmetry >= 0 && symmetry != options.symmetry) {
+            continue;
+        }
+        BitPattern oriented = trimmed.transformed(symmetry);
+        if (oriented.width > planes.width || oriented.height > planes.height
+            || std::find(seen.begin(), seen.end(), oriented) != seen.end()) {
+            continue;
+        }
+        templates.push_back(buildTemplate(oriented, symmetry, border));
+        seen.push_back(std::move(oriented));
+    }
+    result.orientations = static_cast<int>(templates.size());
+    if (templates.empty()) {
+        return result;
+    }
+
+    int side = std::max(trimmed.width, trimmed.height) + 2 * border;
+    PaddedGrid grid = padGrid(planes, border, side + 64, side);
+    auto probeFor = [&](const Condition& condition) {
+        return Probe{ static_cast<size_t>(condition.row) * grid.wordsPerRow + (condition.column >> 6),
+            condition.column & 63, condition.alive ? 0 : ~0ULL };
+    };
+    auto sameCondition = [](const Condition& a, const Condition& b) {
+        return a.row == b.row && a.column == b.column && a.alive == b.alive;
+    };
+    auto holds = [&](const Template& shape, const Condition& condition) {
+        return std::any_of(shape.conditions.begin(), shape.conditions.end(), [&](const Condition& c) { return sameCondition(c, condition); });
+    };
+
+    // Each orientation first tests its own leading live cell, which settles most words. The
+    // conditions all orientations have in common, such as the dead border and centre of a
+    // square pattern, are then tested once for all of them before each finishes its own.
+    std::vector<Probe> shared;
+    for (const Condition& condition : templates[0].conditions) {
+        bool common = std::all_of(templates.begin(), templates.end(), [&](const Template& shape) { return holds(shape, condition); });
+        bool leadOfAll = std::all_of(templates.begin(), templates.end(), [&](const Template& shape) { return sameCondition(shape.conditions[0], condition); });
+        if (common && !leadOfAll) {
+            shared.push_back(probeFor(condition));
+        }
+    }
+    for (Template& shape : templates) {
+        shape.lead = probeFor(shape.conditions[0]);
+        for (size_t i = 1; i < shape.conditions.size(); i++) {
+            bool common = std::all_of(templates.begin(), templates.end(), [&](const Template& other) { return holds(other, shape.conditions[i]); });
+            if (!common) {
+                shape.probes.push_back(probeFor(shape.conditions[i]));
+            }
+        }
+    }
+
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    int bandCount = std::max(1, std::min(threads, planes.height / 64));
+    std::vector<std::vector<PatternMatch>> bands(bandCount);
+    int wordsAcross = (planes.width + 63) / 64;
+
+    runParallel(bandCount, bandCount, [&](int firstBand, int endBand) {
+        std::vector<std::uint64_t> candidates(templates.size());
+        for (int band = firstBand; band < endBand; band++) {
+            int firstRow = static_cast<int>(static_cast<long long>(planes.height) * band / bandCount);
+            int endRow = static_cast<int>(static_cast<long long>(planes.height) * (band + 1) / bandCount);
+            for (int y = firstRow; y < endRow; y++) {
+                const std::uint64_t* row = grid.row(y);
+                for (int word = 0; word < wordsAcross; word++) {
+                    std::uint64_t any = 0;
+                    for (size_t t = 0; t < templates.size(); t++) {
+                        const Template& shape = templates[t];
+                        // On a plane the whole box must fit; on a torus it may wrap from any cell
+                        int lastX = planes.toroidal ? planes.width - 1 : planes.width - shape.width;
+                        int valid = std::min(64, lastX - word * 64 + 1);
+                        if (valid <= 0 || (!planes.toroidal && y > planes.height - shape.height)) {
+                            candidates[t] = 0;
+                            continue;
+                        }
+                        candidates[t] = testWord(row + word, &shape.lead, &shape.lead + 1, valid == 64 ? ~0ULL : (1ULL << valid) - 1);
+                        any |= candidates[t];
+                    }
+                    if (any == 0 || (any = testWord(row + word, shared.data(), shared.data() + shared.size(), any)) == 0) {
+                        continue;
+                    }
+                    for (size_t t = 0; t < templates.size(); t++) {
+                        const Template& shape = templates[t];
+                        if ((candidates[t] & any) == 0) {
+                            continue;
+                        }
+                        std::uint64_t found = testWord(row + word, shape.probes.data(), shape.probes.data() + shape.probes.size(), candidates[t] & any);
+                        for (; found; found &= found - 1) {
+                            bands[band].push_back({ word * 64 + std::countr_zero(found), y, shape.width, shape.height, shape.symmetry });
+                        }
+                    }
+                }
+            }
+            // Orientations were searched side by side; put each row's matches in column order
+            std::stable_sort(bands[band].begin(), bands[band].end(), [](const PatternMatch& a, const PatternMatch& b) {
+                return a.y != b.y ? a.y < b.y : a.x < b.x;
+            });
+        }
+    });
+
+    for (std::vector<PatternMatch>& band : bands) {
+        result.matches.insert(result.matches.end(), band.begin(), band.end());
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "BitPattern.h"
+#include "TileStepper.h"
+#include <cstdint>
+#include <vector>
+
+// One occurrence of the pattern. The box is that of the oriented pattern, so on a torus it may
+// wrap around the far edges.
+struct PatternMatch {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int symmetry = 0;           // Which BitPattern::transformed orientation matched
+};
+
+struct SearchOptions {
+    int symmetry = -1;          // 0-7 to look for one orientation only, -1 for all eight
+    bool isolated = true;       // The cells around the pattern's box must be dead too, so a still
+                                // life is not found inside a bigger object
+    int threads = 0;            // 0 for one per hardware thread
+};
+
+struct SearchResult {
+    std::vector<PatternMatch> matches;  // In row order, then column order
+    int orientations = 0;               // Distinct orientations searched; symmetric patterns have fewer
+    double milliseconds = 0;
+};
+
+// Finds every place where the cells of a grid equal a pattern, in any of its orientations.
+//
+// Each orientation becomes a template of cell conditions: alive under the pattern's live
+// cells, dead under the rest of its box and, for isolated matches, its border. The grid is
+// tested 64 positions at a time: a word of candidate bits starts all set, and every condition
+// ANDs in the grid row it refers to, shifted by the condition's column. Live conditions come
+// first because they are the selective ones, and a word is dropped as soon as it runs out of
+// candidates, so empty and unrelated parts of the grid cost a load and a shift per word.
+// Conditions every orientation shares, like the dead border of a square box, are tested once
+// per word for all orientations rather than once for each.
+class PatternSearch {
+public:
+    static SearchResult find(const GridPlanes& planes, const BitPattern& pattern, const SearchOptions& options = SearchOptions());
+};
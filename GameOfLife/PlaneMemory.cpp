@@ -0,0 +1,404 @@
+#include "PlaneMemory.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+const size_t PlaneMemory::HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+namespace {
+    // Upper bound on the pages queryPlacement looks at, so a report stays cheap on huge grids
+    const size_t MAX_PLACEMENT_SAMPLES = 16384;
+
+    inline size_t roundUp(size_t value, size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    struct NumaNode {
+        int id;
+#ifdef _WIN32
+        GROUP_AFFINITY affinity;
+#else
+        std::vector<int> cpus;
+#endif
+    };
+
+#ifndef _WIN32
+    // Parses the kernel's list format, e.g. "0-3,8-11"
+    std::vector<int> parseList(const std::string& text) {
+        std::vector<int> values;
+        size_t position = 0;
+        while (position < text.size()) {
+            int first = 0, last = 0, consumed = 0;
+            if (std::sscanf(text.c_str() + position, "%d%n", &first, &consumed) != 1) {
+                break;
+            }
+            position += consumed;
+            last = first;
+            if (position < text.size() && text[position] == '-') {
+                if (std::sscanf(text.c_str() + position + 1, "%d%n", &last, &consumed) != 1) {
+                    break;
+                }
+                position += consumed + 1;
+            }
+            for (int value = first; value <= last; value++) {
+                values.push_back(value);
+            }
+            if (position < text.size() && text[position] == ',') {
+                position++;
+            }
+            else {
+                break;
+            }
+        }
+        return values;
+    }
+
+    std::string readLine(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+#endif
+
+    std::vector<NumaNode> discoverNodes() {
+        std::vector<NumaNode> nodes;
+#ifdef _WIN32
+        ULONG highest = 0;
+        if (GetNumaHighestNodeNumber(&highest)) {
+            for (ULONG node = 0; node <= highest; node++) {
+                GROUP_AFFINITY affinity{};
+                if (GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) && affinity.Mask != 0) {
+                    nodes.push_back({ static_cast<int>(node), affinity });
+                }
+            }
+        }
+#elif defined(__linux__)
+        for (int node : parseList(readLine("/sys/devices/system/node/online"))) {
+            std::vector<int> cpus = parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+            if (!cpus.empty()) {
+                nodes.push_back({ node, std::move(cpus) });
+            }
+        }
+#endif
+        return nodes;
+    }
+
+    const std::vector<NumaNode>& numaNodes() {
+        static const std::vector<NumaNode> nodes = discoverNodes();
+        return nodes;
+    }
+
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege, which is granted per account and off by default
+    bool largePagesEnabled() {
+        static const bool enabled = [] {
+            HANDLE token;
+            if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+                return false;
+            }
+            TOKEN_PRIVILEGES privileges{};
+            privileges.PrivilegeCount = 1;
+            privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+            // AdjustTokenPrivileges succeeds even when the privilege is not held, so check the last error too
+            bool adjusted = LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+                && AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) && GetLastError() == ERROR_SUCCESS;
+            CloseHandle(token);
+            return adjusted && GetLargePageMinimum() == PlaneMemory::HUGE_PAGE_SIZE;
+        }();
+        return enabled;
+    }
+#elif defined(__linux__)
+    // Bytes of [begin, end) backed by transparent or hugetlbfs pages, from this process's smaps.
+    // Neighbouring mappings may have been merged with the block, so counts are scaled to the overlap.
+    size_t hugePageBytesIn(std::uintptr_t begin, std::uintptr_t end) {
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        size_t total = 0;
+        std::uintptr_t areaBegin = 0, areaEnd = 0;
+        while (std::getline(smaps, line)) {
+            unsigned long first = 0, last = 0;
+            char name[64];
+            size_t kilobytes = 0;
+            if (std::sscanf(line.c_str(), "%lx-%lx ", &first, &last) == 2) {
+                areaBegin = first;
+                areaEnd = last;
+            }
+            else if (areaBegin < end && areaEnd > begin && std::sscanf(line.c_str(), "%63[^:]: %zu kB", name, &kilobytes) == 2) {
+                std::string field = name;
+                if (field == "AnonHugePages" || field == "ShmemPmdMapped" || field == "Shared_Hugetlb" || field == "Private_Hugetlb") {
+                    double overlap = static_cast<double>(std::min(end, areaEnd) - std::max(begin, areaBegin)) / (areaEnd - areaBegin);
+                    total += static_cast<size_t>(kilobytes * 1024 * overlap);
+                }
+            }
+        }
+        return std::min(total, static_cast<size_t>(end - begin));
+    }
+#endif
+}
+
+void* PlaneMemory::allocate(size_t bytes, bool shared, bool firstTouch, bool* hugePages) {
+    size_t size = roundUp(std::max<size_t>(bytes, 1), HUGE_PAGE_SIZE);
+    bool huge = false;
+    void* memory = nullptr;
+#ifdef _WIN32
+    // Threads share the whole address space, so 'shared' needs nothing special here
+    (void)shared;
+    if ((!firstTouch || nodeCount() == 1) && largePagesEnabled()) {
+        memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        huge = memory != nullptr;
+    }
+    if (!memory) {
+        memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+    // hugetlbfs pages are faulted in on first touch like any other, so 'firstTouch' costs nothing here
+    (void)firstTouch;
+    int flags = (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_ANONYMOUS;
+#ifdef MAP_HUGETLB
+    // Only succeeds if the administrator has reserved a pool (vm.nr_hugepages)
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    huge = memory != MAP_FAILED;
+#endif
+    if (!huge) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        // Otherwise ask for transparent huge pages; the kernel may still refuse
+        else {
+            madvise(memory, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+#endif
+    if (hugePages) {
+        *hugePages = huge;
+    }
+    return memory;
+}
+
+void PlaneMemory::release(void* memory, size_t bytes) {
+    if (!memory) {
+        return;
+    }
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, roundUp(std::max<size_t>(bytes, 1), HUGE_PAGE_SIZE));
+#endif
+}
+
+void* PlaneMemory::createShared(const std::string& name, size_t bytes) {
+#ifdef _WIN32
+    (void)name;
+    (void)bytes;
+    return nullptr;
+#else
+    size_t size = roundUp(std::max<size_t>(bytes, 1), HUGE_PAGE_SIZE);
+    int descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    void* memory = ftruncate(descriptor, static_cast<off_t>(size)) == 0
+        ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    close(descriptor);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    // Honoured for shared memory only if the administrator allows it (shmem_enabled)
+    madvise(memory, size, MADV_HUGEPAGE);
+#endif
+    return memory;
+#endif
+}
+
+void* PlaneMemory::openShared(const std::string& name, size_t& bytes) {
+#ifdef _WIN32
+    (void)name;
+    bytes = 0;
+    return nullptr;
+#else
+    bytes = 0;
+    int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    struct stat status;
+    void* memory = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+        memory = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    bytes = static_cast<size_t>(status.st_size);
+    return memory;
+#endif
+}
+
+void PlaneMemory::unlinkShared(const std::string& name) {
+#ifdef _WIN32
+    (void)name;
+#else
+    shm_unlink(name.c_str());
+#endif
+}
+
+int PlaneMemory::nodeCount() {
+    return std::max<int>(1, static_cast<int>(numaNodes().size()));
+}
+
+int PlaneMemory::nodeForWorker(int worker, int workers) {
+    const std::vector<NumaNode>& nodes = numaNodes();
+    if (nodes.empty() || workers <= 0) {
+        return 0;
+    }
+    return nodes[static_cast<size_t>(worker) * nodes.size() / workers].id;
+}
+
+bool PlaneMemory::pinToNode(int node) {
+    for (const NumaNode& candidate : numaNodes()) {
+        if (candidate.id != node) {
+            continue;
+        }
+#ifdef _WIN32
+        return SetThreadGroupAffinity(GetCurrentThread(), &candidate.affinity, nullptr) != 0;
+#elif defined(__linux__)
+        // Stay inside any affinity the process was started with, e.g. by taskset
+        cpu_set_t allowed, pinned;
+        CPU_ZERO(&pinned);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return false;
+        }
+        bool any = false;
+        for (int cpu : candidate.cpus) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                CPU_SET(cpu, &pinned);
+                any = true;
+            }
+        }
+        return any && sched_setaffinity(0, sizeof(pinned), &pinned) == 0;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+PlaneMemory::Placement PlaneMemory::queryPlacement(const void* memory, size_t bytes) {
+    Placement placement;
+    placement.bytes = bytes;
+    if (!memory || bytes == 0) {
+        return placement;
+    }
+
+    // Sample at a whole number of small pages, sized so there are at most MAX_PLACEMENT_SAMPLES
+    const size_t smallPage = 4096;
+    size_t stride = roundUp(std::max(smallPage, (bytes + MAX_PLACEMENT_SAMPLES - 1) / MAX_PLACEMENT_SAMPLES), smallPage);
+    size_t samples = (bytes + stride - 1) / stride;
+    const volatile unsigned char* base = static_cast<const volatile unsigned char*>(memory);
+    auto sampleBytes = [&](size_t sample) {
+        return std::min(stride, bytes - sample * stride);
+    };
+    auto addToNode = [&](int node, size_t count) {
+        if (node >= static_cast<int>(placement.bytesPerNode.size())) {
+            placement.bytesPerNode.resize(node + 1, 0);
+        }
+        placement.bytesPerNode[node] += count;
+        placement.residentBytes += count;
+    };
+
+#ifdef _WIN32
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> pages(samples);
+    for (size_t i = 0; i < samples; i++) {
+        (void)base[i * stride];
+        pages[i].VirtualAddress = const_cast<unsigned char*>(const_cast<const unsigned char*>(base) + i * stride);
+    }
+    if (!QueryWorkingSetEx(GetCurrentProcess(), pages.data(), static_cast<DWORD>(pages.size() * sizeof(pages[0])))) {
+        return placement;
+    }
+    for (size_t i = 0; i < samples; i++) {
+        if (pages[i].VirtualAttributes.Valid) {
+            addToNode(static_cast<int>(pages[i].VirtualAttributes.Node), sampleBytes(i));
+            if (pages[i].VirtualAttributes.LargePage) {
+                placement.hugePageBytes += sampleBytes(i);
+            }
+        }
+    }
+#elif defined(__linux__)
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(memory);
+    placement.hugePageBytes = hugePageBytesIn(begin, begin + bytes);
+
+    // move_pages with no target nodes only reports where each page is; it needs the page to be
+    // mapped here, which for shared memory touched by another process means reading it once
+    std::vector<void*> pages(samples);
+    std::vector<int> status(samples, -1);
+    for (size_t i = 0; i < samples; i++) {
+        (void)base[i * stride];
+        pages[i] = reinterpret_cast<void*>(begin + i * stride);
+    }
+    if (syscall(SYS_move_pages, 0, static_cast<unsigned long>(samples), pages.data(), nullptr, status.data(), 0) != 0) {
+        return placement;  // No NUMA support in the kernel, or not allowed in this container
+    }
+    for (size_t i = 0; i < samples; i++) {
+        if (status[i] >= 0) {
+            addToNode(status[i], sampleBytes(i));
+        }
+    }
+#else
+    (void)base;
+    (void)sampleBytes;
+    (void)addToNode;
+#endif
+    return placement;
+}
+
+std::string PlaneMemory::Placement::describe() const {
+    auto megabytes = [](size_t count) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f MB", count / (1024.0 * 1024.0));
+        return std::string(text);
+    };
+    std::string text = megabytes(bytes);
+    if (bytes > 0) {
+        text += ", " + std::to_string(hugePageBytes * 100 / bytes) + "% on huge pages";
+    }
+    if (bytesPerNode.empty()) {
+        return text + ", node placement unknown";
+    }
+    for (size_t node = 0; node < bytesPerNode.size(); node++) {
+        if (bytesPerNode[node] > 0) {
+            text += ", node " + std::to_string(node) + ": " + megabytes(bytesPerNode[node]);
+        }
+    }
+    if (residentBytes < bytes) {
+        text += ", " + megabytes(bytes - residentBytes) + " not placed";
+    }
+    return text;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Large allocations for the state planes, mapped straight from the OS and backed by 2 MB pages
+// where the system allows it, which saves most of the TLB misses a sweep over a big grid takes.
+//
+// Physical pages are assigned on first write, from the NUMA node of the writing thread, so a
+// parallel engine that wants each worker's rows on the worker's own node pins the workers with
+// pinToNode and lets each one touch its part first. On Windows large pages are committed up
+// front instead, which is why allocate only asks for them when placement is left to the OS.
+class PlaneMemory {
+public:
+    static const size_t HUGE_PAGE_SIZE;
+
+    // Zero-filled memory rounded up to whole huge pages. A 'shared' block stays shared with
+    // forked children. With 'firstTouch' the pages must be placed where they are first written,
+    // even if that costs the huge pages. Returns nullptr if memory runs out.
+    static void* allocate(size_t bytes, bool shared, bool firstTouch, bool* hugePages = nullptr);
+    // 'bytes' is the size given to allocate
+    static void release(void* memory, size_t bytes);
+
+    // Shared memory under a name, for processes started with exec, which cannot inherit an
+    // anonymous mapping. The name starts with '/'. Pages are placed on first touch as with
+    // allocate, on transparent huge pages where the kernel offers them for shared memory. Once
+    // every process has mapped the block, unlinkShared drops the name; the memory itself goes
+    // with the last mapping, which release removes. POSIX only: nullptr on Windows.
+    static void* createShared(const std::string& name, size_t bytes);
+    // Maps a block made by createShared and sets 'bytes' to its size
+    static void* openShared(const std::string& name, size_t& bytes);
+    static void unlinkShared(const std::string& name);
+
+    // NUMA nodes that have processors, at least 1 even when the OS cannot tell
+    static int nodeCount();
+    // Node id for a worker; workers are spread over the nodes in contiguous runs, so
+    // neighbouring subdomains share a node and only those at a run's ends exchange halos across nodes
+    static int nodeForWorker(int worker, int workers);
+    // Restricts the calling thread (a single-threaded worker process on POSIX) to the processors of a node
+    static bool pinToNode(int node);
+
+    // Where the pages of a block ended up
+    struct Placement {
+        size_t bytes = 0;                    // Size of the block
+        size_t residentBytes = 0;            // Bytes whose node is known
+        size_t hugePageBytes = 0;            // Bytes backed by huge pages
+        std::vector<size_t> bytesPerNode;    // Indexed by node id; empty if the OS cannot tell
+        std::string describe() const;
+    };
+    // Samples the block a page at a time (at most a few thousand pages), mapping each sampled
+    // page into this process by reading it; reading never moves a page that is already placed
+    static Placement queryPlacement(const void* memory, size_t bytes);
+};
+
+// Allocator for the plane vectors: blocks of at least a huge page come from PlaneMemory, the
+// rest from the default heap
+template <typename T>
+struct PlaneAllocator {
+    using value_type = T;
+
+    PlaneAllocator() = default;
+    template <typename U>
+    PlaneAllocator(const PlaneAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        size_t bytes = count * sizeof(T);
+        if (bytes < PlaneMemory::HUGE_PAGE_SIZE) {
+            return std::allocator<T>().allocate(count);
+        }
+        void* memory = PlaneMemory::allocate(bytes, false, false);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* memory, size_t count) {
+        size_t bytes = count * sizeof(T);
+        if (bytes < PlaneMemory::HUGE_PAGE_SIZE) {
+            std::allocator<T>().deallocate(memory, count);
+        }
+        else {
+            PlaneMemory::release(memory, bytes);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PlaneAllocator<U>&) const { return true; }
+};
+
+template <typename T>
+using PlaneVector = std::vector<T, PlaneAllocator<T>>;
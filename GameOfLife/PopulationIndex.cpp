@@ -0,0 +1,255 @@
+#include "PopulationIndex.h"
+#include <algorithm>
+#include <bit>
+
+const int PopulationIndex::BLOCK_SIZE = 64;
+
+void PopulationIndex::reset(int universeWidth, int universeHeight) {
+    width = std::max(universeWidth, 0);
+    height = std::max(universeHeight, 0);
+
+    levels.clear();
+    Level blocks;
+    blocks.across = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    blocks.down = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    blocks.counts.assign(static_cast<size_t>(blocks.across) * blocks.down, 0);
+    levels.push_back(std::move(blocks));
+    while (!levels.back().counts.empty() && (levels.back().across > 1 || levels.back().down > 1)) {
+        Level parent;
+        parent.across = (levels.back().across + 1) / 2;
+        parent.down = (levels.back().down + 1) / 2;
+        parent.counts.assign(static_cast<size_t>(parent.across) * parent.down, 0);
+        levels.push_back(std::move(parent));
+    }
+
+    dirty.assign(levels[0].counts.size(), 0);
+    dirtyBlocks.clear();
+    allDirty = true;
+}
+
+long long PopulationIndex::countBlock(const std::uint64_t* cells, int wordsPerRow, int blockX, int blockY) const {
+    // A block is one word wide; bits past the width are always clear in the alive plane
+    long long population = 0;
+    int lastRow = std::min(height, (blockY + 1) * BLOCK_SIZE);
+    for (int y = blockY * BLOCK_SIZE; y < lastRow; y++) {
+        population += std::popcount(cells[static_cast<size_t>(y) * wordsPerRow + blockX]);
+    }
+    return population;
+}
+
+void PopulationIndex::setBlock(int blockX, int blockY, long long population) const {
+    long long delta = population - levels[0].counts[static_cast<size_t>(blockY) * levels[0].across + blockX];
+    if (delta == 0) {
+        return;
+    }
+    for (size_t level = 0; level < levels.size(); level++) {
+        Level& nodes = levels[level];
+        nodes.counts[static_cast<size_t>(blockY >> level) * nodes.across + (blockX >> level)] += delta;
+    }
+}
+
+void PopulationIndex::recount(const std::uint64_t* cells, int wordsPerRow, int x, int y, int regionWidth, int regionHeight) {
+    if (regionWidth <= 0 || regionHeight <= 0 || levels.empty() || levels[0].counts.empty()) {
+        return;
+    }
+    int firstX = std::max(x, 0) / BLOCK_SIZE, lastX = std::min(x + regionWidth, width) - 1;
+    int firstY = std::max(y, 0) / BLOCK_SIZE, lastY = std::min(y + regionHeight, height) - 1;
+    for (int blockY = firstY; blockY <= lastY / BLOCK_SIZE; blockY++) {
+        for (int blockX = firstX; blockX <= lastX / BLOCK_SIZE; blockX++) {
+            setBlock(blockX, blockY, countBlock(cells, wordsPerRow, blockX, blockY));
+            dirty[static_cast<size_t>(blockY) * levels[0].across + blockX] = 0;
+        }
+    }
+}
+
+void PopulationIndex::markDirty(int x, int y, int regionWidth, int regionHeight) {
+    int x0 = std::max(x, 0), x1 = static_cast<int>(std::min<long long>(width, static_cast<long long>(x) + regionWidth));
+    int y0 = std::max(y, 0), y1 = static_cast<int>(std::min<long long>(height, static_cast<long long>(y) + regionHeight));
+    if (allDirty || x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int blockY = y0 / BLOCK_SIZE; blockY <= (y1 - 1) / BLOCK_SIZE; blockY++) {
+        for (int blockX = x0 / BLOCK_SIZE; blockX <= (x1 - 1) / BLOCK_SIZE; blockX++) {
+            size_t index = static_cast<size_t>(blockY) * levels[0].across + blockX;
+            if (!dirty[index]) {
+                dirty[index] = 1;
+                dirtyBlocks.push_back(static_cast<int>(index));
+            }
+        }
+    }
+    // Past a point, recounting everything and rebuilding the levels bottom-up is cheaper
+    if (dirtyBlocks.size() > dirty.size() / 4) {
+        allDirty = true;
+    }
+}
+
+void PopulationIndex::markAllDirty() {
+    allDirty = true;
+}
+
+void PopulationIndex::settle(const std::uint64_t* cells, int wordsPerRow) const {
+    Level& blocks = levels[0];
+    if (allDirty) {
+        for (int blockY = 0; blockY < blocks.down; blockY++) {
+            for (int blockX = 0; blockX < blocks.across; blockX++) {
+                blocks.counts[static_cast<size_t>(blockY) * blocks.across + blockX] = countBlock(cells, wordsPerRow, blockX, blockY);
+            }
+        }
+        for (size_t level = 1; level < levels.size(); level++) {
+            const Level& children = levels[level - 1];
+            Level& nodes = levels[level];
+            std::fill(nodes.counts.begin(), nodes.counts.end(), 0);
+            for (int childY = 0; childY < children.down; childY++) {
+                for (int childX = 0; childX < children.across; childX++) {
+                    nodes.counts[static_cast<size_t>(childY / 2) * nodes.across + childX / 2] +=
+                        children.counts[static_cast<size_t>(childY) * children.across + childX];
+                }
+            }
+        }
+        std::fill(dirty.begin(), dirty.end(), 0);
+        dirtyBlocks.clear();
+        allDirty = false;
+        return;
+    }
+
+    for (int index : dirtyBlocks) {
+        if (dirty[index]) {
+            setBlock(index % blocks.across, index / blocks.across, countBlock(cells, wordsPerRow, index % blocks.across, index / blocks.across));
+            dirty[index] = 0;
+        }
+    }
+    dirtyBlocks.clear();
+}
+
+long long PopulationIndex::population(const std::uint64_t* cells, int wordsPerRow) const {
+    if (levels.empty() || levels[0].counts.empty()) {
+        return 0;
+    }
+    settle(cells, wordsPerRow);
+    return levels.back().counts[0];
+}
+
+long long PopulationIndex::countNode(const std::uint64_t* cells, int wordsPerRow, int level, int nodeX, int nodeY,
+    int x0, int y0, int x1, int y1) const {
+    const Level& nodes = levels[level];
+    long long population = nodes.counts[static_cast<size_t>(nodeY) * nodes.across + nodeX];
+    int size = BLOCK_SIZE << level;
+    int left = nodeX * size, top = nodeY * size;
+    int right = std::min(width, left + size), bottom = std::min(height, top + size);
+    if (population == 0 || right <= x0 || left >= x1 || bottom <= y0 || top >= y1) {
+        return 0;
+    }
+    if (left >= x0 && right <= x1 && top >= y0 && bottom <= y1) {
+        return population;
+    }
+
+    if (level == 0) {
+        // A block cut by the rectangle's edge: mask its columns and count the rows inside
+        int from = std::max(x0, left) - left, to = std::min(x1, right) - left;
+        std::uint64_t mask = (to == 64 ? ~0ULL : (1ULL << to) - 1) & ~((1ULL << from) - 1);
+        long long partial = 0;
+        for (int y = std::max(y0, top); y < std::min(y1, bottom); y++) {
+            partial += std::popcount(cells[static_cast<size_t>(y) * wordsPerRow + nodeX] & mask);
+        }
+        return partial;
+    }
+
+    const Level& children = levels[level - 1];
+    long long partial = 0;
+    for (int childY = nodeY * 2; childY < std::min(nodeY * 2 + 2, children.down); childY++) {
+        for (int childX = nodeX * 2; childX < std::min(nodeX * 2 + 2, children.across); childX++) {
+            partial += countNode(cells, wordsPerRow, level - 1, childX, childY, x0, y0, x1, y1);
+        }
+    }
+    return partial;
+}
+
+long long PopulationIndex::count(const std::uint64_t* cells, int wordsPerRow, int x, int y, int regionWidth, int regionHeight) const {
+    int x0 = std::max(x, 0), x1 = static_cast<int>(std::min<long long>(width, static_cast<long long>(x) + regionWidth));
+    int y0 = std::max(y, 0), y1 = static_cast<int>(std::min<long long>(height, static_cast<long long>(y) + regionHeight));
+    if (levels.empty() || levels[0].counts.empty() || x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+    settle(cells, wordsPerRow);
+    return countNode(cells, wordsPerRow, static_cast<int>(levels.size()) - 1, 0, 0, x0, y0, x1, y1);
+}
+
+template <typename Visit>
+void PopulationIndex::visitOccupied(int level, int nodeX, int nodeY, int x0, int y0, int x1, int y1, Visit& visit) const {
+    const Level& nodes = levels[level];
+    int size = BLOCK_SIZE << level;
+    int left = nodeX * size, top = nodeY * size;
+    if (nodes.counts[static_cast<size_t>(nodeY) * nodes.across + nodeX] == 0
+        || left + size <= x0 || left >= x1 || top + size <= y0 || top >= y1) {
+        return;
+    }
+    if (level == 0) {
+        visit(nodeX, nodeY);
+        return;
+    }
+    const Level& children = levels[level - 1];
+    for (int childY = nodeY * 2; childY < std::min(nodeY * 2 + 2, children.down); childY++) {
+        for (int childX = nodeX * 2; childX < std::min(nodeX * 2 + 2, children.across); childX++) {
+            visitOccupied(level - 1, childX, childY, x0, y0, x1, y1, visit);
+        }
+    }
+}
+
+bool PopulationIndex::bounds(const std::uint64_t* cells, int wordsPerRow, int& x, int& y, int& regionWidth, int& regionHeight) const {
+    if (population(cells, wordsPerRow) == 0) {
+        return false;
+    }
+    int minX = width, minY = height, maxX = -1, maxY = -1;
+    auto visit = [&](int blockX, int blockY) {
+        // Only blocks that could move an edge outwards need their rows read
+        int left = blockX * BLOCK_SIZE, top = blockY * BLOCK_SIZE;
+        if (left >= minX && left + BLOCK_SIZE - 1 <= maxX && top >= minY && top + BLOCK_SIZE - 1 <= maxY) {
+            return;
+        }
+        std::uint64_t columns = 0;
+        for (int row = top; row < std::min(height, top + BLOCK_SIZE); row++) {
+            std::uint64_t word = cells[static_cast<size_t>(row) * wordsPerRow + blockX];
+            if (word) {
+                columns |= word;
+                minY = std::min(minY, row);
+                maxY = std::max(maxY, row);
+            }
+        }
+        minX = std::min(minX, left + std::countr_zero(columns));
+        maxX = std::max(maxX, left + 63 - std::countl_zero(columns));
+    };
+    visitOccupied(static_cast<int>(levels.size()) - 1, 0, 0, 0, 0, width, height, visit);
+
+    x = minX;
+    y = minY;
+    regionWidth = maxX - minX + 1;
+    regionHeight = maxY - minY + 1;
+    return true;
+}
+
+std::vector<PopulationBlock> PopulationIndex::occupiedBlocks(const std::uint64_t* cells, int wordsPerRow,
+    int x, int y, int regionWidth, int regionHeight) const {
+    std::vector<PopulationBlock> blocks;
+    if (regionWidth <= 0) {
+        x = 0;
+        y = 0;
+        regionWidth = width;
+        regionHeight = height;
+    }
+    if (population(cells, wordsPerRow) == 0) {
+        return blocks;
+    }
+    auto visit = [&](int blockX, int blockY) {
+        PopulationBlock block;
+        block.x = blockX * BLOCK_SIZE;
+        block.y = blockY * BLOCK_SIZE;
+        block.width = std::min(BLOCK_SIZE, width - block.x);
+        block.height = std::min(BLOCK_SIZE, height - block.y);
+        block.population = levels[0].counts[static_cast<size_t>(blockY) * levels[0].across + blockX];
+        blocks.push_back(block);
+    };
+    visitOccupied(static_cast<int>(levels.size()) - 1, 0, 0, x, y,
+        static_cast<int>(std::min<long long>(width, static_cast<long long>(x) + regionWidth)),
+        static_cast<int>(std::min<long long>(height, static_cast<long long>(y) + regionHeight)), visit);
+    return blocks;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// A block of the population index: a word-aligned square of BLOCK_SIZE cells, clipped to the universe
+struct PopulationBlock {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    long long population = 0;
+};
+
+// Population pyramid over an alive plane. Level 0 counts the live cells of every 64x64 block;
+// each level above sums 2x2 nodes of the one below, up to a single root. The universe recounts
+// the blocks of every tile as the stepper writes it, while the tile is still in cache, and
+// marks the blocks an edit touches for a lazy recount; a changed count is carried up the
+// levels, so neither costs a pass over the whole pyramid.
+//
+// Queries walk down from the root and never enter an empty node, so their cost follows the
+// live content instead of the area. The planes are passed in rather than held, because the
+// universe swaps them every generation.
+class PopulationIndex {
+public:
+    static const int BLOCK_SIZE;                // Cells along each side of a block, one word wide
+
+    // Sizes the index for a universe and marks every block for recounting
+    void reset(int width, int height);
+
+    // Recounts the blocks overlapping a rectangle right away; the rectangle must be the
+    // whole of the blocks it touches, as stepper tiles are
+    void recount(const std::uint64_t* cells, int wordsPerRow, int x, int y, int regionWidth, int regionHeight);
+    // Marks the blocks overlapping a rectangle, clipped to the universe, for recounting before the next query
+    void markDirty(int x, int y, int regionWidth, int regionHeight);
+    void markAllDirty();
+
+    long long population(const std::uint64_t* cells, int wordsPerRow) const;
+    // Live cells in a rectangle, clipped to the universe. Whole nodes inside it are taken from
+    // the pyramid; only blocks cut by its edges are counted cell by cell.
+    long long count(const std::uint64_t* cells, int wordsPerRow, int x, int y, int regionWidth, int regionHeight) const;
+    // Smallest rectangle holding every live cell; false if there are none
+    bool bounds(const std::uint64_t* cells, int wordsPerRow, int& x, int& y, int& regionWidth, int& regionHeight) const;
+    // Blocks with at least one live cell that overlap a rectangle (the whole universe if its
+    // width is 0), in quadtree order
+    std::vector<PopulationBlock> occupiedBlocks(const std::uint64_t* cells, int wordsPerRow,
+        int x = 0, int y = 0, int regionWidth = 0, int regionHeight = 0) const;
+
+private:
+    struct Level {
+        int across = 0;
+        int down = 0;
+        std::vector<long long> counts;
+    };
+
+    void settle(const std::uint64_t* cells, int wordsPerRow) const;
+    void setBlock(int blockX, int blockY, long long population) const;
+    long long countBlock(const std::uint64_t* cells, int wordsPerRow, int blockX, int blockY) const;
+    long long countNode(const std::uint64_t* cells, int wordsPerRow, int level, int nodeX, int nodeY,
+        int x0, int y0, int x1, int y1) const;
+    template <typename Visit>
+    void visitOccupied(int level, int nodeX, int nodeY, int x0, int y0, int x1, int y1, Visit& visit) const;
+
+    int width = 0;
+    int height = 0;
+    // Queries recount dirty blocks on the way in, so the bookkeeping changes under const
+    mutable std::vector<Level> levels;          // levels[0] holds the blocks, levels.back() the root
+    mutable std::vector<char> dirty;            // Per block
+    mutable std::vector<int> dirtyBlocks;       // Indices of the blocks with 'dirty' set
+    mutable bool allDirty = true;
+};
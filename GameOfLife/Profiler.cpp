@@ -0,0 +1,203 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Hands a buffer to each thread on first use and marks it free again when the thread exits,
+// so short-lived worker threads do not leave a buffer behind each
+struct ThreadBufferLease {
+    Profiler::ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferLease() {
+        if (buffer) {
+            buffer->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : lastSampleTime(now()) {}
+
+std::int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Profiler::phaseName(ProfilePhase phase) {
+    switch (phase) {
+    case ProfilePhase::Step: return "Step";
+    case ProfilePhase::BirthColor: return "Birth colour";
+    case ProfilePhase::Paint: return "Paint";
+    case ProfilePhase::StatusBar: return "Status bar";
+    case ProfilePhase::Save: return "Save";
+    case ProfilePhase::Load: return "Load";
+    default: return "?";
+    }
+}
+
+Profiler::ThreadBuffer& Profiler::localBuffer() {
+    thread_local ThreadBufferLease lease;
+    if (!lease.buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (ThreadBuffer* buffer : buffers) {
+            bool expected = false;
+            if (buffer->inUse.compare_exchange_strong(expected, true)) {
+                lease.buffer = buffer;
+                break;
+            }
+        }
+        if (!lease.buffer) {
+            lease.buffer = new ThreadBuffer();
+            lease.buffer->threadIndex = static_cast<int>(buffers.size()) + 1;
+            lease.buffer->inUse.store(true);
+            buffers.push_back(lease.buffer);
+        }
+    }
+    return *lease.buffer;
+}
+
+void Profiler::record(ProfilePhase phase, std::int64_t startNanoseconds, std::int64_t endNanoseconds) {
+    ThreadBuffer& buffer = localBuffer();
+    int slot = static_cast<int>(phase);
+    std::int64_t duration = endNanoseconds - startNanoseconds;
+
+    // Only this thread writes these, so plain load-and-store is enough
+    buffer.totals[slot].store(buffer.totals[slot].load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+    buffer.calls[slot].store(buffer.calls[slot].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (tracing.load(std::memory_order_relaxed)) {
+        std::int64_t head = buffer.head.load(std::memory_order_relaxed);
+        Event& event = buffer.ring[head & (RING_SIZE - 1)];
+        event.start.store(startNanoseconds, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        event.phase.store(slot, std::memory_order_relaxed);
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+}
+
+void Profiler::count(ProfileCounter counter, std::int64_t amount) {
+    ThreadBuffer& buffer = localBuffer();
+    int slot = static_cast<int>(counter);
+    buffer.counters[slot].store(buffer.counters[slot].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void Profiler::drain() {
+    // Caller holds readerMutex
+    std::vector<ThreadBuffer*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        snapshot = buffers;
+    }
+    for (ThreadBuffer* buffer : snapshot) {
+        std::int64_t head = buffer->head.load(std::memory_order_acquire);
+        std::int64_t from = std::max(buffer->drained, head - RING_SIZE);
+        size_t firstCopied = trace.size();
+        for (std::int64_t i = from; i < head; i++) {
+            const Event& event = buffer->ring[i & (RING_SIZE - 1)];
+            trace.push_back({ event.start.load(std::memory_order_relaxed), event.duration.load(std::memory_order_relaxed),
+                event.phase.load(std::memory_order_relaxed), buffer->threadIndex });
+        }
+
+        // Anything the writer lapped while we were copying may be torn; drop it
+        std::int64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        std::int64_t overwritten = std::max<std::int64_t>(0, headAfter - RING_SIZE - from);
+        overwritten = std::min<std::int64_t>(overwritten, head - from);
+        trace.erase(trace.begin() + firstCopied, trace.begin() + firstCopied + overwritten);
+        droppedEvents += (from - buffer->drained) + overwritten;
+        buffer->drained = head;
+    }
+}
+
+ProfileSample Profiler::sample() {
+    std::lock_guard<std::mutex> reader(readerMutex);
+    ProfileSample result;
+    std::int64_t time = now();
+    result.seconds = (time - lastSampleTime) / 1e9;
+
+    std::int64_t totals[static_cast<int>(ProfilePhase::Count)] = {};
+    std::int64_t calls[static_cast<int>(ProfilePhase::Count)] = {};
+    std::int64_t generations = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (ThreadBuffer* buffer : buffers) {
+            for (int i = 0; i < static_cast<int>(ProfilePhase::Count); i++) {
+                totals[i] += buffer->totals[i].load(std::memory_order_relaxed);
+                calls[i] += buffer->calls[i].load(std::memory_order_relaxed);
+            }
+            generations += buffer->counters[static_cast<int>(ProfileCounter::Generations)].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(ProfilePhase::Count); i++) {
+        result.phases[i].milliseconds = (totals[i] - lastTotals[i]) / 1e6;
+        result.phases[i].calls = calls[i] - lastCalls[i];
+        lastTotals[i] = totals[i];
+        lastCalls[i] = calls[i];
+    }
+    result.generationsPerSecond = result.seconds > 0 ? (generations - lastGenerations) / result.seconds : 0;
+    lastGenerations = generations;
+    lastSampleTime = time;
+
+    if (tracing.load(std::memory_order_relaxed)) {
+        drain();
+        trace.push_back({ time, static_cast<std::int64_t>(result.generationsPerSecond), -1, 0 });
+    }
+    return result;
+}
+
+bool Profiler::startTrace(const std::string& path) {
+    std::lock_guard<std::mutex> reader(readerMutex);
+    std::FILE* probe = std::fopen(path.c_str(), "wb");
+    if (!probe) {
+        return false;
+    }
+    std::fclose(probe);
+
+    // Skip whatever the rings hold from before
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (ThreadBuffer* buffer : buffers) {
+            buffer->drained = buffer->head.load(std::memory_order_acquire);
+        }
+    }
+    tracePath = path;
+    trace.clear();
+    droppedEvents = 0;
+    traceStart = now();
+    tracing.store(true);
+    return true;
+}
+
+bool Profiler::stopTrace() {
+    std::lock_guard<std::mutex> reader(readerMutex);
+    if (!tracing.exchange(false)) {
+        return false;
+    }
+    drain();
+
+    std::FILE* file = std::fopen(tracePath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    // Timestamps in the trace_event format are microseconds
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GameOfLife\"}}");
+    for (const TraceEvent& event : trace) {
+        double timestamp = (event.start - traceStart) / 1e3;
+        if (event.phase < 0) {
+            std::fprintf(file, ",\n{\"name\":\"Generations/s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":0,\"args\":{\"value\":%lld}}",
+                timestamp, static_cast<long long>(event.duration));
+        }
+        else {
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                phaseName(static_cast<ProfilePhase>(event.phase)), timestamp, event.duration / 1e3, event.threadIndex);
+        }
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%lld}}\n", static_cast<long long>(droppedEvents));
+    bool ok = std::fclose(file) == 0;
+    trace.clear();
+    trace.shrink_to_fit();
+    return ok;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Phases of the program worth timing; each gets a fixed slot so recording never looks anything up
+enum class ProfilePhase {
+    Step,           // Advancing the universe
+    BirthColor,     // Universe::determineBirthColor
+    Paint,          // OnPaint
+    StatusBar,      // UpdateStatusBar
+    Save,
+    Load,
+    Count
+};
+
+enum class ProfileCounter {
+    Generations,
+    Count
+};
+
+struct PhaseStats {
+    double milliseconds = 0;    // Time spent in the phase during the sample
+    std::int64_t calls = 0;
+};
+
+struct ProfileSample {
+    double seconds = 0;         // Length of the sample
+    PhaseStats phases[static_cast<int>(ProfilePhase::Count)];
+    double generationsPerSecond = 0;
+};
+
+// Collects per-phase timings from any thread. Every thread writes only to its own buffer: running
+// totals per phase and counter, and, while a trace is being recorded, a ring of individual events.
+// The reader (the UI) sums the totals and drains the rings, so recording takes no locks.
+class Profiler {
+public:
+    static Profiler& instance();
+
+    void record(ProfilePhase phase, std::int64_t startNanoseconds, std::int64_t endNanoseconds);
+    void count(ProfileCounter counter, std::int64_t amount);
+
+    // Totals since the previous sample; also moves recorded events into the trace
+    ProfileSample sample();
+
+    // Records every timed event until stopTrace writes them as Chrome trace_event JSON,
+    // which chrome://tracing, Perfetto and speedscope can open
+    bool startTrace(const std::string& path);
+    bool stopTrace();
+    bool isTracing() const { return tracing.load(std::memory_order_relaxed); }
+
+    static const char* phaseName(ProfilePhase phase);
+    static std::int64_t now();
+
+private:
+    static const int RING_SIZE = 1 << 16;   // Events a thread can record between drains
+
+    struct Event {
+        std::atomic<std::int64_t> start{ 0 };
+        std::atomic<std::int64_t> duration{ 0 };
+        std::atomic<int> phase{ 0 };
+    };
+
+    struct ThreadBuffer {
+        int threadIndex = 0;
+        std::atomic<bool> inUse{ false };
+        std::atomic<std::int64_t> totals[static_cast<int>(ProfilePhase::Count)] = {};
+        std::atomic<std::int64_t> calls[static_cast<int>(ProfilePhase::Count)] = {};
+        std::atomic<std::int64_t> counters[static_cast<int>(ProfileCounter::Count)] = {};
+        std::atomic<std::int64_t> head{ 0 };    // Events written so far
+        std::int64_t drained = 0;               // Events already moved to the trace (reader only)
+        std::vector<Event> ring = std::vector<Event>(RING_SIZE);
+    };
+
+    struct TraceEvent {
+        std::int64_t start;
+        std::int64_t duration;
+        int phase;              // -1 for a counter sample, with the value in duration
+        int threadIndex;
+    };
+
+    Profiler();
+    ThreadBuffer& localBuffer();
+    void drain();
+    friend struct ThreadBufferLease;
+
+    std::atomic<bool> tracing{ false };
+    std::mutex buffersMutex;                    // Guards the list when a thread first records
+    std::vector<ThreadBuffer*> buffers;         // Never freed; reused after their thread exits
+
+    std::mutex readerMutex;                     // Guards everything below
+    std::int64_t lastSampleTime;
+    std::int64_t lastTotals[static_cast<int>(ProfilePhase::Count)] = {};
+    std::int64_t lastCalls[static_cast<int>(ProfilePhase::Count)] = {};
+    std::int64_t lastGenerations = 0;
+    std::int64_t traceStart = 0;
+    std::int64_t droppedEvents = 0;
+    std::string tracePath;
+    std::vector<TraceEvent> trace;
+};
+
+// Times the enclosing scope as one event of the given phase
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfilePhase phase) : phase(phase), start(Profiler::now()) {}
+    ~ScopedTimer() { Profiler::instance().record(phase, start, Profiler::now()); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ProfilePhase phase;
+    std::int64_t start;
+};
+
+// Instrumentation compiles away entirely unless GOL_PROFILING is defined (it is in Debug builds)
+#ifdef GOL_PROFILING
+#define GOL_PROFILE_JOIN2(a, b) a##b
+#define GOL_PROFILE_JOIN(a, b) GOL_PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(phase) ScopedTimer GOL_PROFILE_JOIN(profileScope, __LINE__)(phase)
+#define PROFILE_COUNT(counter, amount) Profiler::instance().count(counter, amount)
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+#endif
@@ -0,0 +1,347 @@
+#include "RunRecording.h"
+#include "BitPattern.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Frames queued for the writer; at a few hundred KiB per delta this rides out long disk stalls
+    const size_t WRITE_QUEUE_CAPACITY = 256;
+    const size_t RULE_BYTES = 24;
+
+    void putU32(std::vector<unsigned char>& out, std::uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    void putU64(std::vector<unsigned char>& out, std::uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    std::uint32_t getU32(const unsigned char* data) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<std::uint32_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t getU64(const unsigned char* data) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    bool seekTo(std::FILE* file, std::uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    std::uint64_t fileSizeOf(std::FILE* file) {
+#ifdef _WIN32
+        _fseeki64(file, 0, SEEK_END);
+        return static_cast<std::uint64_t>(_ftelli64(file));
+#else
+        fseeko(file, 0, SEEK_END);
+        return static_cast<std::uint64_t>(ftello(file));
+#endif
+    }
+}
+
+const int RunRecorder::DEFAULT_KEYFRAME_INTERVAL = 256;
+
+RunRecorder::~RunRecorder() {
+    stop();
+}
+
+bool RunRecorder::start(const std::string& filePath, Universe& universe, std::int64_t generation, int interval) {
+    stop();
+
+    file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    path = filePath;
+    firstPath = filePath;
+    part = 1;
+    // The writer issues large sequential writes; a bigger stdio buffer halves the syscalls
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    GridPlanes planes = universe.getPlanes();
+    std::vector<unsigned char> header;
+    putU32(header, RECORDING_MAGIC);
+    putU32(header, RECORDING_VERSION);
+    putU32(header, static_cast<std::uint32_t>(planes.width));
+    putU32(header, static_cast<std::uint32_t>(planes.height));
+    putU32(header, static_cast<std::uint32_t>(std::max(interval, 1)));
+    putU32(header, planes.toroidal ? 1u : 0u);
+    std::string rule = universe.getRule().toString();
+    rule.resize(RULE_BYTES, '\0');
+    header.insert(header.end(), rule.begin(), rule.begin() + RULE_BYTES);
+
+    keyframeInterval = std::max(interval, 1);
+    keyframes.clear();
+    failed = false;
+    framesRecorded = 0;
+    bytesQueued = 0;
+    lastGeneration = -1;
+    encoder.reset(FrameRegion{}, 0, 0);
+    encoder.invalidate();
+
+    queue = std::make_unique<BoundedQueue<std::vector<unsigned char>>>(WRITE_QUEUE_CAPACITY);
+    writer = std::thread(&RunRecorder::writeFrames, this);
+    bytesQueued = header.size();
+    queue->push(std::move(header));
+
+    record(planes, generation);
+    return true;
+}
+
+void RunRecorder::record(const GridPlanes& planes, std::int64_t generation) {
+    if (!file || generation <= lastGeneration) {
+        return;
+    }
+
+    bool keyframe = keyframes.empty() || generation - lastKeyframe >= keyframeInterval;
+    std::vector<unsigned char> frame;
+    encoder.encode(planes.cells, planes.width, planes.height, planes.wordsPerRow, generation, keyframe, frame);
+    // The encoder also falls back to a keyframe when the universe was resized
+    if (frame.size() > 4 && static_cast<FrameType>(frame[4]) == FrameType::Keyframe) {
+        keyframes.push_back(RecordingKeyframe{ generation, bytesQueued });
+        lastKeyframe = generation;
+    }
+
+    bytesQueued += frame.size();
+    lastGeneration = generation;
+    framesRecorded++;
+    queue->push(std::move(frame));
+}
+
+bool RunRecorder::restart(Universe& universe, std::int64_t generation) {
+    if (!file) {
+        return false;
+    }
+    std::string first = firstPath;
+    int nextPart = part + 1;
+    int interval = keyframeInterval;
+    bool finished = stop();
+
+    // The part number goes before the extension, if the name has one
+    size_t slash = first.find_last_of("/\\");
+    size_t dot = first.find_last_of('.');
+    size_t stemEnd = dot != std::string::npos && (slash == std::string::npos || dot > slash) ? dot : first.size();
+    std::string partPath = first.substr(0, stemEnd) + "-" + std::to_string(nextPart) + first.substr(stemEnd);
+    if (!start(partPath, universe, generation, interval)) {
+        return false;
+    }
+    firstPath = first;
+    part = nextPart;
+    return finished;
+}
+
+bool RunRecorder::stop() {
+    if (!file) {
+        return true;
+    }
+
+    // The index goes through the queue too, so it lands after every frame
+    std::vector<unsigned char> index;
+    putU32(index, RECORDING_INDEX_MAGIC);
+    putU32(index, static_cast<std::uint32_t>(keyframes.size()));
+    for (const RecordingKeyframe& keyframe : keyframes) {
+        putU64(index, static_cast<std::uint64_t>(keyframe.generation));
+        putU64(index, keyframe.offset);
+    }
+    putU64(index, bytesQueued);
+    putU32(index, RECORDING_INDEX_MAGIC);
+    queue->push(std::move(index));
+
+    queue->close();
+    writer.join();
+    queue.reset();
+
+    bool ok = !failed && std::fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
+
+void RunRecorder::writeFrames() {
+    std::vector<unsigned char> data;
+    while (queue->pop(data)) {
+        if (!failed && std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+            // Keep draining so the step thread never blocks on a dead disk
+            failed = true;
+        }
+    }
+    if (!failed && std::fflush(file) != 0) {
+        failed = true;
+    }
+}
+
+RunPlayer::~RunPlayer() {
+    close();
+}
+
+bool RunPlayer::open(const std::string& recordingPath) {
+    close();
+
+    file = std::fopen(recordingPath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    unsigned char header[RECORDING_HEADER_BYTES];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)
+        || getU32(header) != RECORDING_MAGIC || getU32(header + 4) != RECORDING_VERSION) {
+        close();
+        return false;
+    }
+    toroidal = (getU32(header + 20) & 1) != 0;
+    const char* ruleText = reinterpret_cast<const char*>(header + 24);
+    rule.assign(ruleText, strnlen(ruleText, RULE_BYTES));
+    path = recordingPath;
+
+    // Trailer: u64 indexOffset, u32 magic; the index it points at opens with the magic too
+    std::uint64_t fileSize = fileSizeOf(file);
+    unsigned char trailer[12];
+    bool indexed = false;
+    if (fileSize >= RECORDING_HEADER_BYTES + sizeof(trailer) && seekTo(file, fileSize - sizeof(trailer))
+        && std::fread(trailer, 1, sizeof(trailer), file) == sizeof(trailer) && getU32(trailer + 8) == RECORDING_INDEX_MAGIC) {
+        std::uint64_t indexOffset = getU64(trailer);
+        unsigned char counts[8];
+        if (indexOffset >= RECORDING_HEADER_BYTES && indexOffset + sizeof(counts) <= fileSize - sizeof(trailer)
+            && seekTo(file, indexOffset) && std::fread(counts, 1, sizeof(counts), file) == sizeof(counts)
+            && getU32(counts) == RECORDING_INDEX_MAGIC) {
+            std::uint32_t count = getU32(counts + 4);
+            std::vector<unsigned char> entries(static_cast<size_t>(count) * 16);
+            if (indexOffset + sizeof(counts) + entries.size() + sizeof(trailer) == fileSize
+                && std::fread(entries.data(), 1, entries.size(), file) == entries.size()) {
+                for (std::uint32_t i = 0; i < count; i++) {
+                    keyframes.push_back(RecordingKeyframe{ static_cast<std::int64_t>(getU64(&entries[i * 16])), getU64(&entries[i * 16 + 8]) });
+                }
+                framesEnd = indexOffset;
+                indexed = !keyframes.empty();
+            }
+        }
+    }
+    if (!indexed && !rebuildIndex(fileSize)) {
+        close();
+        return false;
+    }
+
+    // The last generation is in the header of the last frame, found by walking from the last keyframe
+    FrameHeader frameHeader;
+    std::uint64_t offset = keyframes.back().offset;
+    while (offset < framesEnd && readFrame(offset, buffer) && TileFrameDecoder::readHeader(buffer.data(), buffer.size(), frameHeader)) {
+        lastGeneration = frameHeader.generation;
+        offset += buffer.size();
+    }
+    return true;
+}
+
+void RunPlayer::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    path.clear();
+    rule.clear();
+    keyframes.clear();
+    framesEnd = 0;
+    lastGeneration = 0;
+    positioned = false;
+}
+
+bool RunPlayer::rebuildIndex(std::uint64_t fileSize) {
+    // The recording was cut off before its index was written; walk the frames and stop at
+    // the first one that is incomplete
+    keyframes.clear();
+    std::uint64_t offset = RECORDING_HEADER_BYTES;
+    unsigned char data[FRAME_HEADER_BYTES];
+    FrameHeader header;
+    while (offset + FRAME_HEADER_BYTES <= fileSize && seekTo(file, offset)
+        && std::fread(data, 1, sizeof(data), file) == sizeof(data) && TileFrameDecoder::readHeader(data, sizeof(data), header)) {
+        std::uint64_t size = TileFrameDecoder::frameSize(header);
+        if (offset + size > fileSize) {
+            break;
+        }
+        if (header.type == FrameType::Keyframe) {
+            keyframes.push_back(RecordingKeyframe{ header.generation, offset });
+        }
+        offset += size;
+    }
+    framesEnd = offset;
+    return !keyframes.empty();
+}
+
+bool RunPlayer::readFrame(std::uint64_t offset, std::vector<unsigned char>& frame) {
+    FrameHeader header;
+    frame.resize(FRAME_HEADER_BYTES);
+    if (offset + FRAME_HEADER_BYTES > framesEnd || !seekTo(file, offset)
+        || std::fread(frame.data(), 1, FRAME_HEADER_BYTES, file) != FRAME_HEADER_BYTES
+        || !TileFrameDecoder::readHeader(frame.data(), frame.size(), header)) {
+        return false;
+    }
+    size_t size = TileFrameDecoder::frameSize(header);
+    if (offset + size > framesEnd) {
+        return false;
+    }
+    frame.resize(size);
+    return std::fread(frame.data() + FRAME_HEADER_BYTES, 1, size - FRAME_HEADER_BYTES, file) == size - FRAME_HEADER_BYTES;
+}
+
+std::int64_t RunPlayer::seek(std::int64_t generation, Universe& target, std::uint32_t color) {
+    if (!file) {
+        return -1;
+    }
+
+    // Latest keyframe at or before the generation, or the first one if it lies before the recording
+    auto after = std::upper_bound(keyframes.begin(), keyframes.end(), generation,
+        [](std::int64_t wanted, const RecordingKeyframe& keyframe) { return wanted < keyframe.generation; });
+    const RecordingKeyframe& keyframe = after == keyframes.begin() ? keyframes.front() : *(after - 1);
+
+    // Playing forward continues from where the decoder already is instead of going back
+    bool resume = positioned && decoder.getGeneration() >= keyframe.generation && decoder.getGeneration() <= generation;
+    std::uint64_t offset = resume ? position : keyframe.offset;
+    if (!resume) {
+        positioned = false;
+    }
+
+    FrameHeader header;
+    while (offset < framesEnd) {
+        if (!readFrame(offset, buffer) || !TileFrameDecoder::readHeader(buffer.data(), buffer.size(), header)) {
+            positioned = false;
+            return -1;
+        }
+        if (positioned && header.generation > generation) {
+            break;
+        }
+        if (!decoder.apply(buffer.data(), buffer.size())) {
+            positioned = false;
+            return -1;
+        }
+        positioned = true;
+        offset += buffer.size();
+        position = offset;
+    }
+    if (!positioned) {
+        return -1;
+    }
+
+    int width = decoder.getUniverseWidth(), height = decoder.getUniverseHeight();
+    if (target.getWidth() != width || target.getHeight() != height) {
+        target.resize(width, height);
+    }
+    BitPattern pattern(width, height);
+    decoder.extract(pattern.rows.data(), pattern.wordsPerRow);
+    target.stamp(pattern, 0, 0, color, true);
+    target.setToroidal(toroidal);
+    return decoder.getGeneration();
+}
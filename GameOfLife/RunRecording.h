@@ -0,0 +1,137 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "FrameCodec.h"
+#include "Universe.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Recordings (.golrec) archive a run generation by generation as the same tile frames the
+// frame server streams: a keyframe every few hundred generations and delta frames carrying
+// only the 64x64 tiles that changed in between. A seek index of the keyframes is appended
+// when the recording is closed, so a player can jump to any generation by decoding forward
+// from the nearest keyframe before it.
+//
+// File layout (little-endian):
+//   u32 magic, u32 version, i32 width, i32 height, u32 keyframeInterval, u32 flags (bit 0: toroidal),
+//   char rule[24] (NUL-padded B/S notation),
+//   frames as described in FrameCodec.h, back to back,
+//   u32 indexMagic, u32 keyframeCount, keyframeCount x { i64 generation, u64 offset },
+//   u64 indexOffset, u32 indexMagic
+// A recording cut short before its index is written can still be played; the index is then
+// rebuilt by walking the frame headers.
+//
+// Only the alive plane is recorded.
+
+static const std::uint32_t RECORDING_MAGIC = 0x52434F47;        // "GOCR"
+static const std::uint32_t RECORDING_INDEX_MAGIC = 0x58444E49;  // "INDX"
+static const std::uint32_t RECORDING_VERSION = 1;
+static const size_t RECORDING_HEADER_BYTES = 6 * 4 + 24;
+
+struct RecordingKeyframe {
+    std::int64_t generation = 0;
+    std::uint64_t offset = 0;   // Byte offset of the keyframe in the file
+};
+
+// Encodes generations on the thread that steps the universe and writes them on its own
+// thread, so the step thread only pays for the delta scan. The queue between the two is
+// deep enough to ride out disk stalls; only a disk that stays slower than the simulation
+// eventually holds the stepping back.
+class RunRecorder {
+public:
+    static const int DEFAULT_KEYFRAME_INTERVAL;
+
+    RunRecorder() = default;
+    ~RunRecorder();
+
+    RunRecorder(const RunRecorder&) = delete;
+    RunRecorder& operator=(const RunRecorder&) = delete;
+
+    // Creates the file and records 'universe' as the first keyframe; false if the file cannot be created
+    bool start(const std::string& path, Universe& universe, std::int64_t generation, int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Appends a generation; ignored unless recording or if 'generation' is not past the last one
+    void record(const GridPlanes& planes, std::int64_t generation);
+
+    // A file's generations must increase, so a run that went back (a seek) is finished here and
+    // carries on from a keyframe of 'universe' in a new file beside it: run.golrec, then
+    // run-2.golrec, run-3.golrec and so on. False if either file failed; recording stops only if
+    // the new one could not be created.
+    bool restart(Universe& universe, std::int64_t generation);
+
+    // Writes what is queued plus the seek index and closes the file; false if any write failed
+    bool stop();
+
+    bool isRecording() const { return file != nullptr; }
+    std::int64_t getFramesRecorded() const { return framesRecorded; }
+    std::int64_t getLastGeneration() const { return lastGeneration; }
+    const std::string& getPath() const { return path; }
+    std::uint64_t getBytesRecorded() const { return bytesQueued; }
+
+private:
+    void writeFrames();
+
+    std::FILE* file = nullptr;
+    std::string path;
+    std::string firstPath;                      // The path given to start(), which later parts are named after
+    int part = 1;
+    std::unique_ptr<BoundedQueue<std::vector<unsigned char>>> queue;
+    std::thread writer;
+    std::atomic<bool> failed{ false };
+
+    TileFrameEncoder encoder;
+    int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL;
+    std::int64_t lastGeneration = -1;
+    std::int64_t lastKeyframe = 0;
+    std::int64_t framesRecorded = 0;
+    std::uint64_t bytesQueued = 0;              // Offset the next frame will be written at
+    std::vector<RecordingKeyframe> keyframes;
+};
+
+// Reads a recording back and reconstructs any generation in it
+class RunPlayer {
+public:
+    RunPlayer() = default;
+    ~RunPlayer();
+
+    RunPlayer(const RunPlayer&) = delete;
+    RunPlayer& operator=(const RunPlayer&) = delete;
+
+    // Opens a recording and loads or rebuilds its seek index; false if it is not a recording
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+    const std::string& getPath() const { return path; }
+
+    std::int64_t getFirstGeneration() const { return keyframes.empty() ? 0 : keyframes.front().generation; }
+    std::int64_t getLastGeneration() const { return lastGeneration; }
+    const std::string& getRule() const { return rule; }
+    bool getToroidal() const { return toroidal; }
+
+    // Loads the latest recorded generation at or before 'generation' into 'target' (resizing it),
+    // decoding forward from the keyframe before it, or from the current position if that is
+    // closer. Live cells take the given colour. Returns the generation reached, or -1 on a read error.
+    std::int64_t seek(std::int64_t generation, Universe& target, std::uint32_t color);
+
+private:
+    bool readFrame(std::uint64_t offset, std::vector<unsigned char>& frame);
+    bool rebuildIndex(std::uint64_t fileSize);
+
+    std::FILE* file = nullptr;
+    std::string path;
+    std::string rule;
+    bool toroidal = false;
+    std::uint64_t framesEnd = 0;                // Where the frames stop and the index begins
+    std::int64_t lastGeneration = 0;
+    std::vector<RecordingKeyframe> keyframes;
+
+    TileFrameDecoder decoder;
+    std::uint64_t position = 0;                 // Offset of the frame after the one last applied
+    bool positioned = false;                    // 'decoder' holds the frame just before 'position'
+    std::vector<unsigned char> buffer;
+};
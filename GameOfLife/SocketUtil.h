@@ -0,0 +1,84 @@
+#pragma once
+
+// Minimal portability layer over BSD sockets and Winsock for the local frame stream
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef SOCKET socket_t;
+static const socket_t INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+typedef int socket_t;
+static const socket_t INVALID_SOCKET_HANDLE = -1;
+#endif
+
+// Initialises the socket library once per process (a no-op outside Windows)
+inline bool initSockets() {
+#ifdef _WIN32
+    static bool initialized = false;
+    if (!initialized) {
+        WSADATA data;
+        initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return initialized;
+#else
+    return true;
+#endif
+}
+
+inline void closeSocket(socket_t socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+inline bool setNonBlocking(socket_t socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// True when the last socket call failed only because it would have blocked
+inline bool socketWouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+// Sends without raising SIGPIPE when the peer has gone away
+inline int sendBytes(socket_t socket, const unsigned char* data, size_t size) {
+#ifdef _WIN32
+    return send(socket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0);
+#elif defined(MSG_NOSIGNAL)
+    return static_cast<int>(send(socket, data, size, MSG_NOSIGNAL));
+#else
+    return static_cast<int>(send(socket, data, size, 0));
+#endif
+}
+
+inline int receiveBytes(socket_t socket, unsigned char* data, size_t size) {
+#ifdef _WIN32
+    return recv(socket, reinterpret_cast<char*>(data), static_cast<int>(size), 0);
+#else
+    return static_cast<int>(recv(socket, data, size, 0));
+#endif
+}
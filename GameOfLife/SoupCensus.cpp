@@ -0,0 +1,311 @@
+#include "SoupCensus.h"
+#include "ObjectCatalog.h"
+#include "TileStepper.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    std::int64_t nowNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline std::uint64_t splitMix64(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Takes the 8-connected object holding (x, y), already cleared, out of 'remaining'
+    void floodObject(SoupCensus::Board& remaining, int x, int y, std::vector<std::pair<int, int>>& stack,
+        std::vector<std::pair<int, int>>& cells) {
+        stack.assign(1, { x, y });
+        cells.clear();
+        while (!stack.empty()) {
+            auto cell = stack.back();
+            stack.pop_back();
+            cells.push_back(cell);
+            for (int dy = -1; dy <= 1; dy++) {
+                int ny = cell.second + dy;
+                if (ny < 0 || ny >= 64) {
+                    continue;
+                }
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = cell.first + dx;
+                    if (nx >= 0 && nx < 64 && ((remaining[ny] >> nx) & 1ULL)) {
+                        remaining[ny] &= ~(1ULL << nx);
+                        stack.push_back({ nx, ny });
+                    }
+                }
+            }
+        }
+    }
+
+    const char* const LOG_COLUMNS = "soup,seed,lifespan,period,population,objects,escaped";
+
+    std::uint64_t hashBoard(const SoupCensus::Board& board) {
+        std::uint64_t hash = 0x84222325CBF29CE4ULL;
+        for (std::uint64_t row : board) {
+            hash = (hash ^ row) * 0x100000001B3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+}
+
+const int SoupCensus::EDGE_MARGIN = 4;
+
+SoupCensus::~SoupCensus() {
+    cancel();
+}
+
+SoupCensus::Board SoupCensus::makeSoup(std::uint64_t seed, std::int64_t index, int soupSize) {
+    soupSize = std::clamp(soupSize, 1, 64);
+    std::uint64_t state = seed ^ (static_cast<std::uint64_t>(index) * 0xD1B54A32D192ED03ULL);
+    std::uint64_t rowMask = soupSize == 64 ? ~0ULL : (1ULL << soupSize) - 1;
+    int offset = (64 - soupSize) / 2;
+
+    Board board{};
+    for (int y = 0; y < soupSize; y++) {
+        board[offset + y] = (splitMix64(state) & rowMask) << offset;
+    }
+    return board;
+}
+
+SoupCensus::Board SoupCensus::step(const Board& board) {
+    // Cells beyond the board's edges are dead
+    Board next;
+    for (int y = 0; y < 64; y++) {
+        std::uint64_t above = y > 0 ? board[y - 1] : 0;
+        std::uint64_t row = board[y];
+        std::uint64_t below = y < 63 ? board[y + 1] : 0;
+        next[y] = TileStepper::nextWord(above << 1, above, above >> 1, row << 1, row, row >> 1, below << 1, below, below >> 1);
+    }
+    return next;
+}
+
+SoupResult SoupCensus::runSoup(Board board, int maxGenerations) {
+    SoupResult result;
+    std::unordered_map<std::uint64_t, int> seen;
+    seen.reserve(1024);
+
+    for (int generation = 0; generation <= maxGenerations; generation++) {
+        auto inserted = seen.emplace(hashBoard(board), generation);
+        if (!inserted.second) {
+            // The state repeated: it entered its final cycle when first seen
+            result.lifespan = inserted.first->second;
+            result.period = generation - inserted.first->second;
+            break;
+        }
+        board = step(board);
+        removeEscaping(board, result.escaped);
+    }
+
+    for (std::uint64_t row : board) {
+        result.population += std::popcount(row);
+    }
+    result.objects = takeCensus(board);
+    return result;
+}
+
+std::map<std::string, int> SoupCensus::takeCensus(const Board& board) {
+    std::map<std::string, int> census;
+    Board remaining = board;
+    std::vector<std::pair<int, int>> stack;
+    std::vector<std::pair<int, int>> cells;
+
+    for (int y = 0; y < 64; y++) {
+        while (remaining[y]) {
+            // Flood-fill one 8-connected object
+            int x = std::countr_zero(remaining[y]);
+            remaining[y] &= remaining[y] - 1;
+            floodObject(remaining, x, y, stack, cells);
+
+            const CatalogEntry* known = ObjectCatalog::find(ObjectCatalog::canonicalHash(cells));
+            if (known) {
+                census[known->name]++;
+            }
+            else {
+                census["other" + std::to_string(cells.size())]++;
+            }
+        }
+    }
+    return census;
+}
+
+void SoupCensus::removeEscaping(Board& board, std::map<std::string, int>& escaped) {
+    // Most generations nothing is near the edge, which a few row tests show
+    const std::uint64_t edgeColumns = ((1ULL << EDGE_MARGIN) - 1) | (~0ULL << (64 - EDGE_MARGIN));
+    bool nearEdge = false;
+    for (int y = 0; y < 64 && !nearEdge; y++) {
+        nearEdge = (y < EDGE_MARGIN || y >= 64 - EDGE_MARGIN) ? board[y] != 0 : (board[y] & edgeColumns) != 0;
+    }
+    if (!nearEdge) {
+        return;
+    }
+
+    Board remaining = board;
+    std::vector<std::pair<int, int>> stack;
+    std::vector<std::pair<int, int>> cells;
+    for (int y = 0; y < 64; y++) {
+        std::uint64_t band = (y < EDGE_MARGIN || y >= 64 - EDGE_MARGIN) ? ~0ULL : edgeColumns;
+        while (remaining[y] & band) {
+            int x = std::countr_zero(remaining[y] & band);
+            remaining[y] &= ~(1ULL << x);
+            floodObject(remaining, x, y, stack, cells);
+
+            const CatalogEntry* known = ObjectCatalog::find(ObjectCatalog::canonicalHash(cells));
+            if (known && known->kind == ObjectKind::Spaceship) {
+                for (const auto& cell : cells) {
+                    board[cell.second] &= ~(1ULL << cell.first);
+                }
+                escaped[known->name]++;
+            }
+        }
+    }
+}
+
+bool SoupCensus::start(const CensusOptions& censusOptions) {
+    cancel();
+    options = censusOptions;
+    resumedFrom = 0;
+
+    // Resume after the last complete row if the log belongs to this seed
+    std::error_code error;
+    if (std::filesystem::exists(options.path, error)) {
+        std::ifstream in(options.path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+
+        std::size_t end = contents.find_last_of('\n');
+        end = end == std::string::npos ? 0 : end + 1;
+        if (end != contents.size()) {
+            std::filesystem::resize_file(options.path, end, error);  // Drop a row cut off mid-write
+        }
+
+        std::istringstream lines(contents.substr(0, end));
+        std::string line;
+        bool headerSeen = false;
+        while (std::getline(lines, line)) {
+            if (!headerSeen && !line.empty() && line[0] != '#') {
+                headerSeen = true;
+                if (line != LOG_COLUMNS) {
+                    return false;  // Written before escaped spaceships were counted
+                }
+                continue;
+            }
+            long long index = 0;
+            unsigned long long seed = 0;
+            if (std::sscanf(line.c_str(), "%lld,%llu,", &index, &seed) == 2) {
+                if (seed != options.seed) {
+                    return false;  // Refuse to mix runs with different seeds
+                }
+                resumedFrom = index + 1;
+            }
+        }
+    }
+
+    bool fresh = resumedFrom == 0 && !std::filesystem::exists(options.path, error);
+    log = std::fopen(options.path.c_str(), "ab");
+    if (!log) {
+        return false;
+    }
+    if (fresh) {
+        std::fprintf(log, "# Soups of %dx%d on a 64x64 board with dead edges, run for at most %d generations.\n"
+            "# Catalogued spaceships within %d cells of an edge are removed and counted under 'escaped';\n"
+            "# anything else that reaches an edge dies against it, so other escaping objects are undercounted.\n",
+            options.soupSize, options.soupSize, options.maxGenerations, EDGE_MARGIN);
+        std::fprintf(log, "%s\n", LOG_COLUMNS);
+    }
+
+    nextSoup = resumedFrom;
+    written = resumedFrom;
+    pending.clear();
+    cancelled = false;
+    startedAt = nowNanoseconds();
+    finishedAt = 0;
+
+    int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    activeWorkers = threadCount;
+    running = true;
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&SoupCensus::work, this);
+    }
+    return true;
+}
+
+void SoupCensus::cancel() {
+    cancelled = true;
+    wait();
+}
+
+void SoupCensus::wait() {
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+}
+
+double SoupCensus::getSoupsPerSecond() const {
+    std::int64_t end = running.load() ? nowNanoseconds() : finishedAt.load();
+    double seconds = (end - startedAt) / 1e9;
+    return seconds > 0 ? (written.load() - resumedFrom) / seconds : 0.0;
+}
+
+void SoupCensus::work() {
+    while (!cancelled.load()) {
+        std::int64_t index = nextSoup++;
+        if (index >= options.soups) {
+            break;
+        }
+        SoupResult result = runSoup(makeSoup(options.seed, index, options.soupSize), options.maxGenerations);
+        result.index = index;
+        record(std::move(result));
+    }
+
+    if (--activeWorkers == 0) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::fflush(log);
+        finishedAt = nowNanoseconds();
+        running = false;
+    }
+}
+
+void SoupCensus::record(SoupResult result) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    pending.emplace(result.index, std::move(result));
+
+    // Rows go out strictly in soup order so the last row always marks where to resume
+    bool wrote = false;
+    while (!pending.empty() && pending.begin()->first == written.load()) {
+        const SoupResult& row = pending.begin()->second;
+        auto join = [](const std::map<std::string, int>& counts) {
+            std::string joined;
+            for (const auto& object : counts) {
+                if (!joined.empty()) {
+                    joined += ';';
+                }
+                joined += object.first + "=" + std::to_string(object.second);
+            }
+            return joined;
+        };
+        std::fprintf(log, "%lld,%llu,%d,%d,%d,%s,%s\n", static_cast<long long>(row.index), static_cast<unsigned long long>(options.seed),
+            row.lifespan, row.period, row.population, join(row.objects).c_str(), join(row.escaped).c_str());
+        pending.erase(pending.begin());
+        written++;
+        wrote = true;
+    }
+    if (wrote) {
+        std::fflush(log);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CensusOptions {
+    std::string path;                   // CSV file; an existing file for the same seed is resumed
+    std::uint64_t seed = 1;             // Soup i is derived from (seed, i) alone
+    std::int64_t soups = 100000;        // Total number of soups in the run
+    int soupSize = 16;                  // Soups are soupSize x soupSize squares of 50% density
+    int maxGenerations = 20000;         // Soups still changing after this are reported unstable
+    int threads = 0;                    // 0 uses every hardware thread
+};
+
+// The outcome of running one soup until it settles
+struct SoupResult {
+    std::int64_t index = 0;
+    int lifespan = -1;                  // Generation the final cycle was entered, -1 if unstable
+    int period = 0;                     // Period of the final state (1 for still lifes)
+    int population = 0;                 // Live cells in the final state
+    std::map<std::string, int> objects; // Census of the final state by object name
+    std::map<std::string, int> escaped; // Spaceships taken off the board as they neared its edge
+};
+
+// Runs many independent small soups in parallel, one per worker thread at a time. Each soup
+// lives on a 64x64 bounded board packed into one word per row, is stepped with the same
+// bit-sliced kernel as the main engine and is run until its state repeats. The lifespan,
+// period, final population and a census of the resulting objects are streamed to a CSV file
+// in soup order, so an interrupted run can be resumed from the last row written.
+//
+// Gliders and other spaceships would otherwise fly into the dead edge and die as debris, so
+// any catalogued spaceship that comes within EDGE_MARGIN cells of the edge is taken off the
+// board and counted as escaped. Anything else that reaches the edge still meets the wall.
+class SoupCensus {
+public:
+    typedef std::array<std::uint64_t, 64> Board;
+    static const int EDGE_MARGIN;
+
+    SoupCensus() = default;
+    ~SoupCensus();
+
+    SoupCensus(const SoupCensus&) = delete;
+    SoupCensus& operator=(const SoupCensus&) = delete;
+
+    // Opens the log (resuming it if it belongs to the same seed) and starts the workers
+    bool start(const CensusOptions& options);
+    void cancel();
+    void wait();
+
+    bool isRunning() const { return running.load(); }
+    std::int64_t getSoupsCompleted() const { return written.load(); }
+    std::int64_t getSoupsTotal() const { return options.soups; }
+    double getSoupsPerSecond() const;
+
+    // Builds soup 'index' of a run with the given seed and soup size
+    static Board makeSoup(std::uint64_t seed, std::int64_t index, int soupSize);
+
+    // Runs one board until it repeats and takes its census
+    static SoupResult runSoup(Board board, int maxGenerations);
+
+    // Takes the spaceships near the edge off the board, adding them to 'escaped' by name
+    static void removeEscaping(Board& board, std::map<std::string, int>& escaped);
+
+    // Splits a board into 8-connected objects and names each one it recognises
+    static std::map<std::string, int> takeCensus(const Board& board);
+
+    static Board step(const Board& board);
+
+private:
+    void work();
+    void record(SoupResult result);
+
+    CensusOptions options;
+    std::FILE* log = nullptr;
+    std::vector<std::thread> workers;
+    std::atomic<std::int64_t> nextSoup{ 0 };
+    std::atomic<std::int64_t> written{ 0 };
+    std::atomic<bool> running{ false };
+    std::atomic<bool> cancelled{ false };
+    std::int64_t resumedFrom = 0;
+    std::int64_t startedAt = 0;
+    std::atomic<std::int64_t> finishedAt{ 0 };
+    std::atomic<int> activeWorkers{ 0 };
+
+    std::mutex logMutex;                            // Guards the reorder buffer and the file
+    std::map<std::int64_t, SoupResult> pending;     // Finished soups waiting for earlier ones
+};
@@ -0,0 +1,282 @@
+#include "TileStepper.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <utility>  // For std::swap
+
+namespace {
+    // Wraps a coordinate into [0, size) for toroidal universes
+    inline int wrap(int value, int size) {
+        value %= size;
+        return value < 0 ? value + size : value;
+    }
+
+    // Reads up to 'count' cells of a row starting at global column 'gx' into one word
+    std::uint64_t fetchWord(const GridPlanes& source, const std::uint64_t* row, int gx, int count) {
+        if (gx >= 0 && gx + 64 <= source.width) {
+            int word = gx >> 6;
+            int shift = gx & 63;
+            if (shift == 0) {
+                return row[word];
+            }
+            return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+        }
+
+        // Near the edges fall back to reading cell by cell
+        std::uint64_t bits = 0;
+        for (int j = 0; j < count; j++) {
+            int x = gx + j;
+            if (source.toroidal) {
+                x = wrap(x, source.width);
+            }
+            else if (x < 0 || x >= source.width) {
+                continue;
+            }
+            bits |= ((row[x >> 6] >> (x & 63)) & 1ULL) << j;
+        }
+        return bits;
+    }
+
+    // Spreads the eight bits of a byte into eight bytes of 0x00 or 0xFF
+    constexpr std::array<std::uint64_t, 256> makeByteMasks() {
+        std::array<std::uint64_t, 256> masks{};
+        for (int bits = 0; bits < 256; bits++) {
+            for (int i = 0; i < 8; i++) {
+                if (bits & (1 << i)) {
+                    masks[bits] |= 0xFFULL << (8 * i);
+                }
+            }
+        }
+        return masks;
+    }
+    constexpr std::array<std::uint64_t, 256> byteMasks = makeByteMasks();
+}
+
+std::uint32_t TileStepper::birthColor(const std::uint32_t* neighborColors, int count) {
+    // Most common colour wins; ties go to the smallest RGB value, matching determineBirthColor
+    std::uint32_t best = 0;
+    int bestCount = 0;
+    for (int i = 0; i < count; i++) {
+        int occurrences = 0;
+        for (int j = 0; j < count; j++) {
+            if (neighborColors[j] == neighborColors[i]) {
+                occurrences++;
+            }
+        }
+        if (occurrences > bestCount || (occurrences == bestCount && neighborColors[i] < best)) {
+            best = neighborColors[i];
+            bestCount = occurrences;
+        }
+    }
+    return best;
+}
+
+void TileStepper::ageWord(std::uint8_t* ages, std::uint64_t alive, std::uint64_t next) {
+    // Eight cells per 64-bit lane: add one to every byte below 255, then keep only the survivors
+    const std::uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    for (int k = 0; k < 8; k++) {
+        std::uint64_t lane;
+        std::memcpy(&lane, ages + 8 * k, sizeof(lane));
+        lane &= byteMasks[(alive >> (8 * k)) & 0xFF];
+        std::uint64_t notFull = ~lane;
+        std::uint64_t room = ((((notFull & low7) + low7) | notFull) & ~low7) >> 7;  // 0x01 in each byte below 255
+        lane = (lane + room) & byteMasks[(next >> (8 * k)) & 0xFF];
+        std::memcpy(ages + 8 * k, &lane, sizeof(lane));
+    }
+}
+
+void TileStepper::load(const GridPlanes& source, int x0, int y0, int w, int h, int haloCells) {
+    tileX = x0;
+    tileY = y0;
+    tileWidth = w;
+    tileHeight = h;
+    halo = haloCells;
+
+    localWidth = w + 2 * halo;
+    localHeight = h + 2 * halo;
+    localWords = (localWidth + 63) / 64;
+
+    colored = source.colors != nullptr;
+    aged = source.ages != nullptr;
+    current.assign(static_cast<size_t>(localWords) * localHeight, 0);
+    next.assign(current.size(), 0);
+    colors.assign(colored ? static_cast<size_t>(localWidth) * localHeight : 0, 0);
+    ages.assign(aged ? static_cast<size_t>(localWords) * 64 * localHeight : 0, 0);  // Whole words, so ageWord never runs off a row
+
+    // Work out which columns of the buffer map onto the universe
+    std::vector<int> columnMap(localWidth);
+    columnMask.assign(localWords, 0);
+    for (int lx = 0; lx < localWidth; lx++) {
+        int gx = x0 - halo + lx;
+        if (source.toroidal) {
+            gx = wrap(gx, source.width);
+        }
+        else if (gx < 0 || gx >= source.width) {
+            gx = -1;
+        }
+        columnMap[lx] = gx;
+        if (gx >= 0) {
+            columnMask[lx >> 6] |= 1ULL << (lx & 63);
+        }
+    }
+
+    rowInside.assign(localHeight, 0);
+    for (int ly = 0; ly < localHeight; ly++) {
+        int gy = y0 - halo + ly;
+        if (source.toroidal) {
+            gy = wrap(gy, source.height);
+        }
+        else if (gy < 0 || gy >= source.height) {
+            continue;  // Rows beyond a bounded universe stay dead
+        }
+        rowInside[ly] = 1;
+
+        const std::uint64_t* row = source.cells + static_cast<size_t>(gy) * source.wordsPerRow;
+        std::uint64_t* local = &current[static_cast<size_t>(ly) * localWords];
+        for (int i = 0; i < localWords; i++) {
+            int count = std::min(64, localWidth - 64 * i);
+            local[i] = fetchWord(source, row, x0 - halo + 64 * i, count) & columnMask[i];
+        }
+
+        if (colored) {
+            const std::uint32_t* rowColors = source.colors + static_cast<size_t>(gy) * source.width;
+            std::uint32_t* localColors = &colors[static_cast<size_t>(ly) * localWidth];
+            for (int lx = 0; lx < localWidth; lx++) {
+                if (columnMap[lx] >= 0) {
+                    localColors[lx] = rowColors[columnMap[lx]];
+                }
+            }
+        }
+
+        if (aged) {
+            const std::uint8_t* rowAges = source.ages + static_cast<size_t>(gy) * source.width;
+            std::uint8_t* localAges = &ages[static_cast<size_t>(ly) * localWords * 64];
+            for (int lx = 0; lx < localWidth; lx++) {
+                if (columnMap[lx] >= 0) {
+                    localAges[lx] = rowAges[columnMap[lx]];
+                }
+            }
+        }
+    }
+}
+
+void TileStepper::setRule(const LifeRule& lifeRule) {
+    rule = lifeRule;
+    conway = rule.isConway();
+}
+
+void TileStepper::run(int generations) {
+    // The valid region shrinks by one row and column on every side each generation
+    for (int t = 1; t <= generations; t++) {
+        for (int ly = t; ly < localHeight - t; ly++) {
+            stepRow(ly);
+        }
+        std::swap(current, next);
+    }
+}
+
+bool TileStepper::getBit(const std::vector<std::uint64_t>& bits, int lx, int ly) const {
+    if (lx < 0 || lx >= localWidth) {
+        return false;
+    }
+    return (bits[static_cast<size_t>(ly) * localWords + (lx >> 6)] >> (lx & 63)) & 1ULL;
+}
+
+void TileStepper::stepRow(int ly) {
+    const std::uint64_t* above = &current[static_cast<size_t>(ly - 1) * localWords];
+    const std::uint64_t* row = &current[static_cast<size_t>(ly) * localWords];
+    const std::uint64_t* below = &current[static_cast<size_t>(ly + 1) * localWords];
+    std::uint64_t* out = &next[static_cast<size_t>(ly) * localWords];
+
+    if (!rowInside[ly]) {
+        std::fill(out, out + localWords, 0);
+        return;
+    }
+    std::uint8_t* rowAges = aged ? &ages[static_cast<size_t>(ly) * localWords * 64] : nullptr;
+
+    for (int i = 0; i < localWords; i++) {
+        // Bit j holds column 64*i + j, so the west neighbour comes from bit j-1
+        std::uint64_t prevA = i > 0 ? above[i - 1] : 0, nextA = i + 1 < localWords ? above[i + 1] : 0;
+        std::uint64_t prevR = i > 0 ? row[i - 1] : 0, nextR = i + 1 < localWords ? row[i + 1] : 0;
+        std::uint64_t prevB = i > 0 ? below[i - 1] : 0, nextB = i + 1 < localWords ? below[i + 1] : 0;
+
+        std::uint64_t aboveWest = (above[i] << 1) | (prevA >> 63), aboveEast = (above[i] >> 1) | (nextA << 63);
+        std::uint64_t west = (row[i] << 1) | (prevR >> 63), east = (row[i] >> 1) | (nextR << 63);
+        std::uint64_t belowWest = (below[i] << 1) | (prevB >> 63), belowEast = (below[i] >> 1) | (nextB << 63);
+        std::uint64_t result = conway
+            ? nextWord(aboveWest, above[i], aboveEast, west, row[i], east, belowWest, below[i], belowEast)
+            : nextWord(aboveWest, above[i], aboveEast, west, row[i], east, belowWest, below[i], belowEast, rule);
+        result &= columnMask[i];
+        out[i] = result;
+        if (aged) {
+            ageWord(rowAges + 64 * i, row[i], result);
+        }
+        if (!colored) {
+            continue;
+        }
+
+        // Newborn cells take their colour from their live neighbours
+        std::uint64_t births = result & ~row[i];
+        while (births) {
+            int lx = 64 * i + std::countr_zero(births);
+            births &= births - 1;
+
+            std::uint32_t neighborColors[8];
+            int count = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if ((dx != 0 || dy != 0) && getBit(current, lx + dx, ly + dy)) {
+                        neighborColors[count++] = colors[static_cast<size_t>(ly + dy) * localWidth + lx + dx];
+                    }
+                }
+            }
+            colors[static_cast<size_t>(ly) * localWidth + lx] = birthColor(neighborColors, count);
+        }
+    }
+}
+
+void TileStepper::store(const GridPlanes& target) const {
+    // Tiles start on word boundaries, so every global word written here belongs to this tile only
+    int firstWord = tileX >> 6;
+    int lastWord = (tileX + tileWidth - 1) >> 6;
+
+    for (int y = 0; y < tileHeight; y++) {
+        int ly = y + halo;
+        const std::uint64_t* local = &current[static_cast<size_t>(ly) * localWords];
+        std::uint64_t* row = target.cells + static_cast<size_t>(tileY + y) * target.wordsPerRow;
+
+        for (int word = firstWord; word <= lastWord; word++) {
+            int lx = halo + word * 64 - tileX;
+            int q = lx >> 6;
+            int shift = lx & 63;
+            std::uint64_t bits = local[q] >> shift;
+            if (shift != 0 && q + 1 < localWords) {
+                bits |= local[q + 1] << (64 - shift);
+            }
+
+            // A tile narrower than its last word leaves the cells past it as they were, but bits
+            // past the grid's width are always cleared: a target reused after a shrink may hold
+            // stale ones there
+            int valid = std::min(64, tileX + tileWidth - word * 64);
+            if (valid < 64) {
+                int inside = std::clamp(target.width - word * 64, valid, 64);
+                std::uint64_t tileMask = (1ULL << valid) - 1;
+                std::uint64_t keptMask = (inside == 64 ? ~0ULL : (1ULL << inside) - 1) & ~tileMask;
+                bits = (bits & tileMask) | (row[word] & keptMask);
+            }
+            row[word] = bits;
+        }
+
+        if (colored && target.colors) {
+            const std::uint32_t* localColors = &colors[static_cast<size_t>(ly) * localWidth + halo];
+            std::copy(localColors, localColors + tileWidth,
+                target.colors + static_cast<size_t>(tileY + y) * target.width + tileX);
+        }
+
+        if (aged && target.ages) {
+            const std::uint8_t* localAges = &ages[static_cast<size_t>(ly) * localWords * 64 + halo];
+            std::copy(localAges, localAges + tileWidth, target.ages + static_cast<size_t>(tileY + y) * target.width + tileX);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "LifeRule.h"
+#include <cstdint>
+#include <vector>
+
+// Describes the packed state planes of a universe so the kernel can read and write them
+struct GridPlanes {
+    int width;                 // Width of the universe in cells
+    int height;                // Height of the universe in cells
+    int wordsPerRow;           // Number of 64-bit words in each row of the alive plane
+    bool toroidal;             // Whether the edges wrap around
+    std::uint64_t* cells;      // Alive bits, bit (x % 64) of word (y * wordsPerRow + x / 64)
+    std::uint32_t* colors;     // Packed 0xRRGGBB colour of each cell, row-major; null to step without colours
+    std::uint8_t* ages;        // Generations each cell has been alive, saturating at 255, row-major; null to skip ages
+};
+
+// Advances a rectangular tile of the universe several generations inside a small
+// cache-resident buffer. The tile is loaded together with a halo as wide as the number
+// of generations to run; every generation the valid region shrinks by one cell on each
+// side, so after k generations exactly the tile itself is still valid and is written back.
+class TileStepper {
+public:
+    // Copies the tile at (x0, y0) of size w x h plus a halo of 'halo' cells from 'source'. Colours
+    // and ages are only stepped if 'source' has them, and only stored into targets that have them.
+    void load(const GridPlanes& source, int x0, int y0, int w, int h, int halo);
+
+    // Runs the given number of generations on the loaded tile (must not exceed the halo)
+    void run(int generations);
+
+    // Rule used by run; Conway's B3/S23 unless set
+    void setRule(const LifeRule& lifeRule);
+
+    // Writes the tile (without its halo) into 'target' at the position it was loaded from; cells of
+    // the target past the tile's right edge are kept even where they share its last word, while bits
+    // past the grid's width are cleared
+    void store(const GridPlanes& target) const;
+
+    // Computes the next state of 64 cells from the rows above, at and below them. The kernel is
+    // constexpr and lives here so fixed-size boards can inline it and run it at compile time.
+    static constexpr std::uint64_t nextWord(std::uint64_t aboveWest, std::uint64_t above, std::uint64_t aboveEast,
+        std::uint64_t west, std::uint64_t alive, std::uint64_t east,
+        std::uint64_t belowWest, std::uint64_t below, std::uint64_t belowEast) {
+        std::uint64_t ones = 0, twos = 0, fours = 0, eights = 0;
+        countNeighbors(aboveWest, above, aboveEast, west, east, belowWest, below, belowEast, ones, twos, fours, eights);
+
+        // B3/S23: exactly three neighbours, or two neighbours and already alive
+        std::uint64_t twoOrThree = twos & ~fours & ~eights;
+        return twoOrThree & (ones | alive);
+    }
+
+    // The same under any outer-totalistic rule
+    static constexpr std::uint64_t nextWord(std::uint64_t aboveWest, std::uint64_t above, std::uint64_t aboveEast,
+        std::uint64_t west, std::uint64_t alive, std::uint64_t east,
+        std::uint64_t belowWest, std::uint64_t below, std::uint64_t belowEast, const LifeRule& rule) {
+        std::uint64_t ones = 0, twos = 0, fours = 0, eights = 0;
+        countNeighbors(aboveWest, above, aboveEast, west, east, belowWest, below, belowEast, ones, twos, fours, eights);
+
+        // Match each count the rule mentions against the four count bits of every lane
+        std::uint64_t born = 0, kept = 0;
+        for (int n = 0; n <= 8; n++) {
+            bool births = (rule.birth >> n) & 1, survives = (rule.survival >> n) & 1;
+            if (!births && !survives) {
+                continue;
+            }
+            std::uint64_t match = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos) & ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+            if (births) {
+                born |= match;
+            }
+            if (survives) {
+                kept |= match;
+            }
+        }
+        return (born & ~alive) | (kept & alive);
+    }
+
+    // Picks the colour a newborn cell inherits: the most common among its live neighbours
+    static std::uint32_t birthColor(const std::uint32_t* neighborColors, int count);
+
+    // Ages 64 cells at once: cells alive in 'next' that were alive in 'alive' get one generation
+    // older (saturating at 255), newborn cells become 1 and every dead cell 0
+    static void ageWord(std::uint8_t* ages, std::uint64_t alive, std::uint64_t next);
+
+private:
+    // Sums three one-bit inputs per lane into a sum and a carry
+    static constexpr void fullAdd(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t& sum, std::uint64_t& carry) {
+        std::uint64_t t = a ^ b;
+        sum = t ^ c;
+        carry = (a & b) | (t & c);
+    }
+
+    // Bit-sliced adder tree counting the eight neighbours of every lane at once; the count of
+    // each lane is spread over the same bit of ones, twos, fours and eights
+    static constexpr void countNeighbors(std::uint64_t aboveWest, std::uint64_t above, std::uint64_t aboveEast,
+        std::uint64_t west, std::uint64_t east,
+        std::uint64_t belowWest, std::uint64_t below, std::uint64_t belowEast,
+        std::uint64_t& ones, std::uint64_t& twos, std::uint64_t& fours, std::uint64_t& eights) {
+        std::uint64_t sumAbove = 0, carryAbove = 0, sumBelow = 0, carryBelow = 0;
+        fullAdd(aboveWest, above, aboveEast, sumAbove, carryAbove);
+        fullAdd(belowWest, below, belowEast, sumBelow, carryBelow);
+        std::uint64_t sumMiddle = west ^ east;
+        std::uint64_t carryMiddle = west & east;
+
+        std::uint64_t carryOnes = 0;
+        fullAdd(sumAbove, sumMiddle, sumBelow, ones, carryOnes);
+
+        std::uint64_t twosPartial = 0, carryTwos = 0;
+        fullAdd(carryAbove, carryMiddle, carryBelow, twosPartial, carryTwos);
+        twos = twosPartial ^ carryOnes;
+        fours = carryTwos ^ (twosPartial & carryOnes);
+        eights = carryTwos & twosPartial & carryOnes;
+    }
+
+    bool getBit(const std::vector<std::uint64_t>& bits, int lx, int ly) const;
+    void stepRow(int ly);
+
+    int tileX = 0;              // Global position and size of the tile being stepped
+    int tileY = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    int halo = 0;
+    LifeRule rule;
+    bool conway = true;         // Take the dedicated B3/S23 path
+    bool colored = true;        // The loaded tile carries colours
+    bool aged = true;           // The loaded tile carries ages
+
+    int localWidth = 0;         // Size of the buffer including the halo
+    int localHeight = 0;
+    int localWords = 0;
+
+    std::vector<std::uint64_t> current;    // Alive bits of the local buffer
+    std::vector<std::uint64_t> next;       // Alive bits of the generation being computed
+    std::vector<std::uint64_t> columnMask; // Columns of the buffer that lie inside the universe
+    std::vector<char> rowInside;           // Rows of the buffer that lie inside the universe
+    std::vector<std::uint32_t> colors;     // Colours of the local buffer, updated in place
+    std::vector<std::uint8_t> ages;        // Ages of the local buffer, updated in place
+};
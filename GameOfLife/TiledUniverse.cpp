@@ -0,0 +1,714 @@
+#include "TiledUniverse.h"
+#include "TileStepper.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+const int TiledUniverse::TILE_SIZE = 256;
+const int TiledUniverse::TILE_WORDS = TILE_SIZE / 64;
+const int TiledUniverse::TILE_BITS_WORDS = TILE_SIZE * TILE_WORDS;
+
+namespace {
+    // Tiles, their edge copies and appendRuns are laid out for exactly this size
+    const int TILE_SHIFT = 8;
+    static_assert(TiledUniverse::TILE_SIZE == 1 << TILE_SHIFT, "Edges hold one 256-cell side in four words");
+
+    const size_t TILE_BYTES = sizeof(std::uint64_t) * 256 * 4;
+    const size_t MIN_RESIDENT_TILES = 4;
+
+    bool seekTo(std::FILE* file, std::int64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    // Appends the runs of live cells in one 256-cell tile row, merging with a run that ends
+    // exactly where this tile starts
+    void appendRuns(const std::uint64_t* row, std::int64_t x0, std::vector<std::pair<std::int64_t, std::int64_t>>& runs) {
+        const int words = 4;
+        int bit = 0;
+        while (bit < 256) {
+            int word = bit >> 6;
+            std::uint64_t bits = row[word] & (~0ULL << (bit & 63));
+            while (!bits && ++word < words) {
+                bits = row[word];
+            }
+            if (word >= words) {
+                break;
+            }
+            int start = word * 64 + std::countr_zero(bits);
+
+            bits = ~row[word] & (~0ULL << (start & 63));
+            while (!bits && ++word < words) {
+                bits = ~row[word];
+            }
+            int end = word >= words ? 256 : word * 64 + std::countr_zero(bits);
+
+            if (!runs.empty() && runs.back().first + runs.back().second == x0 + start) {
+                runs.back().second += end - start;
+            }
+            else {
+                runs.emplace_back(x0 + start, end - start);
+            }
+            bit = end;
+        }
+    }
+
+    // Accumulates RLE tokens into lines of at most 70 characters
+    class RleWriter {
+    public:
+        explicit RleWriter(std::FILE* file) : file(file) {}
+
+        void emit(std::int64_t count, char tag) {
+            std::string token = count > 1 ? std::to_string(count) : std::string();
+            token += tag;
+            if (line.size() + token.size() > 70) {
+                flush();
+            }
+            line += token;
+        }
+
+        void flush() {
+            if (!line.empty()) {
+                std::fputs(line.c_str(), file);
+                std::fputc('\n', file);
+                line.clear();
+            }
+        }
+
+    private:
+        std::FILE* file;
+        std::string line;
+    };
+}
+
+TiledUniverse::TiledUniverse()
+    : scratch(TILE_BITS_WORDS), halo(static_cast<size_t>(TILE_SIZE + 2) * (TILE_WORDS + 2)) {
+}
+
+TiledUniverse::~TiledUniverse() {
+    close();
+}
+
+bool TiledUniverse::open(const std::string& path, size_t limit) {
+    close();
+    store = std::fopen(path.c_str(), "w+b");
+    if (!store) {
+        return false;
+    }
+    storePath = path;
+    memoryLimit = std::max(limit, MIN_RESIDENT_TILES * TILE_BYTES);
+    return true;
+}
+
+void TiledUniverse::close() {
+    tiles.clear();
+    lru.clear();
+    changedTiles.clear();
+    freeSlots.clear();
+    slotCount = 0;
+    activeTiles = 0;
+    pageIns = 0;
+    pageOuts = 0;
+    ioErrors = 0;
+    generation = 0;
+    population = 0;
+    if (store) {
+        std::fclose(store);
+        store = nullptr;
+        std::remove(storePath.c_str());
+    }
+}
+
+void TiledUniverse::setRule(const LifeRule& lifeRule) {
+    rule = lifeRule;
+    conway = rule.isConway();
+    // Settled tiles may not be settled under the new rule
+    for (auto& [key, tile] : tiles) {
+        if (!tile.changed) {
+            tile.changed = true;
+            changedTiles.push_back(key);
+        }
+    }
+}
+
+std::uint64_t TiledUniverse::tileKey(std::int64_t tileX, std::int64_t tileY) {
+    // Offset so that sorting the keys orders tiles row by row, left to right
+    std::uint32_t column = static_cast<std::uint32_t>(tileX + 0x80000000LL);
+    std::uint32_t row = static_cast<std::uint32_t>(tileY + 0x80000000LL);
+    return (static_cast<std::uint64_t>(row) << 32) | column;
+}
+
+std::int64_t TiledUniverse::tileXOf(std::uint64_t key) {
+    return static_cast<std::int64_t>(key & 0xFFFFFFFFULL) - 0x80000000LL;
+}
+
+std::int64_t TiledUniverse::tileYOf(std::uint64_t key) {
+    return static_cast<std::int64_t>(key >> 32) - 0x80000000LL;
+}
+
+TiledUniverse::Tile* TiledUniverse::findTile(std::uint64_t key) {
+    auto found = tiles.find(key);
+    return found == tiles.end() ? nullptr : &found->second;
+}
+
+TiledUniverse::Tile& TiledUniverse::createTile(std::uint64_t key) {
+    Tile& tile = tiles[key];
+    tile.bits = std::make_unique<TileBits>(TILE_BITS_WORDS, 0);
+    tile.dirty = true;
+    lru.push_front(key);
+    tile.lruPosition = lru.begin();
+    evictOverLimit(key);
+    return tile;
+}
+
+TiledUniverse::TileBits& TiledUniverse::residentBits(std::uint64_t key, Tile& tile) {
+    if (!tile.bits) {
+        tile.bits = std::make_unique<TileBits>(TILE_BITS_WORDS, 0);
+        if (tile.slot >= 0) {
+            if (!readSlot(tile.slot, *tile.bits)) {
+                ioErrors++;
+            }
+            pageIns++;
+        }
+        lru.push_front(key);
+        tile.lruPosition = lru.begin();
+        evictOverLimit(key);
+    }
+    else if (tile.lruPosition != lru.begin()) {
+        lru.splice(lru.begin(), lru, tile.lruPosition);
+    }
+    return *tile.bits;
+}
+
+void TiledUniverse::evictOverLimit(std::uint64_t keep) {
+    while (lru.size() * TILE_BYTES > memoryLimit && lru.size() > 1 && lru.back() != keep) {
+        std::uint64_t key = lru.back();
+        Tile& tile = tiles[key];
+        if (!evict(tile)) {
+            // The tile cannot be written out; keep it rather than lose it and stop trying for now
+            lru.splice(lru.begin(), lru, tile.lruPosition);
+            break;
+        }
+    }
+}
+
+bool TiledUniverse::evict(Tile& tile) {
+    if (tile.dirty || tile.slot < 0) {
+        if (tile.slot < 0) {
+            tile.slot = allocateSlot();
+        }
+        if (!writeSlot(tile.slot, *tile.bits)) {
+            ioErrors++;
+            return false;
+        }
+        pageOuts++;
+        tile.dirty = false;
+    }
+    tile.bits.reset();
+    lru.erase(tile.lruPosition);
+    return true;
+}
+
+void TiledUniverse::removeTile(std::uint64_t key) {
+    auto found = tiles.find(key);
+    if (found == tiles.end()) {
+        return;
+    }
+    if (found->second.bits) {
+        lru.erase(found->second.lruPosition);
+    }
+    if (found->second.slot >= 0) {
+        freeSlots.push_back(found->second.slot);
+    }
+    population -= found->second.population;
+    tiles.erase(found);
+}
+
+std::int64_t TiledUniverse::allocateSlot() {
+    if (!freeSlots.empty()) {
+        std::int64_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    return slotCount++;
+}
+
+bool TiledUniverse::readSlot(std::int64_t slot, TileBits& bits) {
+    return seekTo(store, slot * static_cast<std::int64_t>(TILE_BYTES))
+        && std::fread(bits.data(), TILE_BYTES, 1, store) == 1;
+}
+
+bool TiledUniverse::writeSlot(std::int64_t slot, const TileBits& bits) {
+    return store && seekTo(store, slot * static_cast<std::int64_t>(TILE_BYTES))
+        && std::fwrite(bits.data(), TILE_BYTES, 1, store) == 1;
+}
+
+void TiledUniverse::markEdited(std::uint64_t key, Tile& tile) {
+    tile.dirty = true;
+    tile.edited = true;
+    if (!tile.changed) {
+        tile.changed = true;
+        changedTiles.push_back(key);
+    }
+}
+
+void TiledUniverse::recount(std::uint64_t key, Tile& tile) {
+    const TileBits& bits = residentBits(key, tile);
+    std::uint32_t count = 0;
+    for (std::uint64_t word : bits) {
+        count += std::popcount(word);
+    }
+    population += static_cast<std::int64_t>(count) - tile.population;
+    tile.population = count;
+    tile.edges = edgesOf(bits);
+    tile.edited = false;
+}
+
+void TiledUniverse::settleEdits() {
+    for (std::uint64_t key : changedTiles) {
+        Tile* tile = findTile(key);
+        if (tile && tile->edited) {
+            recount(key, *tile);
+            if (tile->population == 0) {
+                removeTile(key);
+            }
+        }
+    }
+}
+
+TiledUniverse::Edges TiledUniverse::edgesOf(const TileBits& bits) const {
+    Edges edges;
+    std::copy_n(bits.begin(), TILE_WORDS, edges.top.begin());
+    std::copy_n(bits.begin() + static_cast<size_t>(TILE_SIZE - 1) * TILE_WORDS, TILE_WORDS, edges.bottom.begin());
+    for (int row = 0; row < TILE_SIZE; row++) {
+        edges.left[row >> 6] |= (bits[static_cast<size_t>(row) * TILE_WORDS] & 1ULL) << (row & 63);
+        edges.right[row >> 6] |= (bits[static_cast<size_t>(row) * TILE_WORDS + TILE_WORDS - 1] >> 63) << (row & 63);
+    }
+    return edges;
+}
+
+bool TiledUniverse::getCell(std::int64_t x, std::int64_t y) {
+    std::uint64_t key = tileKey(x >> TILE_SHIFT, y >> TILE_SHIFT);
+    Tile* tile = findTile(key);
+    if (!tile) {
+        return false;
+    }
+    int localX = static_cast<int>(x & (TILE_SIZE - 1)), localY = static_cast<int>(y & (TILE_SIZE - 1));
+    const TileBits& bits = residentBits(key, *tile);
+    return (bits[static_cast<size_t>(localY) * TILE_WORDS + (localX >> 6)] >> (localX & 63)) & 1ULL;
+}
+
+void TiledUniverse::setCell(std::int64_t x, std::int64_t y, bool alive) {
+    std::uint64_t key = tileKey(x >> TILE_SHIFT, y >> TILE_SHIFT);
+    Tile* tile = findTile(key);
+    if (!tile) {
+        if (!alive) {
+            return;
+        }
+        tile = &createTile(key);
+    }
+    int localX = static_cast<int>(x & (TILE_SIZE - 1)), localY = static_cast<int>(y & (TILE_SIZE - 1));
+    std::uint64_t& word = residentBits(key, *tile)[static_cast<size_t>(localY) * TILE_WORDS + (localX >> 6)];
+    std::uint64_t mask = 1ULL << (localX & 63);
+    word = alive ? word | mask : word & ~mask;
+    markEdited(key, *tile);
+}
+
+void TiledUniverse::fillRun(std::int64_t x, std::int64_t y, std::int64_t length) {
+    std::int64_t tileY = y >> TILE_SHIFT;
+    size_t rowOffset = static_cast<size_t>(y & (TILE_SIZE - 1)) * TILE_WORDS;
+    while (length > 0) {
+        std::uint64_t key = tileKey(x >> TILE_SHIFT, tileY);
+        Tile* tile = findTile(key);
+        if (!tile) {
+            tile = &createTile(key);
+        }
+        std::uint64_t* row = residentBits(key, *tile).data() + rowOffset;
+        int localX = static_cast<int>(x & (TILE_SIZE - 1));
+        int count = static_cast<int>(std::min<std::int64_t>(length, TILE_SIZE - localX));
+        for (int bit = localX; bit < localX + count;) {
+            int take = std::min(64 - (bit & 63), localX + count - bit);
+            std::uint64_t mask = take == 64 ? ~0ULL : ((1ULL << take) - 1) << (bit & 63);
+            row[bit >> 6] |= mask;
+            bit += take;
+        }
+        markEdited(key, *tile);
+        x += count;
+        length -= count;
+    }
+}
+
+void TiledUniverse::stamp(const BitPattern& pattern, std::int64_t x, std::int64_t y) {
+    for (int row = 0; row < pattern.height; row++) {
+        const std::uint64_t* bits = &pattern.rows[static_cast<size_t>(row) * pattern.wordsPerRow];
+        std::vector<std::pair<std::int64_t, std::int64_t>> runs;
+        for (int word = 0; word < pattern.wordsPerRow; word += 4) {
+            // appendRuns reads four words at a time; pad the last group of the row
+            std::uint64_t group[4] = {};
+            std::copy_n(bits + word, std::min(4, pattern.wordsPerRow - word), group);
+            appendRuns(group, x + 64LL * word, runs);
+        }
+        for (const auto& [start, length] : runs) {
+            fillRun(start, y + row, length);
+        }
+    }
+}
+
+bool TiledUniverse::bordersLife(std::int64_t tileX, std::int64_t tileY) {
+    auto any = [](const std::array<std::uint64_t, 4>& side) {
+        return (side[0] | side[1] | side[2] | side[3]) != 0;
+    };
+    const Tile* tile;
+    return ((tile = findTile(tileKey(tileX, tileY - 1))) && any(tile->edges.bottom))
+        || ((tile = findTile(tileKey(tileX, tileY + 1))) && any(tile->edges.top))
+        || ((tile = findTile(tileKey(tileX - 1, tileY))) && any(tile->edges.right))
+        || ((tile = findTile(tileKey(tileX + 1, tileY))) && any(tile->edges.left))
+        || ((tile = findTile(tileKey(tileX - 1, tileY - 1))) && (tile->edges.bottom[3] >> 63))
+        || ((tile = findTile(tileKey(tileX + 1, tileY - 1))) && (tile->edges.bottom[0] & 1ULL))
+        || ((tile = findTile(tileKey(tileX - 1, tileY + 1))) && (tile->edges.top[3] >> 63))
+        || ((tile = findTile(tileKey(tileX + 1, tileY + 1))) && (tile->edges.top[0] & 1ULL));
+}
+
+void TiledUniverse::stepTile(const TileBits* bits, std::int64_t tileX, std::int64_t tileY, TileBits& next) {
+    const int haloWords = TILE_WORDS + 2;
+    std::fill(halo.begin(), halo.end(), 0);
+    auto haloRow = [&](int row) { return &halo[static_cast<size_t>(row + 1) * haloWords + 1]; };
+
+    if (bits) {
+        for (int row = 0; row < TILE_SIZE; row++) {
+            std::copy_n(bits->data() + static_cast<size_t>(row) * TILE_WORDS, TILE_WORDS, haloRow(row));
+        }
+    }
+
+    // The border comes from the neighbours' edge copies, so they never need to be paged in
+    auto neighbor = [&](int dx, int dy) -> const Edges* {
+        const Tile* tile = findTile(tileKey(tileX + dx, tileY + dy));
+        return tile ? &tile->edges : nullptr;
+    };
+    if (const Edges* north = neighbor(0, -1)) {
+        std::copy(north->bottom.begin(), north->bottom.end(), haloRow(-1));
+    }
+    if (const Edges* south = neighbor(0, 1)) {
+        std::copy(south->top.begin(), south->top.end(), haloRow(TILE_SIZE));
+    }
+    if (const Edges* west = neighbor(-1, 0)) {
+        for (int row = 0; row < TILE_SIZE; row++) {
+            haloRow(row)[-1] = ((west->right[row >> 6] >> (row & 63)) & 1ULL) << 63;
+        }
+    }
+    if (const Edges* east = neighbor(1, 0)) {
+        for (int row = 0; row < TILE_SIZE; row++) {
+            haloRow(row)[TILE_WORDS] = (east->left[row >> 6] >> (row & 63)) & 1ULL;
+        }
+    }
+    if (const Edges* northWest = neighbor(-1, -1)) {
+        haloRow(-1)[-1] = northWest->bottom[TILE_WORDS - 1] & (1ULL << 63);
+    }
+    if (const Edges* northEast = neighbor(1, -1)) {
+        haloRow(-1)[TILE_WORDS] = northEast->bottom[0] & 1ULL;
+    }
+    if (const Edges* southWest = neighbor(-1, 1)) {
+        haloRow(TILE_SIZE)[-1] = southWest->top[TILE_WORDS - 1] & (1ULL << 63);
+    }
+    if (const Edges* southEast = neighbor(1, 1)) {
+        haloRow(TILE_SIZE)[TILE_WORDS] = southEast->top[0] & 1ULL;
+    }
+
+    for (int row = 0; row < TILE_SIZE; row++) {
+        const std::uint64_t* above = haloRow(row - 1);
+        const std::uint64_t* middle = haloRow(row);
+        const std::uint64_t* below = haloRow(row + 1);
+        std::uint64_t* out = next.data() + static_cast<size_t>(row) * TILE_WORDS;
+        for (int i = 0; i < TILE_WORDS; i++) {
+            // Bit j holds column 64*i + j, so the west neighbour comes from bit j-1
+            std::uint64_t aboveWest = (above[i] << 1) | (above[i - 1] >> 63), aboveEast = (above[i] >> 1) | (above[i + 1] << 63);
+            std::uint64_t west = (middle[i] << 1) | (middle[i - 1] >> 63), east = (middle[i] >> 1) | (middle[i + 1] << 63);
+            std::uint64_t belowWest = (below[i] << 1) | (below[i - 1] >> 63), belowEast = (below[i] >> 1) | (below[i + 1] << 63);
+            out[i] = conway
+                ? TileStepper::nextWord(aboveWest, above[i], aboveEast, west, middle[i], east, belowWest, below[i], belowEast)
+                : TileStepper::nextWord(aboveWest, above[i], aboveEast, west, middle[i], east, belowWest, below[i], belowEast, rule);
+        }
+    }
+}
+
+void TiledUniverse::step() {
+    settleEdits();
+
+    // Only tiles next to a change can change; everything else is settled and stays on disk
+    std::vector<std::uint64_t> candidates;
+    candidates.reserve(changedTiles.size() * 9);
+    for (std::uint64_t key : changedTiles) {
+        std::int64_t tileX = tileXOf(key), tileY = tileYOf(key);
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                candidates.push_back(tileKey(tileX + dx, tileY + dy));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    activeTiles = candidates.size();
+
+    // Neighbours read each other's edge copies, so those only change once every tile is stepped
+    struct Update {
+        std::uint64_t key;
+        Edges edges;
+        std::uint32_t population;
+        bool changed;
+    };
+    std::vector<Update> updates;
+    for (std::uint64_t key : candidates) {
+        std::int64_t tileX = tileXOf(key), tileY = tileYOf(key);
+        Tile* tile = findTile(key);
+        if (!tile && !(rule.birth & 1) && !bordersLife(tileX, tileY)) {
+            continue;  // Most candidates are empty space next to a change, and nothing reaches them
+        }
+        stepTile(tile ? &residentBits(key, *tile) : nullptr, tileX, tileY, scratch);
+
+        std::uint32_t count = 0;
+        for (std::uint64_t word : scratch) {
+            count += std::popcount(word);
+        }
+        if (!tile) {
+            if (count == 0) {
+                continue;  // Empty space stays empty
+            }
+            tile = &createTile(key);
+        }
+        TileBits& bits = *tile->bits;
+        bool changed = bits != scratch;
+        if (changed) {
+            bits.swap(scratch);
+            tile->dirty = true;
+        }
+        updates.push_back({ key, changed ? edgesOf(bits) : tile->edges, count, changed });
+    }
+
+    changedTiles.clear();
+    for (const Update& update : updates) {
+        Tile& tile = tiles[update.key];
+        tile.edges = update.edges;
+        tile.changed = update.changed;
+        population += static_cast<std::int64_t>(update.population) - tile.population;
+        tile.population = update.population;
+        if (update.changed) {
+            // A tile that died out is still a change its neighbours must see next generation
+            changedTiles.push_back(update.key);
+        }
+        if (update.population == 0) {
+            removeTile(update.key);
+        }
+    }
+    generation++;
+}
+
+void TiledUniverse::advance(int generations) {
+    for (int i = 0; i < generations; i++) {
+        step();
+    }
+}
+
+std::int64_t TiledUniverse::getPopulation() {
+    settleEdits();
+    return population;
+}
+
+bool TiledUniverse::getBounds(std::int64_t& x, std::int64_t& y, std::int64_t& width, std::int64_t& height) {
+    settleEdits();
+    if (tiles.empty()) {
+        return false;
+    }
+    std::int64_t minTileX = LLONG_MAX, maxTileX = LLONG_MIN, minTileY = LLONG_MAX, maxTileY = LLONG_MIN;
+    for (const auto& [key, tile] : tiles) {
+        minTileX = std::min(minTileX, tileXOf(key));
+        maxTileX = std::max(maxTileX, tileXOf(key));
+        minTileY = std::min(minTileY, tileYOf(key));
+        maxTileY = std::max(maxTileY, tileYOf(key));
+    }
+
+    // Only the tiles on the outermost tile rows and columns can hold the extreme cells
+    std::int64_t minX = LLONG_MAX, maxX = LLONG_MIN, minY = LLONG_MAX, maxY = LLONG_MIN;
+    for (auto& [key, tile] : tiles) {
+        std::int64_t tileX = tileXOf(key), tileY = tileYOf(key);
+        if (tileX != minTileX && tileX != maxTileX && tileY != minTileY && tileY != maxTileY) {
+            continue;
+        }
+        const TileBits& bits = residentBits(key, tile);
+        for (int row = 0; row < TILE_SIZE; row++) {
+            for (int i = 0; i < TILE_WORDS; i++) {
+                std::uint64_t word = bits[static_cast<size_t>(row) * TILE_WORDS + i];
+                if (!word) {
+                    continue;
+                }
+                std::int64_t cellY = tileY * TILE_SIZE + row;
+                minY = std::min(minY, cellY);
+                maxY = std::max(maxY, cellY);
+                minX = std::min(minX, tileX * TILE_SIZE + 64 * i + std::countr_zero(word));
+                maxX = std::max(maxX, tileX * TILE_SIZE + 64 * i + 63 - std::countl_zero(word));
+            }
+        }
+    }
+    x = minX;
+    y = minY;
+    width = maxX - minX + 1;
+    height = maxY - minY + 1;
+    return true;
+}
+
+void TiledUniverse::copyTo(Universe& target, std::int64_t x, std::int64_t y, std::uint32_t color) {
+    settleEdits();
+    int width = target.getWidth(), height = target.getHeight();
+    BitPattern window(width, height);
+    for (std::int64_t tileY = y >> TILE_SHIFT; tileY <= (y + height - 1) >> TILE_SHIFT; tileY++) {
+        for (std::int64_t tileX = x >> TILE_SHIFT; tileX <= (x + width - 1) >> TILE_SHIFT; tileX++) {
+            std::uint64_t key = tileKey(tileX, tileY);
+            Tile* tile = findTile(key);
+            if (!tile) {
+                continue;
+            }
+            const TileBits& bits = residentBits(key, *tile);
+            for (int row = 0; row < TILE_SIZE; row++) {
+                std::int64_t windowY = tileY * TILE_SIZE + row - y;
+                if (windowY < 0 || windowY >= height) {
+                    continue;
+                }
+                for (int i = 0; i < TILE_WORDS; i++) {
+                    for (std::uint64_t word = bits[static_cast<size_t>(row) * TILE_WORDS + i]; word; word &= word - 1) {
+                        std::int64_t windowX = tileX * TILE_SIZE + 64 * i + std::countr_zero(word) - x;
+                        if (windowX >= 0 && windowX < width) {
+                            window.set(static_cast<int>(windowX), static_cast<int>(windowY));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    target.stamp(window, 0, 0, color, true);
+}
+
+bool TiledUniverse::loadRle(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::int64_t x = 0, y = 0, count = 0;
+    bool lineStart = true, header = false;
+    int c;
+    while ((c = std::fgetc(file)) != EOF && c != '!') {
+        if (lineStart && (c == '#' || (c == 'x' && !header))) {
+            // Comment or header line; the header may name the rule
+            std::string line(1, static_cast<char>(c));
+            while ((c = std::fgetc(file)) != EOF && c != '\n') {
+                line += static_cast<char>(c);
+            }
+            if (line[0] == 'x') {
+                header = true;
+                size_t rulePosition = line.find("rule");
+                size_t equals = rulePosition == std::string::npos ? std::string::npos : line.find('=', rulePosition);
+                LifeRule headerRule;
+                if (equals != std::string::npos && LifeRule::parse(line.substr(equals + 1), headerRule)) {
+                    setRule(headerRule);
+                }
+            }
+            continue;
+        }
+        lineStart = c == '\n';
+        if (c >= '0' && c <= '9') {
+            count = count * 10 + (c - '0');
+            continue;
+        }
+        std::int64_t run = std::max<std::int64_t>(count, 1);
+        count = 0;
+        if (c == 'b' || c == '.') {
+            x += run;
+        }
+        else if (c == '$') {
+            y += run;
+            x = 0;
+        }
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            // 'o' in two-state files; any other state letter counts as alive
+            fillRun(x, y, run);
+            x += run;
+        }
+    }
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    return !failed;
+}
+
+bool TiledUniverse::saveRle(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::int64_t minX = 0, minY = 0, width = 0, height = 0;
+    getBounds(minX, minY, width, height);
+    std::fprintf(file, "x = %lld, y = %lld, rule = %s\n", static_cast<long long>(width), static_cast<long long>(height), rule.toString().c_str());
+
+    std::vector<std::uint64_t> keys;
+    keys.reserve(tiles.size());
+    for (const auto& entry : tiles) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    RleWriter writer(file);
+    std::int64_t lastRow = minY;
+    std::vector<std::vector<std::pair<std::int64_t, std::int64_t>>> runs(TILE_SIZE);
+    for (size_t first = 0; first < keys.size();) {
+        // Gather the runs of one band of tiles, visiting each tile once
+        std::int64_t tileY = tileYOf(keys[first]);
+        size_t last = first;
+        for (auto& rowRuns : runs) {
+            rowRuns.clear();
+        }
+        for (; last < keys.size() && tileYOf(keys[last]) == tileY; last++) {
+            const TileBits& bits = residentBits(keys[last], tiles[keys[last]]);
+            for (int row = 0; row < TILE_SIZE; row++) {
+                appendRuns(&bits[static_cast<size_t>(row) * TILE_WORDS], tileXOf(keys[last]) * TILE_SIZE, runs[row]);
+            }
+        }
+        first = last;
+
+        for (int row = 0; row < TILE_SIZE; row++) {
+            if (runs[row].empty()) {
+                continue;
+            }
+            std::int64_t cellY = tileY * TILE_SIZE + row;
+            if (cellY > lastRow) {
+                writer.emit(cellY - lastRow, '$');
+            }
+            lastRow = cellY;
+            std::int64_t cursor = minX;
+            for (const auto& [start, length] : runs[row]) {
+                if (start > cursor) {
+                    writer.emit(start - cursor, 'b');
+                }
+                writer.emit(length, 'o');
+                cursor = start + length;
+            }
+        }
+    }
+    writer.emit(1, '!');
+    writer.flush();
+    bool failed = std::ferror(file) != 0;
+    return std::fclose(file) == 0 && !failed;
+}
+
+TiledUniverse::Stats TiledUniverse::getStats() const {
+    Stats stats;
+    stats.tiles = tiles.size();
+    stats.residentTiles = lru.size();
+    stats.residentBytes = lru.size() * TILE_BYTES;
+    // Map node, key and list node per tile, roughly
+    stats.directoryBytes = tiles.size() * (sizeof(Tile) + sizeof(std::uint64_t) + 4 * sizeof(void*));
+    stats.activeTiles = activeTiles;
+    stats.pageIns = pageIns;
+    stats.pageOuts = pageOuts;
+    stats.ioErrors = ioErrors;
+    return stats;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "BitPattern.h"
+#include "LifeRule.h"
+#include "Universe.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Unbounded universe for patterns far larger than memory. The plane is cut into square tiles
+// of alive bits; only tiles with a live cell exist, and their bits live in a scratch file on
+// disk, paged in and out through an LRU cache held under a memory cap.
+//
+// Every tile keeps a copy of its four edges in memory, so stepping a tile needs its own bits
+// and nothing else from disk. A generation only steps the tiles that changed in the previous
+// one and their neighbours; settled regions are never read, so they age out of the cache and
+// stay on disk. When the active tiles outgrow the cap they are streamed from disk each
+// generation, which slows stepping down instead of exhausting memory.
+//
+// Only the alive plane is kept; colours and ages would multiply the footprint by forty.
+class TiledUniverse {
+public:
+    static const int TILE_SIZE;                 // Cells along each side of a tile, a multiple of 64
+
+    struct Stats {
+        size_t tiles = 0;                       // Tiles with at least one live cell
+        size_t residentTiles = 0;               // Of those, tiles whose bits are in memory
+        size_t residentBytes = 0;               // Memory taken by the resident bits
+        size_t directoryBytes = 0;              // Rough size of the per-tile bookkeeping, always in memory
+        size_t activeTiles = 0;                 // Tiles stepped in the last generation
+        std::int64_t pageIns = 0;               // Tiles read back from disk
+        std::int64_t pageOuts = 0;              // Tiles written to disk
+        std::int64_t ioErrors = 0;              // Failed reads and writes of the scratch file
+    };
+
+    TiledUniverse();
+    ~TiledUniverse();
+
+    TiledUniverse(const TiledUniverse&) = delete;
+    TiledUniverse& operator=(const TiledUniverse&) = delete;
+
+    // Creates (or truncates) the scratch file and empties the universe. Resident tiles are
+    // held to 'memoryLimit' bytes, but at least a few tiles. Returns false if the file cannot be created.
+    bool open(const std::string& storePath, size_t memoryLimit);
+    // Discards everything and deletes the scratch file
+    void close();
+    bool isOpen() const { return store != nullptr; }
+
+    void setRule(const LifeRule& lifeRule);
+    const LifeRule& getRule() const { return rule; }
+
+    bool getCell(std::int64_t x, std::int64_t y);
+    void setCell(std::int64_t x, std::int64_t y, bool alive);
+    // Brings 'length' cells of row y to life starting at x
+    void fillRun(std::int64_t x, std::int64_t y, std::int64_t length);
+    // ORs a pattern in with its top-left corner at (x, y)
+    void stamp(const BitPattern& pattern, std::int64_t x, std::int64_t y);
+
+    // Streams an RLE file in with its top-left corner at the origin, without ever holding the
+    // whole pattern; takes the rule from the header if it has one
+    bool loadRle(const std::string& path);
+    // Writes the live cells as RLE one band of tiles at a time; only a band's runs are held in memory
+    bool saveRle(const std::string& path);
+
+    void step();
+    void advance(int generations);
+    std::int64_t getGeneration() const { return generation; }
+    std::int64_t getPopulation();
+
+    // Smallest rectangle holding every live cell; false if there are none
+    bool getBounds(std::int64_t& x, std::int64_t& y, std::int64_t& width, std::int64_t& height);
+    // Copies the window of 'target's size whose top-left corner is (x, y) into 'target';
+    // newly live cells take the given colour
+    void copyTo(Universe& target, std::int64_t x, std::int64_t y, std::uint32_t color);
+
+    Stats getStats() const;
+
+private:
+    static const int TILE_WORDS;                // 64-bit words per row of a tile
+    static const int TILE_BITS_WORDS;           // Words of bits in a whole tile
+
+    using TileBits = std::vector<std::uint64_t>;
+
+    // Rows are bit-packed like the tile; columns hold one bit per row, top row in bit 0 of word 0
+    struct Edges {
+        std::array<std::uint64_t, 4> top{};
+        std::array<std::uint64_t, 4> bottom{};
+        std::array<std::uint64_t, 4> left{};
+        std::array<std::uint64_t, 4> right{};
+    };
+
+    struct Tile {
+        std::unique_ptr<TileBits> bits;         // Null while the tile is on disk
+        std::int64_t slot = -1;                 // Slot in the scratch file, -1 if never written
+        bool dirty = false;                     // Bits differ from the copy on disk
+        bool changed = false;                   // Changed in the last generation or edited since
+        bool edited = false;                    // Edges and population need recounting
+        std::uint32_t population = 0;
+        Edges edges;                            // Edges at the current generation
+        std::list<std::uint64_t>::iterator lruPosition;
+    };
+
+    static std::uint64_t tileKey(std::int64_t tileX, std::int64_t tileY);
+    static std::int64_t tileXOf(std::uint64_t key);
+    static std::int64_t tileYOf(std::uint64_t key);
+
+    Tile* findTile(std::uint64_t key);
+    Tile& createTile(std::uint64_t key);
+    TileBits& residentBits(std::uint64_t key, Tile& tile);
+    void evictOverLimit(std::uint64_t keep);
+    bool evict(Tile& tile);
+    void removeTile(std::uint64_t key);
+    void markEdited(std::uint64_t key, Tile& tile);
+    void settleEdits();
+    void recount(std::uint64_t key, Tile& tile);
+    Edges edgesOf(const TileBits& bits) const;
+    bool bordersLife(std::int64_t tileX, std::int64_t tileY);
+    void stepTile(const TileBits* bits, std::int64_t tileX, std::int64_t tileY, TileBits& next);
+
+    bool readSlot(std::int64_t slot, TileBits& bits);
+    bool writeSlot(std::int64_t slot, const TileBits& bits);
+    std::int64_t allocateSlot();
+
+    std::unordered_map<std::uint64_t, Tile> tiles;
+    std::list<std::uint64_t> lru;               // Resident tiles, most recently used first
+    std::vector<std::uint64_t> changedTiles;    // Keys of the tiles with 'changed' set
+    size_t memoryLimit = 0;
+    size_t activeTiles = 0;
+    std::int64_t pageIns = 0;
+    std::int64_t pageOuts = 0;
+    std::int64_t ioErrors = 0;
+
+    std::FILE* store = nullptr;                 // Scratch file of fixed-size tile slots
+    std::string storePath;
+    std::int64_t slotCount = 0;
+    std::vector<std::int64_t> freeSlots;        // Slots of tiles that died out, reused first
+
+    LifeRule rule;
+    bool conway = true;
+    std::int64_t generation = 0;
+    std::int64_t population = 0;                // Sum over the tiles, valid once edits are settled
+    TileBits scratch;                           // Next state of the tile being stepped
+    std::vector<std::uint64_t> halo;            // A tile with a one-cell border, read by stepTile
+};
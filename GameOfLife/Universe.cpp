@@ -1,64 +1,126 @@
 #include "Universe.h"
+#include "TileStepper.h"
+#include "CounterRandom.h"
+#include "Profiler.h"
+#include "FixedUniverse.h"
+#include "LifeUniverse.h"
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
+#include <random>
+#include <thread>
 #include <utility>  // For std::swap
 #include <wx/wx.h>
 #include <fstream>
+#include <algorithm>
+#include <bit>
+#include <cmath>
 
 const int Universe::GRID_WIDTH = 100;
 const int Universe::GRID_HEIGHT = 100;
 
-Universe::Universe(int width, int height)
-    : width(width), height(height) {
-    
-
-    grid.assign(width, std::vector<Cell>(height));
-    scratchPad.assign(width, std::vector<Cell>(height));
+const int Universe::TILE_WIDTH = 512;
+const int Universe::TILE_HEIGHT = 128;
+const int Universe::TEMPORAL_BLOCK_DEPTH = 8;
+const int Universe::MAX_AGE = 255;
 
-   
+// Code templated on LifeUniverse takes this universe and a FixedUniverse alike; including
+// FixedUniverse.h here also keeps its compile-time checks in the build
+static_assert(LifeUniverse<Universe>);
 
+Universe::Universe(int width, int height)
+    : width(width), height(height), wordsPerRow(0), isToroidal(false), seed(0) {
+    allocatePlanes();
+}
 
+void Universe::allocatePlanes() {
+    wordsPerRow = (width + 63) / 64;
+    cells.assign(static_cast<size_t>(wordsPerRow) * height, 0);
+    colors.assign(static_cast<size_t>(width) * height, 0);
+    ages.assign(static_cast<size_t>(width) * height, 0);
+    population.reset(width, height);
+
+    // The step targets are sized on first use
+    nextCells.clear();
+    nextColors.clear();
+    nextAges.clear();
 }
 
 
 
-// Utility function to check boundaries
-inline bool Universe::isWithinBounds(int x, int y) const {
-    return x >= 0 && x < width && y >= 0 && y < height;
+
+Cell Universe::getCell(int x, int y) const {
+    Cell cell;
+    if (isWithinBounds(x, y)) {
+        cell.setAlive(getCellState(x, y));
+        cell.setCellColor(getCellColor(x, y));
+        cell.setGenerationsAlive(getCellAge(x, y));
+    }
+    return cell;
 }
 
 bool Universe::getCellState(int x, int y) const {
     if (isWithinBounds(x, y)) {
-        return grid[x][y].isAlive();
+        return (cells[static_cast<size_t>(y) * wordsPerRow + (x >> 6)] >> (x & 63)) & 1ULL;
     }
     return false;  // or throw an exception
 }
 
 wxColour Universe::getCellColor(int x, int y) const {
     if (isWithinBounds(x, y)) {
-        return grid[x][y].getCellColor();
+        return unpackColor(colors[static_cast<size_t>(y) * width + x]);
     }
     return *wxBLACK;  // default or throw an exception
 }
 
+int Universe::getCellAge(int x, int y) const {
+    if (isWithinBounds(x, y)) {
+        return ages[static_cast<size_t>(y) * width + x];
+    }
+    return 0;
+}
+
+std::uint32_t Universe::ageColor(int age) {
+    // Piecewise-linear ramp over log2(age), so the first few generations are easy to tell apart
+    static const std::uint32_t stops[] = { 0xFFFF80, 0xFFC000, 0xFF4000, 0xB00040, 0x500080, 0x101060 };
+    const int lastStop = sizeof(stops) / sizeof(stops[0]) - 1;
+    double position = age <= 1 ? 0.0 : std::log2(static_cast<double>(std::min(age, MAX_AGE))) * lastStop / 8.0;
+    int index = std::min(static_cast<int>(position), lastStop - 1);
+    double t = std::min(position - index, 1.0);
+
+    std::uint32_t color = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        double from = (stops[index] >> shift) & 0xFF;
+        double to = (stops[index + 1] >> shift) & 0xFF;
+        color |= static_cast<std::uint32_t>(from + (to - from) * t + 0.5) << shift;
+    }
+    return color;
+}
+
 void Universe::setCellColor(const GridCoord& coord, const wxColour& color) {
     if (isWithinBounds(coord.x, coord.y)) {
-        grid[coord.x][coord.y].setCellColor(color);
+        colors[static_cast<size_t>(coord.y) * width + coord.x] = packColor(color);
+        dropProvenance();
     }
     // else throw an exception or handle the error
 }
 
 void Universe::setCellAlive(int x, int y, bool alive) {
     if (isWithinBounds(x, y)) {
-        grid[x][y].setAlive(alive);
+        std::uint64_t& word = cells[static_cast<size_t>(y) * wordsPerRow + (x >> 6)];
+        std::uint64_t bit = 1ULL << (x & 63);
+        std::uint8_t& age = ages[static_cast<size_t>(y) * width + x];
+        age = alive ? (word & bit ? age : 1) : 0;  // A cell set alive again keeps its age
+        word = alive ? (word | bit) : (word & ~bit);
+        population.markDirty(x, y, 1, 1);
+        dropProvenance();
     }
 }
 
 void Universe::setCellAlive(int x, int y, bool alive, wxColour color) {
     if (isWithinBounds(x, y)) {
-        grid[x][y].setAlive(alive);
-        grid[x][y].setCellColor(color);
+        setCellAlive(x, y, alive);
+        colors[static_cast<size_t>(y) * width + x] = packColor(color);
     }
 }
 
@@ -77,8 +139,8 @@ int Universe::countNeighbors(int x, int y) const {
 
         if (getToroidal()) {
             // Adjust nx and ny to wrap around the grid toroidally
-            nx = (nx + GRID_WIDTH) % GRID_WIDTH;
-            ny = (ny + GRID_HEIGHT) % GRID_HEIGHT;
+            nx = (nx + width) % width;
+            ny = (ny + height) % height;
         }
 
         if (isWithinBounds(nx, ny) && getCellState(nx, ny)) {
@@ -91,6 +153,7 @@ int Universe::countNeighbors(int x, int y) const {
 
 
 wxColour Universe::determineBirthColor(int x, int y) {
+    PROFILE_SCOPE(ProfilePhase::BirthColor);
     std::map<wxColour, int, wxColourComparator> colorCount;
 
     for (int i = -1; i <= 1; ++i) {
@@ -101,12 +164,14 @@ wxColour Universe::determineBirthColor(int x, int y) {
             int newY = y + j;
 
             // Adjust for toroidal boundary wrapping
-            newX = (newX + GRID_WIDTH) % GRID_WIDTH;
-            newY = (newY + GRID_HEIGHT) % GRID_HEIGHT;
+            if (isToroidal) {
+                newX = (newX + width) % width;
+                newY = (newY + height) % height;
+            }
 
             // Check boundaries
-            if (grid[newX][newY].isAlive()) {
-                colorCount[grid[newX][newY].getCellColor()]++;
+            if (getCellState(newX, newY)) {
+                colorCount[getCellColor(newX, newY)]++;
             }
         }
     }
@@ -126,32 +191,448 @@ wxColour Universe::determineBirthColor(int x, int y) {
 
 
 void Universe::initializeRandomUniverse() {
-    srand(static_cast<unsigned>(time(0)));  // Seed the random number generator.
-    for (int i = 0; i < width; i++) {
-        for (int j = 0; j < height; j++) {
-            bool isAlive = rand() % 2 == 1;  // Randomly choose between alive (true) or dead (false).
-            wxColour randomColor(rand() % 256, rand() % 256, rand() % 256);  // Generate a random color.
-            setCellAlive(i, j, isAlive, randomColor);  // Set the cell's state and color.
+    std::random_device device;
+    initializeRandomUniverse((static_cast<std::uint64_t>(device()) << 32) ^ device(), 0.5);
+}
+
+void Universe::initializeRandomUniverse(std::uint64_t fillSeed, double density) {
+    seed = fillSeed;
+    const CounterRandom random(fillSeed);
+    const int level = static_cast<int>(std::clamp(density, 0.0, 1.0) * 256 + 0.5);
+    const int lowestBit = level == 0 || level == 256 ? 8 : std::countr_zero(static_cast<unsigned>(level));
+
+    // Every word and every colour is a function of (seed, row, column) alone, so the bands
+    // below can be split between any number of threads without changing the result.
+    auto fillRows = [&](int firstRow, int lastRow) {
+        for (int y = firstRow; y < lastRow; y++) {
+            std::uint64_t* row = &cells[static_cast<size_t>(y) * wordsPerRow];
+            for (int w = 0; w < wordsPerRow; w++) {
+                // Build a word with P(bit) = level / 256 from the binary expansion of the level:
+                // from the lowest set bit upwards, OR in a fair random word for each 1 and AND
+                // for each 0. A 50% fill needs one random word, a 1/256 step at most eight.
+                std::uint64_t word = level == 256 ? ~0ULL : 0;
+                std::uint64_t draws[2];
+                for (int bit = lowestBit; bit < 8; bit++) {
+                    int draw = bit - lowestBit;
+                    if (draw % 2 == 0) {
+                        random.words(static_cast<std::uint64_t>(y), static_cast<std::uint64_t>(w) * 4 + draw / 2, draws[0], draws[1]);
+                    }
+                    word = (level >> bit) & 1 ? (word | draws[draw % 2]) : (word & draws[draw % 2]);
+                }
+                if (w == wordsPerRow - 1 && width % 64 != 0) {
+                    word &= (1ULL << (width % 64)) - 1;
+                }
+                row[w] = word;
+
+                std::uint8_t* rowAges = &ages[static_cast<size_t>(y) * width + static_cast<size_t>(w) * 64];
+                int cellsInWord = std::min(64, width - w * 64);
+                for (int i = 0; i < cellsInWord; i++) {
+                    rowAges[i] = static_cast<std::uint8_t>((word >> i) & 1);
+                }
+
+                // Colour the live cells from one generator block per word, stretched over its cells
+                std::uint64_t colorKey, unused;
+                random.words((1ULL << 63) | static_cast<std::uint64_t>(y), static_cast<std::uint64_t>(w), colorKey, unused);
+                std::uint32_t* rowColors = &colors[static_cast<size_t>(y) * width + static_cast<size_t>(w) * 64];
+                for (std::uint64_t live = word; live; live &= live - 1) {
+                    int i = std::countr_zero(live);
+                    std::uint64_t mixed = (colorKey + static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL;
+                    rowColors[i] = static_cast<std::uint32_t>(mixed >> 40);
+                }
+            }
         }
+    };
+
+    int threadCount = static_cast<int>(std::min<long long>(std::max(1u, std::thread::hardware_concurrency()), height / 64 + 1));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++) {
+        threads.emplace_back(fillRows, static_cast<int>(static_cast<long long>(height) * t / threadCount),
+            static_cast<int>(static_cast<long long>(height) * (t + 1) / threadCount));
     }
+    fillRows(0, height / threadCount);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    population.markAllDirty();
+    startProvenance();
 }
 
 void Universe::clearAll(const wxColour& clearColor) {
-    for (int i = 0; i < width; i++) {
-        for (int j = 0; j < height; j++) {
-            setCellAlive(i, j, false, clearColor);  // Set each cell to dead and assign the clear color.
+    // Set each cell to dead and assign the clear color.
+    std::fill(cells.begin(), cells.end(), 0);
+    std::fill(colors.begin(), colors.end(), packColor(clearColor));
+    std::fill(ages.begin(), ages.end(), 0);
+    population.markAllDirty();
+    startProvenance();
+}
+
+namespace {
+    // Sizes a plane without giving back capacity, growing it by half again when it must grow
+    template <typename T>
+    void assignAmortized(PlaneVector<T>& plane, size_t size, T value) {
+        if (plane.capacity() < size) {
+            plane.reserve(std::max(size, plane.capacity() + plane.capacity() / 2));
+        }
+        plane.assign(size, value);
+    }
+
+    // Reads 'count' (at most 64) bits of a packed row starting at bit 'x'
+    inline std::uint64_t readBits(const std::uint64_t* row, int x, int count) {
+        int word = x >> 6, shift = x & 63;
+        std::uint64_t bits = row[word] >> shift;
+        if (shift != 0 && shift + count > 64) {
+            bits |= row[word + 1] << (64 - shift);
+        }
+        return count == 64 ? bits : bits & ((1ULL << count) - 1);
+    }
+
+    // ORs 'count' (at most 64) bits into a packed row starting at bit 'x'
+    inline void writeBits(std::uint64_t* row, int x, std::uint64_t bits, int count) {
+        int word = x >> 6, shift = x & 63;
+        row[word] |= bits << shift;
+        if (shift != 0 && shift + count > 64) {
+            row[word + 1] |= bits >> (64 - shift);
         }
     }
 }
 
-void Universe::resize(int newWidth, int newHeight) {
-    // Resize the main grid and the scratchPad
-    grid.resize(newWidth, std::vector<Cell>(newHeight, Cell())); // Assuming Cell has a default constructor
-    scratchPad.resize(newWidth, std::vector<Cell>(newHeight, Cell()));
+void Universe::resize(int newWidth, int newHeight, ResizeAnchor anchor) {
+    if (newWidth == width && newHeight == height) {
+        return;
+    }
+    int oldWidth = width;
+    int oldWordsPerRow = wordsPerRow;
+
+    // Where the kept region sits in the old and in the new grid
+    int shiftX = anchor == ResizeAnchor::Center ? (newWidth - width) / 2 : 0;
+    int shiftY = anchor == ResizeAnchor::Center ? (newHeight - height) / 2 : 0;
+    int sourceX = std::max(0, -shiftX), sourceY = std::max(0, -shiftY);
+    int targetX = std::max(0, shiftX), targetY = std::max(0, shiftY);
+    int keepWidth = std::min(width - sourceX, newWidth - targetX);
+    int keepHeight = std::min(height - sourceY, newHeight - targetY);
+
+    // Build the new planes in the step buffers, then swap them in; the old planes become the
+    // step buffers, so no memory is released and a later resize can reuse it
+    int newWordsPerRow = (newWidth + 63) / 64;
+    assignAmortized(nextCells, static_cast<size_t>(newWordsPerRow) * newHeight, std::uint64_t(0));
+    assignAmortized(nextColors, static_cast<size_t>(newWidth) * newHeight, std::uint32_t(0));
+    assignAmortized(nextAges, static_cast<size_t>(newWidth) * newHeight, std::uint8_t(0));
+
+    for (int y = 0; y < keepHeight; y++) {
+        const std::uint64_t* oldRow = &cells[static_cast<size_t>(sourceY + y) * oldWordsPerRow];
+        std::uint64_t* newRow = &nextCells[static_cast<size_t>(targetY + y) * newWordsPerRow];
+        for (int x = 0; x < keepWidth; x += 64) {
+            int count = std::min(64, keepWidth - x);
+            writeBits(newRow, targetX + x, readBits(oldRow, sourceX + x, count), count);
+        }
+        size_t from = static_cast<size_t>(sourceY + y) * oldWidth + sourceX;
+        size_t to = static_cast<size_t>(targetY + y) * newWidth + targetX;
+        std::copy_n(&colors[from], std::max(keepWidth, 0), &nextColors[to]);
+        std::copy_n(&ages[from], std::max(keepWidth, 0), &nextAges[to]);
+    }
 
-    // Update the width and height
     width = newWidth;
     height = newHeight;
+    wordsPerRow = newWordsPerRow;
+    cells.swap(nextCells);
+    colors.swap(nextColors);
+    ages.swap(nextAges);
+    population.reset(width, height);
+    dropProvenance();
+}
+
+long long Universe::getPopulation() const {
+    return population.population(cells.data(), wordsPerRow);
+}
+
+long long Universe::countRegion(int x, int y, int regionWidth, int regionHeight) const {
+    return population.count(cells.data(), wordsPerRow, x, y, regionWidth, regionHeight);
+}
+
+bool Universe::getBounds(int& x, int& y, int& regionWidth, int& regionHeight) const {
+    return population.bounds(cells.data(), wordsPerRow, x, y, regionWidth, regionHeight);
+}
+
+std::vector<PopulationBlock> Universe::occupiedBlocks(int x, int y, int regionWidth, int regionHeight) const {
+    return population.occupiedBlocks(cells.data(), wordsPerRow, x, y, regionWidth, regionHeight);
+}
+
+namespace {
+    // Calls visit(row, word, bits, coverage) for every grid word a pattern placed at (x, y) covers, with the
+    // pattern's cells and its rectangle shifted into that word and clipped to the grid's width
+    template <typename Visit>
+    void forEachCoveredWord(const BitPattern& pattern, int x, int y, int width, int height, int wordsPerRow, Visit visit) {
+        int shift = ((x % 64) + 64) % 64;
+        int firstWord = (x - shift) / 64;
+        std::uint64_t lastWordMask = width % 64 == 0 ? ~0ULL : (1ULL << (width % 64)) - 1;
+        int lastPatternWordBits = pattern.width - (pattern.wordsPerRow - 1) * 64;
+        std::uint64_t lastPatternMask = lastPatternWordBits == 64 ? ~0ULL : (1ULL << lastPatternWordBits) - 1;
+
+        for (int r = 0; r < pattern.height; r++) {
+            int row = y + r;
+            if (row < 0 || row >= height) {
+                continue;
+            }
+            const std::uint64_t* source = &pattern.rows[static_cast<size_t>(r) * pattern.wordsPerRow];
+            for (int k = 0; k <= pattern.wordsPerRow; k++) {
+                int word = firstWord + k;
+                if (word < 0) {
+                    continue;
+                }
+                if (word >= wordsPerRow) {
+                    break;
+                }
+                std::uint64_t current = k < pattern.wordsPerRow ? source[k] : 0;
+                std::uint64_t previous = k > 0 ? source[k - 1] : 0;
+                std::uint64_t currentMask = k < pattern.wordsPerRow ? (k == pattern.wordsPerRow - 1 ? lastPatternMask : ~0ULL) : 0;
+                std::uint64_t previousMask = k > 0 ? (k - 1 == pattern.wordsPerRow - 1 ? lastPatternMask : ~0ULL) : 0;
+                std::uint64_t bits = current << shift;
+                std::uint64_t coverage = currentMask << shift;
+                if (shift != 0) {
+                    bits |= previous >> (64 - shift);
+                    coverage |= previousMask >> (64 - shift);
+                }
+                if (word == wordsPerRow - 1) {
+                    bits &= lastWordMask;
+                    coverage &= lastWordMask;
+                }
+                if (coverage != 0) {
+                    visit(row, word, bits, coverage);
+                }
+            }
+        }
+    }
+}
+
+void Universe::stamp(const BitPattern& pattern, int x, int y, std::uint32_t color, bool replace) {
+    dropProvenance();
+    population.markDirty(x, y, pattern.width, pattern.height);
+    forEachCoveredWord(pattern, x, y, width, height, wordsPerRow, [&](int row, int word, std::uint64_t bits, std::uint64_t coverage) {
+        std::uint64_t& target = cells[static_cast<size_t>(row) * wordsPerRow + word];
+        std::uint64_t born = bits & ~target;
+        std::uint64_t killed = replace ? (target & coverage & ~bits) : 0;
+        target = replace ? ((target & ~coverage) | bits) : (target | bits);
+        size_t first = static_cast<size_t>(row) * width + word * 64;
+        for (; born; born &= born - 1) {
+            colors[first + std::countr_zero(born)] = color;
+            ages[first + std::countr_zero(born)] = 1;
+        }
+        for (; killed; killed &= killed - 1) {
+            ages[first + std::countr_zero(killed)] = 0;
+        }
+    });
+}
+
+bool Universe::intersects(const BitPattern& pattern, int x, int y) const {
+    bool found = false;
+    forEachCoveredWord(pattern, x, y, width, height, wordsPerRow, [&](int row, int word, std::uint64_t bits, std::uint64_t) {
+        found = found || (cells[static_cast<size_t>(row) * wordsPerRow + word] & bits) != 0;
+    });
+    return found;
+}
+
+BitPattern Universe::extract(int x, int y, int regionWidth, int regionHeight) const {
+    BitPattern region(regionWidth, regionHeight);
+    for (int row = 0; row < regionHeight; row++) {
+        for (int column = 0; column < regionWidth; column++) {
+            if (getCellState(x + column, y + row)) {
+                region.set(column, row);
+            }
+        }
+    }
+    return region;
+}
+
+void Universe::fillRegion(int x, int y, int regionWidth, int regionHeight, bool alive, std::uint32_t color) {
+    dropProvenance();
+    int x0 = std::max(0, x), x1 = static_cast<int>(std::min<long long>(width, static_cast<long long>(x) + regionWidth));
+    int y0 = std::max(0, y), y1 = static_cast<int>(std::min<long long>(height, static_cast<long long>(y) + regionHeight));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    population.markDirty(x0, y0, x1 - x0, y1 - y0);
+    for (int row = y0; row < y1; row++) {
+        std::uint64_t* words = &cells[static_cast<size_t>(row) * wordsPerRow];
+        size_t first = static_cast<size_t>(row) * width;
+        for (int word = x0 >> 6; word <= (x1 - 1) >> 6; word++) {
+            int from = std::max(x0 - word * 64, 0), to = std::min(x1 - word * 64, 64);
+            std::uint64_t mask = (to == 64 ? ~0ULL : (1ULL << to) - 1) & ~((1ULL << from) - 1);
+            if (alive) {
+                for (std::uint64_t born = mask & ~words[word]; born; born &= born - 1) {
+                    colors[first + word * 64 + std::countr_zero(born)] = color;
+                    ages[first + word * 64 + std::countr_zero(born)] = 1;
+                }
+                words[word] |= mask;
+            }
+            else {
+                words[word] &= ~mask;
+            }
+        }
+        if (!alive) {
+            std::fill(ages.begin() + first + x0, ages.begin() + first + x1, 0);
+        }
+    }
+}
+
+void Universe::play() {
+    advance(1);
+}
+
+void Universe::advance(int generations) {
+    // Each pass loads every tile once, runs up to TEMPORAL_BLOCK_DEPTH generations on it
+    // in cache and writes it back once, instead of streaming the whole grid every generation.
+    while (generations > 0) {
+        int depth = std::min(generations, TEMPORAL_BLOCK_DEPTH);
+        stepBlock(depth);
+        generations -= depth;
+    }
+}
+
+void Universe::stepBlock(int generations) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    nextCells.resize(cells.size());
+    if (!monochrome) {
+        nextColors.resize(colors.size());
+        nextAges.resize(ages.size());
+    }
+
+    // Monochrome steps hand the kernel no colour or age planes, so it skips them entirely
+    GridPlanes source{ width, height, wordsPerRow, isToroidal, cells.data(),
+        monochrome ? nullptr : colors.data(), monochrome ? nullptr : ages.data() };
+    GridPlanes target{ width, height, wordsPerRow, isToroidal, nextCells.data(),
+        monochrome ? nullptr : nextColors.data(), monochrome ? nullptr : nextAges.data() };
+
+    TileStepper stepper;
+    stepper.setRule(rule);
+    for (int y0 = 0; y0 < height; y0 += TILE_HEIGHT) {
+        for (int x0 = 0; x0 < width; x0 += TILE_WIDTH) {
+            stepper.load(source, x0, y0, std::min(TILE_WIDTH, width - x0), std::min(TILE_HEIGHT, height - y0), generations);
+            stepper.run(generations);
+            stepper.store(target);
+            // Count the tile's blocks while the words just written are still in cache
+            population.recount(nextCells.data(), wordsPerRow, x0, y0, std::min(TILE_WIDTH, width - x0), std::min(TILE_HEIGHT, height - y0));
+        }
+    }
+
+    cells.swap(nextCells);
+    if (monochrome) {
+        provenanceGenerations += generations;
+        return;
+    }
+    colors.swap(nextColors);
+    ages.swap(nextAges);
+}
+
+void Universe::setMonochrome(bool enabled, bool keepProvenance) {
+    if (enabled) {
+        bool entering = !monochrome;
+        monochrome = true;
+        keepingProvenance = keepProvenance;
+        if (!keepProvenance) {
+            dropProvenance();
+        }
+        else if (entering) {
+            startProvenance();
+        }
+        return;
+    }
+    if (!monochrome) {
+        return;
+    }
+
+    if (provenanceValid && provenanceRule == rule && provenanceToroidal == isToroidal) {
+        replayProvenance();
+    }
+    else {
+        // Without provenance the colours stay as they were; only the ages are made consistent
+        // with the alive plane, so every live cell counts as newborn if it was dead back then
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                std::uint8_t& age = ages[static_cast<size_t>(y) * width + x];
+                age = getCellState(x, y) ? std::max<std::uint8_t>(age, 1) : 0;
+            }
+        }
+    }
+    monochrome = false;
+    dropProvenance();
+}
+
+void Universe::startProvenance() {
+    if (!monochrome || !keepingProvenance) {
+        return;
+    }
+    provenanceCells.assign(cells.begin(), cells.end());
+    provenanceColors.assign(colors.begin(), colors.end());
+    provenanceAges.assign(ages.begin(), ages.end());
+    provenanceRule = rule;
+    provenanceToroidal = isToroidal;
+    provenanceGenerations = 0;
+    provenanceValid = true;
+}
+
+void Universe::dropProvenance() {
+    if (!provenanceValid) {
+        return;
+    }
+    provenanceValid = false;
+    provenanceGenerations = 0;
+    PlaneVector<std::uint64_t>().swap(provenanceCells);
+    PlaneVector<std::uint32_t>().swap(provenanceColors);
+    PlaneVector<std::uint8_t>().swap(provenanceAges);
+}
+
+void Universe::replayProvenance() {
+    // Step the kept planes forward in colour; the alive plane comes out as it is now
+    long long generations = provenanceGenerations;
+    cells.swap(provenanceCells);
+    colors.swap(provenanceColors);
+    ages.swap(provenanceAges);
+    population.markAllDirty();
+    bool wasMonochrome = monochrome;
+    monochrome = false;
+    while (generations > 0) {
+        int chunk = static_cast<int>(std::min<long long>(generations, 1 << 30));
+        advance(chunk);
+        generations -= chunk;
+    }
+    monochrome = wasMonochrome;
+    provenanceGenerations = 0;
+}
+
+void Universe::reconstructColors(int x, int y, int regionWidth, int regionHeight) {
+    if (!monochrome || !provenanceValid || provenanceGenerations == 0) {
+        return;
+    }
+    if (provenanceRule != rule || provenanceToroidal != isToroidal) {
+        dropProvenance();
+        return;
+    }
+    // Tiles start on a word boundary, so the rectangle is widened out to whole words
+    int x0 = std::max(0, x) & ~63;
+    int x1 = static_cast<int>(std::min<long long>(width, (static_cast<long long>(x) + regionWidth + 63) & ~63LL));
+    int y0 = std::max(0, y), y1 = static_cast<int>(std::min<long long>(height, static_cast<long long>(y) + regionHeight));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // Every generation since the provenance widens the cells that decide the rectangle by one
+    // on each side; once that covers the universe, replay all of it and start again from here
+    long long reach = provenanceGenerations;
+    if (x1 - x0 + 2 * reach >= width || y1 - y0 + 2 * reach >= height) {
+        replayProvenance();
+        startProvenance();
+        return;
+    }
+    GridPlanes source{ width, height, wordsPerRow, isToroidal, provenanceCells.data(), provenanceColors.data(), provenanceAges.data() };
+    GridPlanes target{ width, height, wordsPerRow, isToroidal, cells.data(), colors.data(), ages.data() };
+    TileStepper stepper;
+    stepper.setRule(rule);
+    stepper.load(source, x0, y0, x1 - x0, y1 - y0, static_cast<int>(reach));
+    stepper.run(static_cast<int>(reach));
+    stepper.store(target);
+    population.markDirty(x0, y0, x1 - x0, y1 - y0);
 }
 
 
@@ -159,6 +640,7 @@ void Universe::resize(int newWidth, int newHeight) {
 
 
 void Universe::save(const std::string& filename, const wxColour& currentGridColor, const wxColour& backgroundColor) {
+    PROFILE_SCOPE(ProfilePhase::Save);
     std::ofstream outFile(filename, std::ios::binary);
     if (outFile.is_open()) {
         // Write the width and height first
@@ -168,9 +650,9 @@ void Universe::save(const std::string& filename, const wxColour& currentGridColo
         // Write each cell's state and color
         for (int i = 0; i < width; i++) {
             for (int j = 0; j < height; j++) {
-                bool alive = grid[i][j].isAlive();
-                int generations = grid[i][j].getGenerationsAlive();
-                wxColour color = grid[i][j].getCellColor();
+                bool alive = getCellState(i, j);
+                int generations = getCellAge(i, j);
+                wxColour color = getCellColor(i, j);
 
                 outFile.write(reinterpret_cast<char*>(&alive), sizeof(bool));
                 outFile.write(reinterpret_cast<char*>(&generations), sizeof(int));
@@ -207,6 +689,7 @@ void Universe::save(const std::string& filename, const wxColour& currentGridColo
 }
 
 bool Universe::load(const std::string& filename, wxColour& gridColor, wxColour& backgroundColor) {
+    PROFILE_SCOPE(ProfilePhase::Load);
     std::ifstream inFile(filename, std::ios::binary);
     if (!inFile.is_open()) {
         return false; // File could not be opened
@@ -216,8 +699,8 @@ bool Universe::load(const std::string& filename, wxColour& gridColor, wxColour&
     inFile.read(reinterpret_cast<char*>(&width), sizeof(int));
     inFile.read(reinterpret_cast<char*>(&height), sizeof(int));
 
-    // Resize the grid to match the loaded dimensions
-    grid.resize(width, std::vector<Cell>(height));
+    // Reallocate the planes to match the loaded dimensions
+    allocatePlanes();
 
     // Read each cell's state and color and update the grid
     for (int i = 0; i < width; i++) {
@@ -235,10 +718,8 @@ bool Universe::load(const std::string& filename, wxColour& gridColor, wxColour&
             inFile.read(reinterpret_cast<char*>(&blue), sizeof(unsigned char));
             wxColour color(red, green, blue);
 
-            grid[i][j].setAlive(alive);
-            grid[i][j].setCellColor(color);
-            // Set generations as needed, for example using a private setter or a friend function
-            // grid[i][j].setGenerationsAlive(generations); // This method might need to be implemented if it doesn't exist.
+            setCellAlive(i, j, alive, color);
+            ages[static_cast<size_t>(j) * width + i] = alive ? static_cast<std::uint8_t>(std::clamp(generations, 1, MAX_AGE)) : 0;
         }
     }
 
@@ -258,5 +739,6 @@ bool Universe::load(const std::string& filename, wxColour& gridColor, wxColour&
     backgroundColor = wxColour(r, g, b);
 
     inFile.close();
+    startProvenance();
     return true;
 }
@@ -1,11 +1,24 @@
 #pragma once
 
 #include "Cell.h"
+#include "TileStepper.h"
+#include "BitPattern.h"
+#include "LifeRule.h"
+#include "PlaneMemory.h"
+#include "PopulationIndex.h"
 #include <vector>
 #include <set>
 #include <utility> // For std::pair
 #include <wx/colour.h>
 #include <map>
+#include <cstdint>
+#include <string>
+
+// Which part of the content stays in place when the universe is resized
+enum class ResizeAnchor {
+    TopLeft,
+    Center
+};
 
 // Utility structure to represent coordinates on the grid
 struct GridCoord {
@@ -30,31 +43,79 @@ class Universe {
 public:
     Universe(int width, int height);
 
-    Cell& getCell(int x, int y);
+    Cell getCell(int x, int y) const;
     bool getCellState(int x, int y) const;
     void setCellAlive(int x, int y, bool alive);  // Overloaded version without color
     void setCellAlive(int x, int y, bool alive, wxColour color);  // Existing version with color
 
-    void initializeRandomUniverse();
+    void initializeRandomUniverse();  // Fills with a fresh seed at 50% density
+    // Deterministic fill: the same seed and density always give the same soup, whatever the thread count.
+    // The density is rounded to the nearest 1/256.
+    void initializeRandomUniverse(std::uint64_t seed, double density);
+    std::uint64_t getSeed() const { return seed; }
     void clearAll(const wxColour& clearColor);
-    void play();
+    void play();                    // Advances the universe by one generation
+    void advance(int generations);  // Advances several generations, TEMPORAL_BLOCK_DEPTH at a time per tile
     void save(const std::string& filename, const wxColour& gridColor, const wxColour& backgroundColor);   
     bool load(const std::string& filename, wxColour& currentGridColor, wxColour& backgroundColor);
     void clearAll();
     wxColour getCellColor(int x, int y) const;
+    int getCellAge(int x, int y) const;  // Generations alive, 0 for dead cells, saturating at MAX_AGE
     void setCellColor(const GridCoord& coord, const wxColour& color);
-    bool isWithinBounds(int x, int y) const;
+    bool isWithinBounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
 
     wxColour determineBirthColor(int x, int y);
     int countNeighbors(int x, int y) const;
 
-    static const int GRID_WIDTH;
+    static const int GRID_WIDTH;    // Default dimensions of a new universe
     static const int GRID_HEIGHT;
 
+    // Tiles are stepped independently in cache; their width must be a multiple of 64
+    static const int TILE_WIDTH;
+    static const int TILE_HEIGHT;
+    static const int TEMPORAL_BLOCK_DEPTH;
+    static const int MAX_AGE;
+
     inline static int getGridWidth() { return GRID_WIDTH; }
     inline static int getGridHeight() { return GRID_HEIGHT; }
 
-    void resize(int newWidth, int newHeight);
+    // Colours are stored packed as 0xRRGGBB so they compare in the same order as wxColourComparator
+    inline static std::uint32_t packColor(const wxColour& color) {
+        return (static_cast<std::uint32_t>(color.Red()) << 16) | (static_cast<std::uint32_t>(color.Green()) << 8) | color.Blue();
+    }
+    inline static wxColour unpackColor(std::uint32_t packed) {
+        return wxColour((packed >> 16) & 0xFF, (packed >> 8) & 0xFF, packed & 0xFF);
+    }
+    // Heatmap colour for an age: newborn cells are bright yellow, cooling through red to dark blue
+    static std::uint32_t ageColor(int age);
+
+    inline int getWidth() const { return width; }
+    inline int getHeight() const { return height; }
+
+    // Changes the dimensions, keeping the content that still fits anchored as requested.
+    // Reuses the step buffers and grows capacity geometrically, so repeated resizes rarely allocate.
+    void resize(int newWidth, int newHeight, ResizeAnchor anchor = ResizeAnchor::TopLeft);
+    long long getPopulation() const;
+    // Queries on the population index, which the stepper keeps current tile by tile
+    long long countRegion(int x, int y, int regionWidth, int regionHeight) const;
+    bool getBounds(int& x, int& y, int& regionWidth, int& regionHeight) const;  // False if nothing is alive
+    std::vector<PopulationBlock> occupiedBlocks(int x = 0, int y = 0, int regionWidth = 0, int regionHeight = 0) const;
+
+    // Writes a pattern with its top-left corner at (x, y), a shifted word at a time; parts outside
+    // the grid are clipped. With replace the dead cells of the pattern's rectangle are cleared too,
+    // otherwise the pattern is ORed over what is there. Newly live cells take the given colour.
+    void stamp(const BitPattern& pattern, int x, int y, std::uint32_t color, bool replace = false);
+    // True if any live cell of the grid lies under a live cell of the pattern placed at (x, y)
+    bool intersects(const BitPattern& pattern, int x, int y) const;
+    BitPattern extract(int x, int y, int regionWidth, int regionHeight) const;
+    // Sets or clears every cell of a rectangle a word at a time, clipped to the grid. Cells that
+    // come alive take the given colour and start at age 1.
+    void fillRegion(int x, int y, int regionWidth, int regionHeight, bool alive, std::uint32_t color);
+
+    void setRule(const LifeRule& lifeRule) { rule = lifeRule; }
+    const LifeRule& getRule() const { return rule; }
 
     void setToroidal(bool toroidal) {
         isToroidal = toroidal;
@@ -64,16 +125,60 @@ public:
         return isToroidal;
     }
 
+    // Exposes the packed state planes for bulk copies; valid until the universe is resized or stepped
+    GridPlanes getPlanes() {
+        return GridPlanes{ width, height, wordsPerRow, isToroidal, cells.data(), colors.data(), ages.data() };
+    }
+    // Must follow any write to the alive plane through getPlanes
+    void markPlanesChanged() { population.markAllDirty(); }
+
+    // In monochrome mode only the alive plane is stepped: no birth colours and no ages, the
+    // same work as a plain B/S engine. Colours and ages keep the values they had when the mode
+    // was entered. With provenance that moment's planes are kept aside, so the colours can be
+    // replayed exactly later on; any edit other than a full refill while monochrome drops it.
+    // Leaving the mode replays the whole universe if provenance is held.
+    void setMonochrome(bool enabled, bool keepProvenance = true);
+    bool getMonochrome() const { return monochrome; }
+    bool hasProvenance() const { return provenanceValid; }
+
+    // Brings the colours and ages of a rectangle up to the current generation by replaying its
+    // light cone from the provenance; the whole universe is replayed (and the provenance moved
+    // up to now) once the cone would cover it. Does nothing without provenance.
+    void reconstructColors(int x, int y, int regionWidth, int regionHeight);
+
   
 
 private:
+    void allocatePlanes();
+    void stepBlock(int generations);
+    void startProvenance();
+    void dropProvenance();
+    void replayProvenance();
+
     int width;
     int height;
-    std::vector<std::vector<wxColour>> colors;
-    std::vector<std::vector<bool>> cells;
-    std::vector<std::vector<Cell>> grid;
-    std::vector<std::vector<Cell>> scratchPad;
+    int wordsPerRow;
+    // Planes of a huge page or more are mapped from the OS on 2 MB pages where possible
+    PlaneVector<std::uint64_t> cells;       // Alive bits, one run of wordsPerRow words per row
+    PlaneVector<std::uint32_t> colors;      // Packed 0xRRGGBB colour of each cell, row-major
+    PlaneVector<std::uint64_t> nextCells;   // Step targets, swapped with the planes above
+    PlaneVector<std::uint32_t> nextColors;
+    PlaneVector<std::uint8_t> ages;         // Age of each cell, row-major, kept up to date by the kernel
+    PlaneVector<std::uint8_t> nextAges;
+    PopulationIndex population;             // Live cells per block of 'cells', summed up a quadtree
 
     bool isToroidal;
+    LifeRule rule;                          // Conway's B3/S23 unless set
+    std::uint64_t seed;                     // Seed of the last random fill
+
+    bool monochrome = false;
+    bool keepingProvenance = false;         // Monochrome was entered with provenance requested
+    bool provenanceValid = false;
+    long long provenanceGenerations = 0;    // Generations stepped since the provenance planes
+    PlaneVector<std::uint64_t> provenanceCells;
+    PlaneVector<std::uint32_t> provenanceColors;
+    PlaneVector<std::uint8_t> provenanceAges;
+    LifeRule provenanceRule;                // A replay only holds under the same rule and edges
+    bool provenanceToroidal = false;
 
 };
@@ -0,0 +1,215 @@
+#include "GolApi.h"
+#include "Universe.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <string>
+
+// The engine reports running out of memory with std::bad_alloc; nothing may cross the C boundary
+struct GolUniverse {
+    Universe universe;
+    std::int64_t generation = 0;
+
+    GolUniverse(int width, int height) : universe(width, height) {}
+};
+
+namespace {
+    template <typename Body>
+    GolStatus guarded(Body body) {
+        try {
+            return body();
+        }
+        catch (const std::bad_alloc&) {
+            return GOL_ERROR_OUT_OF_MEMORY;
+        }
+        catch (...) {
+            return GOL_ERROR_INVALID_ARGUMENT;
+        }
+    }
+}
+
+uint32_t gol_api_version(void) {
+    return GOL_API_VERSION;
+}
+
+GolUniverse* gol_create(int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    try {
+        return new GolUniverse(width, height);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void gol_destroy(GolUniverse* universe) {
+    delete universe;
+}
+
+GolStatus gol_set_rule(GolUniverse* universe, const char* rule) {
+    if (!universe || !rule) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        LifeRule parsed;
+        if (!LifeRule::parse(rule, parsed)) {
+            return GOL_ERROR_INVALID_RULE;
+        }
+        universe->universe.setRule(parsed);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_get_rule(const GolUniverse* universe, char* buffer, size_t size) {
+    if (!universe || !buffer) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        std::string text = universe->universe.getRule().toString();
+        if (text.size() + 1 > size) {
+            return GOL_ERROR_INVALID_ARGUMENT;
+        }
+        std::memcpy(buffer, text.c_str(), text.size() + 1);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_set_topology(GolUniverse* universe, GolTopology topology) {
+    if (!universe || (topology != GOL_TOPOLOGY_BOUNDED && topology != GOL_TOPOLOGY_TOROIDAL)) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    universe->universe.setToroidal(topology == GOL_TOPOLOGY_TOROIDAL);
+    return GOL_OK;
+}
+
+GolStatus gol_set_color_mode(GolUniverse* universe, GolColorMode mode) {
+    if (!universe || (mode != GOL_COLORS_FULL && mode != GOL_COLORS_NONE && mode != GOL_COLORS_DEFERRED)) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        universe->universe.setMonochrome(mode != GOL_COLORS_FULL, mode == GOL_COLORS_DEFERRED);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_reconstruct_colors(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height) {
+    if (!universe || width < 0 || height < 0) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        universe->universe.reconstructColors(x, y, width, height);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_resize(GolUniverse* universe, int32_t width, int32_t height) {
+    if (!universe || width <= 0 || height <= 0) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        universe->universe.resize(width, height);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_step(GolUniverse* universe, int64_t generations) {
+    if (!universe || generations < 0) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        while (generations > 0) {
+            int chunk = static_cast<int>(std::min<int64_t>(generations, INT_MAX));
+            universe->universe.advance(chunk);
+            universe->generation += chunk;
+            generations -= chunk;
+        }
+        return GOL_OK;
+    });
+}
+
+int64_t gol_generation(const GolUniverse* universe) {
+    return universe ? universe->generation : 0;
+}
+
+int64_t gol_population(const GolUniverse* universe) {
+    return universe ? universe->universe.getPopulation() : 0;
+}
+
+int64_t gol_count_region(const GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height) {
+    return universe ? universe->universe.countRegion(x, y, width, height) : -1;
+}
+
+GolStatus gol_bounds(const GolUniverse* universe, int32_t* x, int32_t* y, int32_t* width, int32_t* height) {
+    if (!universe || !x || !y || !width || !height) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    int boundsX = 0, boundsY = 0, boundsWidth = 0, boundsHeight = 0;
+    universe->universe.getBounds(boundsX, boundsY, boundsWidth, boundsHeight);
+    *x = boundsX;
+    *y = boundsY;
+    *width = boundsWidth;
+    *height = boundsHeight;
+    return GOL_OK;
+}
+
+GolStatus gol_view(const GolUniverse* universe, GolView* view) {
+    if (!universe || !view) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    // getPlanes hands out writable pointers; the view only ever exposes them as const
+    GridPlanes planes = const_cast<GolUniverse*>(universe)->universe.getPlanes();
+    view->width = planes.width;
+    view->height = planes.height;
+    view->words_per_row = planes.wordsPerRow;
+    view->generation = universe->generation;
+    view->cells = planes.cells;
+    view->colors = planes.colors;
+    view->ages = planes.ages;
+    return GOL_OK;
+}
+
+GolStatus gol_fill_region(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height, int alive, uint32_t color) {
+    if (!universe || width < 0 || height < 0) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        universe->universe.fillRegion(x, y, width, height, alive != 0, color & 0xFFFFFF);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_write_region(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height,
+    const uint64_t* bits, int32_t stride_words, uint32_t color) {
+    if (!universe || width < 0 || height < 0 || (!bits && width > 0 && height > 0) || stride_words < (width + 63) / 64) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        // Copy into a pattern so the caller's stride and stray bits past the width do not matter
+        BitPattern region(width, height);
+        std::uint64_t lastMask = (width & 63) ? (1ULL << (width & 63)) - 1 : ~0ULL;
+        for (int row = 0; row < height; row++) {
+            const uint64_t* source = bits + static_cast<size_t>(row) * stride_words;
+            std::uint64_t* target = &region.rows[static_cast<size_t>(row) * region.wordsPerRow];
+            std::copy(source, source + region.wordsPerRow, target);
+            if (region.wordsPerRow > 0) {
+                target[region.wordsPerRow - 1] &= lastMask;
+            }
+        }
+        universe->universe.stamp(region, x, y, color & 0xFFFFFF, true);
+        return GOL_OK;
+    });
+}
+
+GolStatus gol_randomize(GolUniverse* universe, uint64_t seed, double density) {
+    if (!universe || !(density >= 0.0 && density <= 1.0)) {
+        return GOL_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        // The fill runs on worker threads, which can fail to start
+        universe->universe.initializeRandomUniverse(seed, density);
+        return GOL_OK;
+    });
+}
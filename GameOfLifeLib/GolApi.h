@@ -0,0 +1,136 @@
+/*
+ * C interface to the Game of Life engine, for programs that want to drive simulations
+ * directly instead of through the GUI or .gol files.
+ *
+ * Everything is plain C with fixed-width types, so the ABI stays the same across compilers
+ * and can be loaded from any language with a C FFI. Functions never throw; those that can
+ * fail return a GolStatus. A universe may be used from one thread at a time.
+ *
+ * State is read without copying: gol_view fills in pointers straight into the engine's bit
+ * and colour planes. A view stays valid until the next call that steps, resizes, edits or
+ * destroys the same universe, after which it must be fetched again.
+ *
+ * Built as a DLL by the GameOfLifeLib project. Elsewhere, e.g.
+ *   g++ -std=c++20 -O2 -shared -fPIC -fvisibility=hidden -DGOL_BUILDING_LIBRARY -I../GameOfLife
+ *       GolApi.cpp ../GameOfLife/{Universe,TileStepper,Cell,BitPattern,LifeRule,PlaneMemory,PopulationIndex}.cpp
+ *       $(wx-config --cxxflags --libs core) -o libgameoflife.so
+ */
+#ifndef GOL_API_H
+#define GOL_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(GOL_BUILDING_LIBRARY)
+#define GOL_API __declspec(dllexport)
+#else
+#define GOL_API __declspec(dllimport)
+#endif
+#else
+#define GOL_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a function or structure changes incompatibly */
+#define GOL_API_VERSION 1
+
+typedef struct GolUniverse GolUniverse;
+
+typedef enum GolStatus {
+    GOL_OK = 0,
+    GOL_ERROR_INVALID_ARGUMENT = 1,
+    GOL_ERROR_INVALID_RULE = 2,
+    GOL_ERROR_OUT_OF_MEMORY = 3
+} GolStatus;
+
+typedef enum GolTopology {
+    GOL_TOPOLOGY_BOUNDED = 0,   /* Cells beyond the edges are always dead */
+    GOL_TOPOLOGY_TOROIDAL = 1   /* Opposite edges are joined */
+} GolTopology;
+
+typedef enum GolColorMode {
+    GOL_COLORS_FULL = 0,        /* Births inherit colours and ages are kept every generation */
+    GOL_COLORS_NONE = 1,        /* Only the alive bits are stepped; colours and ages stay as they were */
+    GOL_COLORS_DEFERRED = 2     /* As NONE, but the planes at the switch are kept so colours can be
+                                   replayed exactly by gol_reconstruct_colors or on switching back */
+} GolColorMode;
+
+/* Read-only view of a universe's state */
+typedef struct GolView {
+    int32_t width;
+    int32_t height;
+    int32_t words_per_row;      /* 64-bit words per row of the cell plane */
+    int64_t generation;         /* Generations stepped since creation */
+    /* Alive bits: cell (x, y) is bit (x % 64) of cells[y * words_per_row + x / 64].
+       Bits past the width in the last word of a row are always 0. */
+    const uint64_t* cells;
+    /* Colour of cell (x, y) as 0xRRGGBB at colors[y * width + x]; only meaningful for live cells */
+    const uint32_t* colors;
+    /* Generations cell (x, y) has been alive at ages[y * width + x], 0 if dead, saturating at 255 */
+    const uint8_t* ages;
+} GolView;
+
+/* GOL_API_VERSION of the loaded library, to check against the header */
+GOL_API uint32_t gol_api_version(void);
+
+/* Returns NULL if the size is not positive or memory runs out. New universes are empty,
+   bounded and follow B3/S23. */
+GOL_API GolUniverse* gol_create(int32_t width, int32_t height);
+GOL_API void gol_destroy(GolUniverse* universe);
+
+/* Rules are given in B/S notation, e.g. "B3/S23" or "B36/S23"; "23/3" is also accepted */
+GOL_API GolStatus gol_set_rule(GolUniverse* universe, const char* rule);
+/* Writes the rule as a NUL-terminated B/S string; needs at most 22 bytes */
+GOL_API GolStatus gol_get_rule(const GolUniverse* universe, char* buffer, size_t size);
+
+GOL_API GolStatus gol_set_topology(GolUniverse* universe, GolTopology topology);
+
+/* Switching back to GOL_COLORS_FULL replays the colours if they were deferred. Edits made in
+   GOL_COLORS_DEFERRED, other than gol_randomize, lose the ability to replay. */
+GOL_API GolStatus gol_set_color_mode(GolUniverse* universe, GolColorMode mode);
+/* Brings the colours and ages of a rectangle up to date in GOL_COLORS_DEFERRED; otherwise does nothing */
+GOL_API GolStatus gol_reconstruct_colors(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height);
+
+/* Keeps the cells that still fit, anchored at the top-left corner */
+GOL_API GolStatus gol_resize(GolUniverse* universe, int32_t width, int32_t height);
+
+/* Advances the universe; runs in cache-sized tiles several generations at a time */
+GOL_API GolStatus gol_step(GolUniverse* universe, int64_t generations);
+
+GOL_API int64_t gol_generation(const GolUniverse* universe);
+GOL_API int64_t gol_population(const GolUniverse* universe);
+
+/* Live cells in a rectangle, clipped to the universe; answered from a per-block population
+   pyramid, so large rectangles cost little more than small ones. Negative on a null universe. */
+GOL_API int64_t gol_count_region(const GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height);
+
+/* Smallest rectangle holding every live cell. GOL_ERROR_INVALID_ARGUMENT if any pointer is null;
+   an empty universe gives a 0 x 0 rectangle at the origin. */
+GOL_API GolStatus gol_bounds(const GolUniverse* universe, int32_t* x, int32_t* y, int32_t* width, int32_t* height);
+
+/* Fills in a view of the current state without copying it */
+GOL_API GolStatus gol_view(const GolUniverse* universe, GolView* view);
+
+/* Sets (alive != 0) or clears every cell of a rectangle, clipped to the universe.
+   Cells that come alive take the given 0xRRGGBB colour. */
+GOL_API GolStatus gol_fill_region(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height,
+    int alive, uint32_t color);
+
+/* Replaces a rectangle with a bitmap laid out like GolView::cells: bit (i % 64) of
+   bits[j * stride_words + i / 64] is cell (x + i, y + j). Parts outside the universe are clipped;
+   cells that come alive take the given colour. */
+GOL_API GolStatus gol_write_region(GolUniverse* universe, int32_t x, int32_t y, int32_t width, int32_t height,
+    const uint64_t* bits, int32_t stride_words, uint32_t color);
+
+/* Reproducible random fill at the given density (0 to 1, in steps of 1/256) */
+GOL_API GolStatus gol_randomize(GolUniverse* universe, uint64_t seed, double density);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+// Reference subscriber for the Game of Life frame server.
+//
+// Connects to a running simulation, subscribes, rebuilds the requested region from the
+// keyframe and delta frames and checks every frame against its checksum.
+//
+// Usage: FrameClient [port] [every] [frames] [x,y,width,height]
+//
+// Build alongside the codec, e.g.
+//   g++ -std=c++20 -O2 -I../../GameOfLife FrameClient.cpp ../../GameOfLife/FrameCodec.cpp -o FrameClient
+//   cl /std:c++20 /EHsc /I..\..\GameOfLife FrameClient.cpp ..\..\GameOfLife\FrameCodec.cpp
+
+#include "FrameCodec.h"
+#include "SocketUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? std::atoi(argv[1]) : 5757;
+    int every = argc > 2 ? std::atoi(argv[2]) : 1;
+    long frameLimit = argc > 3 ? std::atol(argv[3]) : 0;
+    std::string region = argc > 4 ? argv[4] : "";
+
+    if (!initSockets()) {
+        std::fprintf(stderr, "Could not initialise sockets\n");
+        return 1;
+    }
+    socket_t connection = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (connection == INVALID_SOCKET_HANDLE || connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::fprintf(stderr, "Could not connect to 127.0.0.1:%d\n", port);
+        return 1;
+    }
+
+    std::string request = "SUBSCRIBE every=" + std::to_string(every);
+    if (!region.empty()) {
+        request += " region=" + region;
+    }
+    request += "\n";
+    sendBytes(connection, reinterpret_cast<const unsigned char*>(request.data()), request.size());
+
+    TileFrameDecoder decoder;
+    std::vector<unsigned char> buffer;
+    long frames = 0;
+    long keyframes = 0;
+    long failures = 0;
+    long long bytes = 0;
+    std::int64_t lastGeneration = -1;
+    auto started = std::chrono::steady_clock::now();
+
+    unsigned char chunk[65536];
+    while (frameLimit == 0 || frames < frameLimit) {
+        int n = receiveBytes(connection, chunk, sizeof(chunk));
+        if (n <= 0) {
+            break;
+        }
+        buffer.insert(buffer.end(), chunk, chunk + n);
+        bytes += n;
+
+        // Apply every complete frame in the buffer
+        size_t offset = 0;
+        FrameHeader header;
+        while (TileFrameDecoder::readHeader(buffer.data() + offset, buffer.size() - offset, header) &&
+            buffer.size() - offset >= TileFrameDecoder::frameSize(header)) {
+            bool ok = decoder.apply(buffer.data() + offset, TileFrameDecoder::frameSize(header));
+            // Generations increase, except that a keyframe starts over after the simulation seeks back
+            bool ordered = header.generation > lastGeneration || header.type == FrameType::Keyframe;
+            if (!ok || !ordered) {
+                failures++;
+            }
+            frames++;
+            keyframes += header.type == FrameType::Keyframe;
+            lastGeneration = header.generation;
+            std::printf("gen %lld %s tiles=%u population=%lld %s\n",
+                static_cast<long long>(header.generation),
+                header.type == FrameType::Keyframe ? "key  " : "delta",
+                header.tileCount,
+                static_cast<long long>(decoder.getPopulation()),
+                ok && ordered ? "ok" : "MISMATCH");
+            offset += TileFrameDecoder::frameSize(header);
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::printf("%ld frames (%ld keyframes), %lld bytes in %.2f s, %ld failures\n",
+        frames, keyframes, bytes, seconds, failures);
+    closeSocket(connection);
+    return failures == 0 ? 0 : 2;
+}